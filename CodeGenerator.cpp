@@ -417,6 +417,9 @@ void CodeGenerator::process_line(const std::string& line_raw) {
 	current_address_ += 5;
       }
 
+    } else if (mnemonic == "ret") {
+      machine_code_.push_back(0xC3);
+      current_address_ += 1;
     } else if (mnemonic == "int") {
       if (operands.operand_count() < 1) return;
       // Assuming "int 0x80"
@@ -3,6 +3,7 @@
 
 #include "memory.h" // For address_t
 #include "decoder.h"
+#include <map>
 #include <vector>
 #include <string>
 
@@ -26,13 +26,29 @@ LIB_SRCS = \
 	file_system_device.cpp \
 	ui_manager.cpp \
 	decoder.cpp \
+	instruction_formatter.cpp \
 	CodeGenerator.cpp \
 	instruction_describer.cpp \
 	ir_executor_helpers.cpp \
 	program_decoder.cpp \
 	formatting_utils.cpp \
 	architecture.cpp \
-	x86_to_ir.cpp
+	x86_to_ir.cpp \
+	decode_cache.cpp \
+	translation_cache.cpp \
+	basic_block.cpp \
+	jit_compiler.cpp \
+	tiering_manager.cpp \
+	lazy_flags.cpp \
+	flag_liveness.cpp \
+	ir_dispatch.cpp \
+	ir_fusion.cpp \
+	ir_compact.cpp \
+	ir_passes.cpp \
+	thread_pool.cpp \
+	aot_translator.cpp \
+	program_cache.cpp \
+	native_module.cpp
 
 # Define object files
 LIB_OBJS = $(LIB_SRCS:.cpp=.o)
@@ -40,7 +56,7 @@ MAIN_OBJ = main.o
 
 # Define libraries to link
 # The order matters for static libraries. libpqxx needs libpq, so it comes first.
-LIBS = -L/var/local -lpqxx -lpq -lncursesw
+LIBS = -L/var/local -lpqxx -lpq -lncursesw -pthread -ldl
 
 # --- Build Targets ---
 
@@ -57,6 +73,12 @@ $(TARGET): $(MAIN_OBJ) $(LIB_OBJS)
 %.o: %.cpp
 	$(CXX) $(CXXFLAGS) $(INCLUDES) -c $< -o $@
 
+# Program cache files are keyed by a checksum of the sources, so a cache
+# written by one build is never loaded by another.
+BUILD_ID := $(shell cat $(LIB_SRCS) $(wildcard *.h) 2>/dev/null | cksum | cut -d' ' -f1)
+program_cache.o: CXXFLAGS += -DX86SIM_BUILD_ID=\"$(BUILD_ID)\"
+program_cache.o: $(LIB_SRCS) $(wildcard *.h)
+
 
 # --- Test Targets ---
 TEST_SRCS = \
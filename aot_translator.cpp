@@ -0,0 +1,78 @@
+#include "aot_translator.h"
+#include "decoder.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+// Leaders control can reach from the end of `block`.
+void add_successors(const BasicBlock& block, std::vector<address_t>& out) {
+    if (block.has_taken_target) {
+        out.push_back(block.taken_target);
+    }
+    IROpcode exit = block.instructions.back().opcode;
+    bool falls_through = !block.ends_with_terminator || (exit != IROpcode::Jump && exit != IROpcode::Ret);
+    if (falls_through) {
+        out.push_back(block.end_address); // Includes the return site of a call.
+    }
+}
+
+} // namespace
+
+AotStats translate_ahead_of_time(BlockCache& blocks, const Memory& memory,
+                                 const std::vector<address_t>& roots, ThreadPool& pool) {
+    AotStats stats;
+    address_t text_start = memory.get_text_segment_start();
+    address_t text_end = text_start + memory.get_text_segment_size();
+
+    std::unordered_set<address_t> seen;
+    std::vector<address_t> wave;
+    auto enqueue = [&](const std::vector<address_t>& leaders, std::vector<address_t>& next) {
+        for (address_t leader : leaders) {
+            if (leader >= text_start && leader < text_end && seen.insert(leader).second &&
+                !blocks.find(leader)) {
+                next.push_back(leader);
+            }
+        }
+    };
+    enqueue(roots, wave);
+
+    while (!wave.empty()) {
+        ++stats.waves;
+        std::vector<std::unique_ptr<BasicBlock>> built(wave.size());
+        std::vector<IRPassManager> passes(wave.size(), blocks.passes());
+        for (size_t i = 0; i < wave.size(); ++i) {
+            passes[i].reset_stats();
+            // Pool tasks must not throw: a leader whose translation throws is
+            // left untranslated, as if it had no block.
+            pool.submit([&, i] {
+                try {
+                    built[i] = BlockCache::build_uncached(memory, wave[i], passes[i]);
+                } catch (const std::exception&) {
+                    built[i].reset();
+                }
+            });
+        }
+        pool.wait();
+
+        std::vector<address_t> successors;
+        for (size_t i = 0; i < wave.size(); ++i) {
+            blocks.passes().add_stats(passes[i]);
+            if (!built[i]) {
+                continue;
+            }
+            add_successors(*built[i], successors);
+            size_t instructions = built[i]->instructions.size();
+            if (blocks.insert(std::move(built[i]))) {
+                ++stats.blocks;
+                stats.instructions += instructions;
+            }
+        }
+        std::vector<address_t> next;
+        enqueue(successors, next);
+        wave = std::move(next);
+    }
+    return stats;
+}
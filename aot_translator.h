@@ -0,0 +1,31 @@
+#ifndef AOT_TRANSLATOR_H
+#define AOT_TRANSLATOR_H
+
+#include <cstddef>
+#include <vector>
+#include "memory.h"
+#include "basic_block.h"
+#include "thread_pool.h"
+
+struct AotStats {
+    size_t blocks = 0;       // Blocks added to the cache.
+    size_t instructions = 0; // IR instructions in those blocks, after optimization.
+    size_t waves = 0;        // Rounds of the control-flow walk.
+};
+
+/**
+ * @brief Translates every block reachable from `roots` into `blocks` up front.
+ *
+ * The control-flow graph is recovered breadth-first: each wave of block
+ * leaders is built on `pool` with BlockCache::build_uncached, and the direct
+ * branch, call and fall-through targets of the new blocks form the next wave.
+ * Indirect jumps and returns end a path. Blocks are inserted in leader order,
+ * so the cache contents do not depend on thread scheduling. Leaders already
+ * cached are skipped, and the pass settings and counters of `blocks` apply.
+ *
+ * The text segment must not be written while this runs.
+ */
+AotStats translate_ahead_of_time(BlockCache& blocks, const Memory& memory,
+                                 const std::vector<address_t>& roots, ThreadPool& pool);
+
+#endif // AOT_TRANSLATOR_H
@@ -1,4 +1,5 @@
 #include "architecture.h"
+#include "register_enums.h"
 
 /**
  * @brief Populates and returns an Architecture object for the x86 ISA.
@@ -58,5 +59,19 @@ Architecture create_x86_architecture() {
     arch.register_map[{IRRegisterType::VECTOR, 0, 128}] = "xmm0";
     arch.register_map[{IRRegisterType::VECTOR, 1, 128}] = "xmm1";
 
+    // --- Register-file slots ---
+    // GPR indices follow the x86 encoding order, which differs from Reg64.
+    static const Reg64 gpr_slots[] = {RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI};
+    for (const auto& entry : arch.register_map) {
+        const IRRegisterKey& key = entry.first;
+        if (key.type == IRRegisterType::GPR && key.index < 8) {
+            arch.register_slots[key] = gpr_slots[key.index];
+        } else if (key.type == IRRegisterType::IP) {
+            arch.register_slots[key] = RIP;
+        } else if (key.type == IRRegisterType::VECTOR && key.size == 256) {
+            arch.register_slots[key] = static_cast<int32_t>(YMM0 + key.index);
+        }
+    }
+
     return arch;
 }
@@ -27,6 +27,9 @@ public:
     // Maps an abstract IRRegister to its concrete ISA-specific name (e.g., "eax").
     std::map<IRRegisterKey, std::string> register_map;
 
+    // Maps an abstract IRRegister to its slot in the simulator's register file.
+    std::map<IRRegisterKey, int32_t> register_slots;
+
     /**
      * @brief Gets the ISA-specific name for a given abstract register.
      * @throws std::runtime_error if no mapping is found.
@@ -40,6 +43,14 @@ public:
         return it->second;
     }
 
+    /**
+     * @brief Gets the register-file slot for a given abstract register, or -1 if it has none.
+     */
+    int32_t get_register_slot(const IRRegister& reg) const {
+        auto it = register_slots.find({reg.type, reg.index, reg.size});
+        return it == register_slots.end() ? -1 : it->second;
+    }
+
     // In the future, this class could also hold other ISA-specific details,
     // such as endianness, address size, etc.
 };
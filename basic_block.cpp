@@ -0,0 +1,269 @@
+#include "basic_block.h"
+#include "flag_liveness.h"
+#include "ir_fusion.h"
+#include "x86_to_ir.h"
+#include <algorithm>
+#include <variant>
+
+namespace {
+
+// Forms the block starting at `address`. `fetch(address, length)` returns the
+// IR of the instruction there and its encoded length, or nullptr if it cannot
+// be decoded or translated.
+template <typename Fetch>
+std::unique_ptr<BasicBlock> form_block(const Memory& memory, address_t address, IRPassManager& passes,
+                                       Fetch fetch) {
+    address_t text_end = memory.get_text_segment_start() + memory.get_text_segment_size();
+    if (address < memory.get_text_segment_start() || address >= text_end) {
+        return nullptr;
+    }
+
+    auto block = std::make_unique<BasicBlock>();
+    block->start_address = address;
+
+    address_t current = address;
+    while (current < text_end && block->instructions.size() < BlockCache::kMaxBlockInstructions) {
+        size_t length = 0;
+        const IRInstruction* ir_instr = fetch(current, length);
+        if (!ir_instr) {
+            break;
+        }
+        block->instructions.push_back(*ir_instr);
+        current += length;
+        if (ends_basic_block(ir_instr->opcode)) {
+            block->ends_with_terminator = true;
+            break;
+        }
+    }
+
+    if (block->instructions.empty()) {
+        return nullptr;
+    }
+    block->end_address = current;
+    passes.run(block->instructions);
+    fuse_superinstructions(block->instructions);
+    analyze_flag_liveness(block->instructions);
+
+    if (block->ends_with_terminator) {
+        const IRInstruction& exit_instr = block->instructions.back();
+        bool direct = exit_instr.opcode == IROpcode::Jump ||
+                      exit_instr.opcode == IROpcode::Branch ||
+                      exit_instr.opcode == IROpcode::CmpBranch ||
+                      exit_instr.opcode == IROpcode::DecBranch ||
+                      exit_instr.opcode == IROpcode::Call;
+        if (direct && !exit_instr.operands.empty() &&
+            std::holds_alternative<uint64_t>(exit_instr.operands[0])) {
+            block->has_taken_target = true;
+            block->taken_target = std::get<uint64_t>(exit_instr.operands[0]);
+        }
+    }
+    return block;
+}
+
+} // namespace
+
+bool ends_basic_block(IROpcode opcode) {
+    switch (opcode) {
+        case IROpcode::Jump:
+        case IROpcode::Branch:
+        case IROpcode::CmpBranch:
+        case IROpcode::DecBranch:
+        case IROpcode::Call:
+        case IROpcode::Ret:
+        case IROpcode::Syscall:
+        case IROpcode::Div: // #DE halts by moving RIP
+            return true;
+        default:
+            return false;
+    }
+}
+
+BlockCache::BlockCache(Memory& memory, DecodeCache& decode_cache, TranslationCache& translation_cache)
+    : memory_(memory), decode_cache_(decode_cache), translation_cache_(translation_cache) {
+    listener_id_ = memory_.add_text_write_listener(
+        [this](address_t address, size_t size) { invalidate(address, size); });
+}
+
+BlockCache::~BlockCache() {
+    memory_.remove_text_write_listener(listener_id_);
+}
+
+BasicBlock* BlockCache::lookup(address_t address) {
+    auto it = blocks_.find(address);
+    if (it != blocks_.end()) {
+        return it->second.get();
+    }
+
+    auto block = build(address);
+    if (!block) {
+        return nullptr;
+    }
+    BasicBlock* result = block.get();
+    blocks_.emplace(address, std::move(block));
+    return result;
+}
+
+BasicBlock* BlockCache::find(address_t address) {
+    auto it = blocks_.find(address);
+    return it != blocks_.end() ? it->second.get() : nullptr;
+}
+
+const BasicBlock* BlockCache::find(address_t address) const {
+    auto it = blocks_.find(address);
+    return it != blocks_.end() ? it->second.get() : nullptr;
+}
+
+std::unique_ptr<BasicBlock> BlockCache::build(address_t address) {
+    return form_block(memory_, address, passes_, [this](address_t current, size_t& length) -> const IRInstruction* {
+        const CompactDecodedInstruction* decoded_instr = decode_cache_.lookup(current);
+        if (!decoded_instr || decoded_instr->length_in_bytes == 0) {
+            return nullptr;
+        }
+        length = decoded_instr->length_in_bytes;
+        return translation_cache_.lookup(*decoded_instr);
+    });
+}
+
+std::unique_ptr<BasicBlock> BlockCache::build_uncached(const Memory& memory, address_t address,
+                                                       IRPassManager& passes) {
+    std::unique_ptr<IRInstruction> ir_instr;
+    CompactDecodedInstruction decoded_instr;
+    return form_block(memory, address, passes, [&](address_t current, size_t& length) -> const IRInstruction* {
+        if (!Decoder::decode(memory, current, decoded_instr) || decoded_instr.length_in_bytes == 0) {
+            return nullptr;
+        }
+        length = decoded_instr.length_in_bytes;
+        ir_instr = translate_to_ir(decoded_instr);
+        return ir_instr.get();
+    });
+}
+
+bool BlockCache::insert(std::unique_ptr<BasicBlock> block) {
+    address_t address = block->start_address;
+    return blocks_.emplace(address, std::move(block)).second;
+}
+
+BasicBlock* BlockCache::successor(BasicBlock& from, address_t next_address) {
+    BasicBlock** slot = nullptr;
+    if (from.has_taken_target && next_address == from.taken_target) {
+        slot = &from.taken_successor;
+    } else if (next_address == from.end_address) {
+        slot = &from.fallthrough_successor;
+    }
+
+    if (slot && *slot) {
+        ++chained_transitions_;
+        return *slot;
+    }
+
+    BasicBlock* to = lookup(next_address);
+    if (slot && to) {
+        link(from, *slot, to);
+    }
+    return to;
+}
+
+void BlockCache::link(BasicBlock& from, BasicBlock*& slot, BasicBlock* to) {
+    if (!from.valid || !to->valid) {
+        return;
+    }
+    slot = to;
+    to->predecessors.push_back(&from);
+}
+
+void BlockCache::push_return(BasicBlock& call_block) {
+    return_stack_top_ = (return_stack_top_ + 1) % kReturnStackDepth;
+    return_stack_[return_stack_top_] = &call_block;
+    return_stack_size_ = std::min(return_stack_size_ + 1, kReturnStackDepth);
+}
+
+BasicBlock* BlockCache::predict_return(address_t next_address) {
+    if (return_stack_size_ == 0) {
+        ++return_misses_;
+        return nullptr;
+    }
+    BasicBlock* call_block = return_stack_[return_stack_top_];
+    return_stack_top_ = (return_stack_top_ + kReturnStackDepth - 1) % kReturnStackDepth;
+    --return_stack_size_;
+
+    if (call_block->end_address != next_address) {
+        ++return_misses_;
+        return nullptr;
+    }
+    ++return_hits_;
+    return successor(*call_block, next_address);
+}
+
+// Cuts every chain pointer into and out of `block`.
+void BlockCache::unlink(BasicBlock& block) {
+    for (BasicBlock* pred : block.predecessors) {
+        if (pred->taken_successor == &block) {
+            pred->taken_successor = nullptr;
+        }
+        if (pred->fallthrough_successor == &block) {
+            pred->fallthrough_successor = nullptr;
+        }
+    }
+    block.predecessors.clear();
+
+    for (BasicBlock* succ : {block.taken_successor, block.fallthrough_successor}) {
+        if (succ) {
+            auto& preds = succ->predecessors;
+            preds.erase(std::remove(preds.begin(), preds.end(), &block), preds.end());
+        }
+    }
+    block.taken_successor = nullptr;
+    block.fallthrough_successor = nullptr;
+}
+
+void BlockCache::retire(std::unique_ptr<BasicBlock> block) {
+    unlink(*block);
+    block->valid = false;
+    retired_.push_back(std::move(block));
+}
+
+void BlockCache::invalidate(address_t address, size_t size) {
+    // No block spans more than this many bytes, so only blocks starting in
+    // [address - max_span, address + size) can overlap the write.
+    const address_t max_span = kMaxBlockInstructions * DecodeCache::kMaxInstructionLength;
+    address_t first = address > max_span ? address - max_span : 0;
+    bool dropped = false;
+    for (auto it = blocks_.lower_bound(first); it != blocks_.end() && it->first < address + size;) {
+        const BasicBlock& block = *it->second;
+        if (address < block.end_address) {
+            retire(std::move(it->second));
+            it = blocks_.erase(it);
+            ++invalidated_blocks_;
+            dropped = true;
+        } else {
+            ++it;
+        }
+    }
+    if (dropped) {
+        // Predictions may point at retired blocks.
+        return_stack_size_ = 0;
+    }
+}
+
+size_t BlockCache::drop_native_code(NativeCodeOwner owner) {
+    size_t dropped = 0;
+    for (auto& entry : blocks_) {
+        BasicBlock& block = *entry.second;
+        if (block.native_code_owner != owner) {
+            continue;
+        }
+        ++dropped;
+        block.native_code = nullptr;
+        block.native_code_owner = NativeCodeOwner::None;
+        block.execution_count = 0;
+    }
+    return dropped;
+}
+
+void BlockCache::clear() {
+    for (auto& entry : blocks_) {
+        retire(std::move(entry.second));
+    }
+    blocks_.clear();
+    return_stack_size_ = 0;
+}
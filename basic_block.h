@@ -0,0 +1,164 @@
+#ifndef BASIC_BLOCK_H
+#define BASIC_BLOCK_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "memory.h"
+#include "ir.h"
+#include "decode_cache.h"
+#include "translation_cache.h"
+#include "jit_compiler.h"
+#include "ir_passes.h"
+
+// Who supplied a block's native_code, so flushing one source of host code
+// leaves the other's functions attached.
+enum class NativeCodeOwner : uint8_t {
+    None,
+    Jit,    // JitCompiler's code cache
+    Module, // A dlopened NativeModule
+};
+
+/**
+ * @brief A straight-line run of translated instructions with a single entry.
+ *
+ * The block owns copies of its IR so that per-block rewriting never leaks into
+ * the single-step path. Only the last instruction may redirect control flow.
+ */
+struct BasicBlock {
+    address_t start_address = 0;
+    address_t end_address = 0; // Address of the first byte after the block.
+    std::vector<IRInstruction> instructions;
+    bool ends_with_terminator = false;
+
+    // Static target of a terminating Jump/Branch/Call, if it has one.
+    bool has_taken_target = false;
+    address_t taken_target = 0;
+
+    // Chained successors, resolved lazily the first time each edge is taken.
+    BasicBlock* taken_successor = nullptr;
+    BasicBlock* fallthrough_successor = nullptr;
+    // Blocks holding a chain pointer to this one, so the links can be cut.
+    std::vector<BasicBlock*> predecessors;
+
+    // Cleared when the block is invalidated; a retired block is never linked.
+    bool valid = true;
+
+    // JIT tier: interpreted executions so far, and host code once compiled
+    // or attached from a native module.
+    uint64_t execution_count = 0;
+    JitBlockFn native_code = nullptr;
+    NativeCodeOwner native_code_owner = NativeCodeOwner::None;
+    bool jit_rejected = false; // Uses IR the JIT cannot compile.
+};
+
+/**
+ * @brief Returns true if executing `opcode` may change RIP, ending a block.
+ */
+bool ends_basic_block(IROpcode opcode);
+
+/**
+ * @brief Builds, caches and chains basic blocks by start address.
+ *
+ * Blocks are formed from the decode and translation caches. A block stops at
+ * a control-flow instruction, before an untranslatable instruction, at the end
+ * of the text segment, or after kMaxBlockInstructions. Writes to the text
+ * segment drop every block overlapping the written bytes, cut the chain links
+ * pointing at them and flush the return-address stack. Dropped blocks stay
+ * alive until release_retired() so a block can finish executing.
+ *
+ * A new block's IR is optimized by the IRPassManager, then fused into
+ * superinstructions. Changing which passes are enabled affects blocks built
+ * afterwards.
+ */
+class BlockCache {
+public:
+    BlockCache(Memory& memory, DecodeCache& decode_cache, TranslationCache& translation_cache);
+    ~BlockCache();
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    // Returns the block starting at `address`, or nullptr if its first
+    // instruction cannot be decoded or translated.
+    BasicBlock* lookup(address_t address);
+    // Returns the cached block starting at `address` without building one.
+    BasicBlock* find(address_t address);
+    const BasicBlock* find(address_t address) const;
+
+    // Forms the block at `address` by decoding and translating straight from
+    // `memory`, bypassing every cache. Safe to call from several threads at
+    // once while the text segment is not written, provided each thread has
+    // its own `passes`. Returns nullptr like lookup().
+    static std::unique_ptr<BasicBlock> build_uncached(const Memory& memory, address_t address,
+                                                      IRPassManager& passes);
+    // Adds a block built by build_uncached(). Returns false, dropping it, if a
+    // block already starts at the same address.
+    bool insert(std::unique_ptr<BasicBlock> block);
+
+    // Returns the block `from` continues into when its exit left RIP at
+    // `next_address`. Direct edges are followed through the chain pointers;
+    // the first traversal of an edge looks the target up and links it.
+    BasicBlock* successor(BasicBlock& from, address_t next_address);
+
+    // Return-address-stack prediction for Call/Ret pairs. push_return records
+    // the block that ended in a Call; predict_return pops it and, if RIP is its
+    // return address, yields the block after the call without a lookup.
+    void push_return(BasicBlock& call_block);
+    BasicBlock* predict_return(address_t next_address);
+
+    void invalidate(address_t address, size_t size);
+    void clear();
+    // Forgets the host code `owner` supplied, e.g. after the JIT code cache is
+    // flushed; code from other owners stays attached. Returns the number of
+    // blocks that lost their code.
+    size_t drop_native_code(NativeCodeOwner owner);
+    // Frees invalidated blocks. Call only when no block is executing.
+    void release_retired() { retired_.clear(); }
+
+    IRPassManager& passes() { return passes_; }
+    const IRPassManager& passes() const { return passes_; }
+
+    size_t size() const { return blocks_.size(); }
+    // Calls `fn(const BasicBlock&)` for every cached block in address order.
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (const auto& entry : blocks_) fn(*entry.second);
+    }
+    uint64_t get_chained_transitions() const { return chained_transitions_; }
+    uint64_t get_invalidated_blocks() const { return invalidated_blocks_; }
+    uint64_t get_return_hits() const { return return_hits_; }
+    uint64_t get_return_misses() const { return return_misses_; }
+
+    static constexpr size_t kMaxBlockInstructions = 64;
+    static constexpr size_t kReturnStackDepth = 16;
+
+private:
+    std::unique_ptr<BasicBlock> build(address_t address);
+    void link(BasicBlock& from, BasicBlock*& slot, BasicBlock* to);
+    void unlink(BasicBlock& block);
+    void retire(std::unique_ptr<BasicBlock> block);
+
+    Memory& memory_;
+    DecodeCache& decode_cache_;
+    TranslationCache& translation_cache_;
+    IRPassManager passes_;
+    size_t listener_id_;
+    std::map<address_t, std::unique_ptr<BasicBlock>> blocks_;
+    std::vector<std::unique_ptr<BasicBlock>> retired_;
+
+    // Circular return-address stack; overflow overwrites the oldest entry.
+    std::array<BasicBlock*, kReturnStackDepth> return_stack_{};
+    size_t return_stack_top_ = 0;
+    size_t return_stack_size_ = 0;
+
+    uint64_t chained_transitions_ = 0;
+    uint64_t invalidated_blocks_ = 0;
+    uint64_t return_hits_ = 0;
+    uint64_t return_misses_ = 0;
+};
+
+#endif // BASIC_BLOCK_H
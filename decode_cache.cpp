@@ -0,0 +1,69 @@
+#include "decode_cache.h"
+#include <algorithm>
+
+namespace {
+// Entries are allocated in chunks as execution reaches new addresses, so
+// short programs in a large text segment stay small.
+constexpr size_t kEntryChunk = 4096;
+}
+
+DecodeCache::DecodeCache(Memory& memory) : memory_(memory) {
+    listener_id_ = memory_.add_text_write_listener(
+        [this](address_t address, size_t size) { invalidate(address, size); });
+}
+
+DecodeCache::~DecodeCache() {
+    memory_.remove_text_write_listener(listener_id_);
+}
+
+const CompactDecodedInstruction* DecodeCache::lookup(address_t address) {
+    retired_.clear();
+
+    address_t text_start = memory_.get_text_segment_start();
+    size_t text_size = memory_.get_text_segment_size();
+    if (address < text_start || address >= text_start + text_size) {
+        ++misses_;
+        return Decoder::decode(memory_, address, uncached_) ? &uncached_ : nullptr;
+    }
+
+    size_t index = address - text_start;
+    if (index < entries_.size() && entries_[index].decoded) {
+        ++hits_;
+        return &entries_[index].instr;
+    }
+
+    ++misses_;
+    CompactDecodedInstruction decoded_instr;
+    if (!Decoder::decode(memory_, address, decoded_instr)) {
+        return nullptr;
+    }
+    if (index >= entries_.size()) {
+        size_t new_size = std::min(text_size, (index / kEntryChunk + 1) * kEntryChunk);
+        entries_.resize(new_size);
+    }
+    entries_[index].instr = decoded_instr;
+    entries_[index].decoded = true;
+    return &entries_[index].instr;
+}
+
+void DecodeCache::invalidate(address_t address, size_t size) {
+    address_t text_start = memory_.get_text_segment_start();
+    // An instruction that starts up to kMaxInstructionLength - 1 bytes before
+    // the write can still cover the modified bytes.
+    address_t first = address > text_start + kMaxInstructionLength - 1
+                          ? address - (kMaxInstructionLength - 1)
+                          : text_start;
+    if (address + size <= first) {
+        return;
+    }
+    size_t begin = first - text_start;
+    size_t end = std::min(entries_.size(), static_cast<size_t>(address + size - text_start));
+    for (size_t index = begin; index < end; ++index) {
+        entries_[index].decoded = false;
+    }
+}
+
+void DecodeCache::clear() {
+    retired_.swap(entries_);
+    entries_.clear();
+}
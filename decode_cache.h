@@ -0,0 +1,57 @@
+#ifndef DECODE_CACHE_H
+#define DECODE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "memory.h"
+#include "decoder.h"
+
+// Caches decoded instructions by guest address so that each text-segment
+// address is fetched and decoded once. Entries are CompactDecodedInstructions
+// held by value in a dense array indexed by (address - text start), so a miss
+// allocates nothing; they are dropped when the text segment is written.
+class DecodeCache {
+public:
+    explicit DecodeCache(Memory& memory);
+    ~DecodeCache();
+
+    DecodeCache(const DecodeCache&) = delete;
+    DecodeCache& operator=(const DecodeCache&) = delete;
+
+    // Returns the instruction at `address`, decoding it on a miss, or nullptr
+    // if it cannot be decoded. The pointer stays valid until the next lookup,
+    // even if the instruction is invalidated while it executes.
+    const CompactDecodedInstruction* lookup(address_t address);
+
+    // Drops every entry whose bytes may overlap [address, address + size).
+    void invalidate(address_t address, size_t size);
+    void clear();
+
+    uint64_t get_hits() const { return hits_; }
+    uint64_t get_misses() const { return misses_; }
+
+    // Upper bound on the encoded length of an x86 instruction.
+    static constexpr size_t kMaxInstructionLength = 15;
+
+private:
+    Memory& memory_;
+    size_t listener_id_;
+    struct Entry {
+        CompactDecodedInstruction instr;
+        bool decoded = false;
+    };
+
+    std::vector<Entry> entries_;
+    // Invalidation only clears `decoded`; the bytes stay put until a later
+    // lookup re-decodes the address. clear() parks the whole array here until
+    // the next lookup so that a caller still executing an entry never sees a
+    // dangling pointer.
+    std::vector<Entry> retired_;
+    // Holds the last decode of an address outside the text segment.
+    CompactDecodedInstruction uncached_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+#endif // DECODE_CACHE_H
@@ -1,745 +1,409 @@
 #include "decoder.h"
-#include <map>
+#include "instruction_formatter.h"
+#include <array>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 
-// Helper to get 8-bit register name from index
-const char* getRegisterName8(uint8_t index) {
-    static const char* registers[] = {"al", "cl", "dl", "bl", "ah", "ch", "dh", "bh"};
-    if (index < 8) return registers[index];
-    return "err";
-}
-
-std::unique_ptr<Decoder> Decoder::instance;
-
-// Helper to get 32-bit register name from index
-const char* getRegisterName(uint8_t index) {
-    static const char* registers[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
-    if (index < 8) return registers[index];
-    return "err";
+namespace {
+
+// How the bytes after an opcode turn into operands.
+enum class OperandForm : uint8_t {
+    None,          // No operands; the table length is the whole instruction.
+    RegRm,         // ModR/M, register-to-register only.
+    Lea,           // ModR/M, r32 <- [r/m].
+    Group,         // ModR/M with the reg field selecting the mnemonic; r/m register.
+    GroupImm8,     // As Group, followed by imm8.
+    Rel8,          // Branch with an 8-bit displacement.
+    Rel32,         // Branch with a 32-bit displacement.
+    RegInOpcode,   // Register number in the low three opcode bits.
+    RegImm32,      // Register in the opcode, then imm32.
+    EaxMoffs32,    // eax <- [moffs32].
+    Imm8,
+    AlImm8,        // al, imm8
+    Imm8Al,        // imm8, al
+    Reg32Rm8,      // ModR/M, r32 <- r8.
+    VexNds,        // dest, vvvv, r/m
+    VexMove,       // Load (opcode 0x10) or store (0x11) between reg and r/m.
+    VexUnary,      // dest, r/m
+};
+
+// Reg-field mnemonic tables for the group opcodes. Unknown keeps the
+// opcode's own mnemonic.
+enum GroupTable : uint8_t { kNoGroup, kGroup83, kGroupC1, kGroupF7, kGroupFF, kGroupCount };
+
+struct OpcodeInfo {
+    Mnemonic mnemonic = Mnemonic::Unknown;
+    OperandForm form = OperandForm::None;
+    uint8_t length = 1; // Total length in bytes, including prefixes and the 0F escape.
+    uint8_t group = kNoGroup;
+};
+
+using OpcodeTable = std::array<OpcodeInfo, 256>;
+
+constexpr const char* kMnemonicNames[] = {
+    "unknown",
+    "add", "and", "call", "cmp", "dec", "div", "idiv", "imul", "in", "inc", "int",
+    "ja", "jae", "jb", "jbe", "je", "jg", "jge", "jl", "jle", "jmp", "jne", "jno", "jns", "jo", "js",
+    "lea", "mov", "movsb", "movsd", "movsw", "movsx", "movzx", "mul", "nop", "not", "or", "out",
+    "pop", "push", "ret", "rol", "ror", "sar", "shl", "shr", "sub", "xchg", "xor",
+    "group_c1", "group_f7", "group_ff",
+    "vaddps", "vdivps", "vmaxps", "vminps", "vmovups", "vpand", "vpandn", "vpmullw", "vpor", "vpxor",
+    "vrcpps", "vsqrtps", "vsubps", "vzeroupper", "avx_instruction_unknown",
+};
+static_assert(sizeof(kMnemonicNames) / sizeof(kMnemonicNames[0]) == static_cast<size_t>(Mnemonic::Count),
+              "kMnemonicNames must name every Mnemonic");
+
+constexpr Mnemonic U = Mnemonic::Unknown;
+constexpr Mnemonic kGroups[kGroupCount][8] = {
+    {U, U, U, U, U, U, U, U},
+    {U, U, U, U, U, U, Mnemonic::Xor, Mnemonic::Cmp},
+    {Mnemonic::Rol, Mnemonic::Ror, U, U, Mnemonic::Shl, Mnemonic::Shr, U, Mnemonic::Sar},
+    {U, U, Mnemonic::Not, U, Mnemonic::Mul, Mnemonic::Imul, Mnemonic::Div, Mnemonic::Idiv},
+    {Mnemonic::Inc, Mnemonic::Dec, U, U, U, U, U, U},
+};
+
+constexpr OpcodeTable make_one_byte_table() {
+    OpcodeTable table{};
+    auto set = [&table](uint8_t opcode, Mnemonic mnemonic, OperandForm form, uint8_t length,
+                        uint8_t group = kNoGroup) {
+        table[opcode] = OpcodeInfo{mnemonic, form, length, group};
+    };
+    set(0x90, Mnemonic::Nop, OperandForm::None, 1);
+    for (uint8_t reg = 0; reg < 8; ++reg) {
+        set(0x50 + reg, Mnemonic::Push, OperandForm::RegInOpcode, 1);
+        set(0x58 + reg, Mnemonic::Pop, OperandForm::RegInOpcode, 1);
+        set(0xB8 + reg, Mnemonic::Mov, OperandForm::RegImm32, 5);
+    }
+    set(0x01, Mnemonic::Add, OperandForm::RegRm, 2);
+    set(0x09, Mnemonic::Or, OperandForm::RegRm, 2);
+    set(0x21, Mnemonic::And, OperandForm::RegRm, 2);
+    set(0x29, Mnemonic::Sub, OperandForm::RegRm, 2);
+    set(0x31, Mnemonic::Xor, OperandForm::RegRm, 2);
+    set(0x39, Mnemonic::Cmp, OperandForm::RegRm, 2);
+    set(0x87, Mnemonic::Xchg, OperandForm::RegRm, 2);
+    set(0x89, Mnemonic::Mov, OperandForm::RegRm, 2);
+    set(0x8D, Mnemonic::Lea, OperandForm::Lea, 2);
+    set(0x83, Mnemonic::Cmp, OperandForm::GroupImm8, 3, kGroup83);
+    set(0xC1, Mnemonic::GroupC1, OperandForm::GroupImm8, 3, kGroupC1);
+    set(0xF7, Mnemonic::GroupF7, OperandForm::Group, 2, kGroupF7);
+    set(0xFF, Mnemonic::GroupFF, OperandForm::Group, 2, kGroupFF);
+    set(0x70, Mnemonic::Jo, OperandForm::Rel8, 2);
+    set(0x71, Mnemonic::Jno, OperandForm::Rel8, 2);
+    set(0x72, Mnemonic::Jb, OperandForm::Rel8, 2);
+    set(0x73, Mnemonic::Jae, OperandForm::Rel8, 2);
+    set(0x74, Mnemonic::Je, OperandForm::Rel8, 2);
+    set(0x75, Mnemonic::Jne, OperandForm::Rel8, 2);
+    set(0x76, Mnemonic::Jbe, OperandForm::Rel8, 2);
+    set(0x77, Mnemonic::Ja, OperandForm::Rel8, 2);
+    set(0x78, Mnemonic::Js, OperandForm::Rel8, 2);
+    set(0x79, Mnemonic::Jns, OperandForm::Rel8, 2);
+    set(0x7C, Mnemonic::Jl, OperandForm::Rel8, 2);
+    set(0x7D, Mnemonic::Jge, OperandForm::Rel8, 2);
+    set(0x7F, Mnemonic::Jg, OperandForm::Rel8, 2);
+    set(0xEB, Mnemonic::Jmp, OperandForm::Rel8, 2);
+    set(0xE9, Mnemonic::Jmp, OperandForm::Rel32, 5);
+    set(0xE8, Mnemonic::Call, OperandForm::Rel32, 5);
+    set(0xC3, Mnemonic::Ret, OperandForm::None, 1);
+    set(0xA1, Mnemonic::Mov, OperandForm::EaxMoffs32, 5);
+    set(0xA4, Mnemonic::Movsb, OperandForm::None, 1);
+    set(0xA5, Mnemonic::Movsd, OperandForm::None, 1);
+    set(0x40, Mnemonic::Inc, OperandForm::None, 1);
+    set(0xCD, Mnemonic::Int, OperandForm::Imm8, 2);
+    set(0xE4, Mnemonic::In, OperandForm::AlImm8, 2);
+    set(0xE6, Mnemonic::Out, OperandForm::Imm8Al, 2);
+    return table;
 }
 
-// Helper to decode ModR/M byte
-void decodeModRM(uint8_t modrm, DecodedInstruction& instr, bool is_lea = false) {
-    uint8_t mod = (modrm >> 6) & 0x03;
-    uint8_t reg_field = (modrm >> 3) & 0x07;
-    uint8_t rm  = modrm & 0x07;
-
-    if (mod == 0b11) { // Register-to-register
-        DecodedOperand dest, src;
-        dest.type = OperandType::REGISTER;
-        // For LEA, the reg field is the destination. For others, it's often the source.
-        dest.text = getRegisterName(is_lea ? reg_field : rm);
-        src.type = OperandType::REGISTER;
-        src.text = getRegisterName(is_lea ? rm : reg_field);
-        instr.operands.push_back(dest);
-        instr.operands.push_back(src);
+// Opcodes after the 0F escape.
+constexpr OpcodeTable make_two_byte_table() {
+    OpcodeTable table{};
+    constexpr Mnemonic kJcc[16] = {
+        Mnemonic::Jo, Mnemonic::Jno, Mnemonic::Jb, Mnemonic::Jae, Mnemonic::Je, Mnemonic::Jne, Mnemonic::Jbe,
+        Mnemonic::Ja, Mnemonic::Js, Mnemonic::Jns, U, U, Mnemonic::Jl, Mnemonic::Jge, Mnemonic::Jle, Mnemonic::Jg,
+    };
+    for (uint8_t cc = 0; cc < 16; ++cc) {
+        if (kJcc[cc] != U) {
+            table[0x80 + cc] = OpcodeInfo{kJcc[cc], OperandForm::Rel32, 6};
+        }
     }
-    // Other modes (memory access) not implemented for simplicity
+    table[0xB6] = OpcodeInfo{Mnemonic::Movzx, OperandForm::Reg32Rm8, 3};
+    table[0xBE] = OpcodeInfo{Mnemonic::Movsx, OperandForm::Reg32Rm8, 3};
+    return table;
 }
 
-Decoder::Decoder() {
-    opcode_to_mnemonic = {
-        {0x90, "NOP"},
-        {0x66, "TWO_BYTE_OPCODE_PREFIX"}, // Example prefix
-        {0x50, "PUSH"}, {0x51, "PUSH"}, {0x52, "PUSH"}, {0x53, "PUSH"}, {0x54, "PUSH"}, {0x55, "PUSH"}, {0x56, "PUSH"}, {0x57, "PUSH"},
-        {0x58, "POP"}, {0x59, "POP"}, {0x5A, "POP"}, {0x5B, "POP"}, {0x5C, "POP"}, {0x5D, "POP"}, {0x5E, "POP"}, {0x5F, "POP"},
-        {0x01, "ADD"},
-        {0x29, "SUB"},
-        {0xEB, "JMP"},
-        {0xE9, "JMP"},
-        {0xE8, "CALL"},
-        {0x09, "OR"},
-        {0x31, "XOR"},
-        {0x21, "AND"},
-        {0x39, "CMP"},
-        {0x83, "CMP"},
-        {0x75, "JNE"},
-        {0x74, "JE"},
-        {0x72, "JB"},
-        {0x7C, "JL"},
-        {0x7D, "JGE"},
-        {0x73, "JAE"},
-        {0x76, "JBE"},
-        {0x78, "JS"},
-        {0x79, "JNS"},
-        {0x70, "JO"},
-        {0x71, "JNO"},
-        {0x87, "XCHG"},
-        {0x8D, "LEA"},
-        {0xC1, "GROUP_C1"}, // SHL, SHR, etc.
-        {0x7F, "JG"},
-        {0x77, "JA"},
-        {0xA1, "MOV"},
-        {0xB8, "MOV"},
-        {0xA4, "MOVSB"},
-        {0xA5, "MOVSD"}, // MOVSW is 66 A5
-        {0xB9, "MOV"},
-        {0xBB, "MOV"},
-        {0x89, "MOV"},
-        {0xF7, "GROUP_F7"}, // MUL, NOT, DIV, etc.
-        {0xFF, "GROUP_FF"}, // INC, DEC
-        // The below are for simple cases, but the group is more accurate
-        {0x40, "INC"}, 
-        {0xFF, "INC"},
-        {0xCD, "INT"},
-        {0xE4, "IN"},
-        {0xE6, "OUT"}
+// VEX map 1 (implied 0F). Lengths are filled in from the prefix at decode time.
+constexpr OpcodeTable make_vex_0f_table() {
+    OpcodeTable table{};
+    auto set = [&table](uint8_t opcode, Mnemonic mnemonic, OperandForm form) {
+        table[opcode] = OpcodeInfo{mnemonic, form, 0};
     };
+    set(0x77, Mnemonic::Vzeroupper, OperandForm::None);
+    set(0x10, Mnemonic::Vmovups, OperandForm::VexMove);
+    set(0x11, Mnemonic::Vmovups, OperandForm::VexMove);
+    set(0x51, Mnemonic::Vsqrtps, OperandForm::VexUnary);
+    set(0x53, Mnemonic::Vrcpps, OperandForm::VexUnary);
+    set(0x58, Mnemonic::Vaddps, OperandForm::VexNds);
+    set(0x5C, Mnemonic::Vsubps, OperandForm::VexNds);
+    set(0x5D, Mnemonic::Vminps, OperandForm::VexNds);
+    set(0x5E, Mnemonic::Vdivps, OperandForm::VexNds);
+    set(0x5F, Mnemonic::Vmaxps, OperandForm::VexNds);
+    set(0xD5, Mnemonic::Vpmullw, OperandForm::VexNds);
+    set(0xDB, Mnemonic::Vpand, OperandForm::VexNds);
+    set(0xDF, Mnemonic::Vpandn, OperandForm::VexNds);
+    set(0xEB, Mnemonic::Vpor, OperandForm::VexNds);
+    set(0xEF, Mnemonic::Vpxor, OperandForm::VexNds);
+    return table;
+}
 
-    two_byte_opcode_to_mnemonic = {
-        {0x80, "JO"},
-        {0x81, "JNO"},
-        {0x82, "JB"},
-        {0x83, "JAE"},
-        {0x84, "JE"},
-        {0x85, "JNE"},
-        {0x86, "JBE"},
-        {0x88, "JS"},
-        {0x89, "JNS"},
-        {0x8C, "JL"},
-        {0x8D, "JGE"},
-        {0x8E, "JLE"},
-        {0x8F, "JG"},
-        {0xBE, "MOVSX"},
-        {0xB6, "MOVZX"}
-    };
+constexpr OpcodeTable kOneByteOpcodes = make_one_byte_table();
+constexpr OpcodeTable kTwoByteOpcodes = make_two_byte_table();
+constexpr OpcodeTable kVex0FOpcodes = make_vex_0f_table();
+
+static_assert(kOneByteOpcodes[0xBB].form == OperandForm::RegImm32, "one-byte table is built at compile time");
+
+// Encodings the assembler looks up by mnemonic.
+struct MnemonicOpcode {
+    const char* mnemonic;
+    uint8_t opcode;
+};
+
+constexpr MnemonicOpcode kMnemonicOpcodes[] = {
+    {"NOP", 0x90}, {"TWO_BYTE_OPCODE_PREFIX", 0x66}, {"POP", 0x5d}, {"PUSH", 0x55}, {"ADD", 0x01},
+    {"SUB", 0x29}, {"JMP", 0xEB}, {"OR", 0x09}, {"XOR", 0x31}, {"AND", 0x21}, {"CMP", 0x39},
+    {"JNE", 0x75}, {"JE", 0x74}, {"JB", 0x72}, {"JL", 0x7C}, {"JGE", 0x7D}, {"JAE", 0x73},
+    {"JBE", 0x76}, {"JS", 0x78}, {"JNS", 0x79}, {"JO", 0x70}, {"JLE", 0x8E}, {"JNO", 0x71},
+    {"CALL", 0xE8}, {"RET", 0xC3}, {"SHL", 0xC1}, {"SHR", 0xC1}, {"SAR", 0xC1}, {"ROL", 0xC1},
+    {"ROR", 0xC1}, {"XCHG", 0x87}, {"IMUL", 0xF7}, {"IDIV", 0xF7},
+    {"MOVZX", 0xB6}, // As part of 0F prefix
+    {"MOVSX", 0xBE}, // As part of 0F prefix
+    {"LEA", 0x8D}, {"JG", 0x7F}, {"JA", 0x77}, {"MOVSB", 0xA4}, {"MOVSD", 0xA5}, {"MOVSW", 0xA5},
+    {"MOV", 0xB8}, {"INC", 0x40}, {"INT", 0xCD}, {"IN", 0xE4}, {"OUT", 0xE6},
+};
+
+CompactOperand register_operand(uint8_t reg, uint16_t size = 32) {
+    CompactOperand op;
+    op.type = OperandType::REGISTER;
+    op.reg = reg;
+    op.size = size;
+    return op;
+}
 
-    vex_opcode_to_mnemonic = {
-        // VZEROUPPER
-        {{1, 0x77}, "VZEROUPPER"},
-        // VADDPS
-        {{1, 0x58}, "VADDPS"},
-        // VDIVPS
-        {{1, 0x5E}, "VDIVPS"},
-        // VMAXPS
-        {{1, 0x5F}, "VMAXPS"},
-        // VPANDN
-        {{1, 0xDF}, "VPANDN"},
-        // VPAND
-        {{1, 0xDB}, "VPAND"},
-        // VPMULLW
-        {{1, 0xD5}, "VPMULLW"},
-        // VMINPS
-        {{1, 0x5D}, "VMINPS"},
-        // VMOVUPS
-        {{1, 0x10}, "VMOVUPS"},
-        {{1, 0x11}, "VMOVUPS"},
-        // VPXOR
-        {{1, 0xEF}, "VPXOR"},
-        // VRCPPS
-        {{1, 0x53}, "VRCPPS"},
-        // VSQRTPS
-        {{1, 0x51}, "VSQRTPS"},
-        // VSUBPS
-        {{1, 0x5C}, "VSUBPS"},
-        // VPOR
-        {{1, 0xEB}, "VPOR"},
-    };
+CompactOperand vector_operand(uint8_t reg, const VEX_Prefix& vex_prefix) {
+    CompactOperand op;
+    op.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
+    op.reg = reg;
+    op.size = vex_prefix.L ? 256 : 128;
+    return op;
+}
 
-    mnemonic_to_opcode = {
-        {"NOP", 0x90},
-        {"TWO_BYTE_OPCODE_PREFIX", 0x66}, 
-        {"POP", 0x5d},
-        {"PUSH", 0x55},
-        {"ADD", 0x01},
-        {"SUB", 0x29},
-        {"JMP", 0xEB},
-        {"OR", 0x09},
-        {"XOR", 0x31},
-        {"AND", 0x21},
-        {"CMP", 0x39},
-        {"JNE", 0x75},
-        {"JE", 0x74},
-        {"JB", 0x72},
-        {"JL", 0x7C},
-        {"JGE", 0x7D},
-        {"JAE", 0x73},
-        {"JBE", 0x76},
-        {"JS", 0x78},
-        {"JNS", 0x79},
-        {"JO", 0x70},
-        {"JLE", 0x8E},
-        {"JNO", 0x71},
-        {"CALL", 0xE8},
-        {"SHL", 0xC1},
-        {"SHR", 0xC1},
-        {"SAR", 0xC1},
-        {"ROL", 0xC1},
-        {"ROR", 0xC1},
-        {"XCHG", 0x87},
-        {"IMUL", 0xF7},
-        {"IDIV", 0xF7},
-        {"MOVZX", 0xB6}, // As part of 0F prefix
-        {"MOVSX", 0xBE}, // As part of 0F prefix
-        {"LEA", 0x8D},
-        {"JG", 0x7F},
-        {"JA", 0x77},
-        {"MOVSB", 0xA4},
-        {"MOVSD", 0xA5},
-        {"MOVSW", 0xA5},
-        {"MOV", 0xB8},
-        {"INC", 0x40},
-        {"INT", 0xCD},
-        {"IN", 0xE4},
-        {"OUT", 0xE6}
-    };
+CompactOperand immediate_operand(uint64_t value) {
+    CompactOperand op;
+    op.type = OperandType::IMMEDIATE;
+    op.value = value;
+    return op;
+}
 
-    instruction_lengths = {
-        {0x90, 1}, // NOP
-        {0xB8, 5}, // MOV EAX, imm32
-        {0xB9, 5}, // MOV ECX, imm32
-        {0xBB, 5}, // MOV EBX, imm32
-        {0x89, 2}, // MOV r/m32, r32
-        {0x55, 1}, // PUSH EBP
-        {0x5D, 1}, // POP EBP
-        {0x01, 2}, // ADD r/m32, r32
-        {0x29, 2}, // SUB r/m32, r32
-        {0xEB, 2}, // JMP rel8
-        {0xE9, 5}, // JMP rel32
-        {0xE8, 5}, // CALL rel32
-        {0x09, 2}, // OR r/m32, r32
-        {0x31, 2}, // XOR r/m32, r32
-        {0x21, 2}, // AND r/m32, r32
-        {0x39, 2}, // CMP r/m32, r32
-        {0x83, 3}, // CMP r/m32, imm8
-        {0x75, 2}, // JNE rel8
-        {0x74, 2}, // JE rel8
-        {0x72, 2}, // JB rel8
-        {0x7C, 2}, // JL rel8
-        {0x7D, 2}, // JGE rel8
-        {0x73, 2}, // JAE rel8
-        {0x76, 2}, // JBE rel8
-        {0x78, 2}, // JS rel8
-        {0x79, 2}, // JNS rel8
-        {0x70, 2}, // JO rel8
-        {0x71, 2}, // JNO rel8
-        {0xC1, 3}, // SHL r/m32, imm8
-        {0xC1, 3}, // SHR r/m32, imm8
-        {0xC1, 3}, // SAR r/m32, imm8
-        {0xC1, 3}, // ROL r/m32, imm8
-        {0xC1, 3}, // ROR r/m32, imm8
-        {0x87, 2}, // XCHG r/m32, r32
-        {0x8D, 2}, // LEA r32, m
-        {0x8E, 6}, // JLE rel32
-        {0xB6, 3}, // MOVZX r32, r/m8 (with 0F prefix)
-        {0xBE, 3}, // MOVSX r32, r/m8 (with 0F prefix)
-        {0x7F, 2}, // JG rel8
-        {0x40, 1}, // INC EAX (Legacy)
-        {0xA5, 1}, // MOVSD
-        {0x66, 2}, // MOVSW (66 A5)
-        {0xA4, 1}, // MOVSB
-        {0xFF, 2}, // INC r/m32
-        {0x48, 1}, // DEC EAX (Legacy)
-        {0xF7, 2}, // Group F7
-        {0xCD, 2},
-        {0xE4, 2},
-        {0xE6, 2}
-    };
+CompactOperand memory_operand(address_t address) {
+    CompactOperand op;
+    op.type = OperandType::MEMORY;
+    op.value = address;
+    return op;
 }
 
-Decoder& Decoder::getInstance() {
-    if (!instance) {
-        instance = std::unique_ptr<Decoder>(new Decoder());
+// Register-to-register ModR/M; memory forms are not decoded.
+void decodeModRM(uint8_t modrm, CompactDecodedInstruction& instr) {
+    if (((modrm >> 6) & 0x03) == 0b11) {
+        instr.add_operand(register_operand(modrm & 0x07));
+        instr.add_operand(register_operand((modrm >> 3) & 0x07));
     }
-    return *instance;
 }
 
-void Decoder::resetInstance() {
-    instance.reset(nullptr);
+// Fills in the operands of a one-byte or 0F-map instruction. `modrm_address`
+// is the byte after the opcode.
+void decodeOperands(const OpcodeInfo& info, uint8_t opcode, const Memory& memory, address_t modrm_address,
+                    CompactDecodedInstruction& instr) {
+    switch (info.form) {
+        case OperandForm::None:
+        case OperandForm::VexNds:
+        case OperandForm::VexMove:
+        case OperandForm::VexUnary:
+            break;
+        case OperandForm::RegRm:
+            decodeModRM(memory.read_text(modrm_address), instr);
+            break;
+        case OperandForm::Lea: {
+            uint8_t modrm = memory.read_text(modrm_address);
+            uint8_t mod = (modrm >> 6) & 0x03;
+            uint8_t rm = modrm & 0x07;
+            instr.add_operand(register_operand((modrm >> 3) & 0x07));
+            CompactOperand src_mem;
+            src_mem.type = OperandType::MEMORY;
+            // This is a simplified decoder for [reg] form
+            if (mod == 0b00 && rm != 0b101) {
+                src_mem.reg = rm;
+                src_mem.has_base = true;
+            } else {
+                // More complex ModR/M forms (with displacement, SIB byte) would be handled here.
+                src_mem.resolved = false;
+            }
+            instr.add_operand(src_mem);
+            break;
+        }
+        case OperandForm::Group:
+        case OperandForm::GroupImm8: {
+            uint8_t modrm = memory.read_text(modrm_address);
+            Mnemonic selected = kGroups[info.group][(modrm >> 3) & 0x07];
+            if (selected != Mnemonic::Unknown) {
+                instr.mnemonic = selected;
+            }
+            instr.add_operand(register_operand(modrm & 0x07));
+            if (info.form == OperandForm::GroupImm8) {
+                instr.add_operand(immediate_operand(memory.read_text(modrm_address + 1)));
+            }
+            break;
+        }
+        case OperandForm::Rel8: {
+            int8_t offset = memory.read_text(modrm_address);
+            instr.add_operand(immediate_operand(instr.address + info.length + offset));
+            break;
+        }
+        case OperandForm::Rel32: {
+            int32_t offset = memory.read_text_dword(modrm_address);
+            instr.add_operand(immediate_operand(instr.address + info.length + offset));
+            break;
+        }
+        case OperandForm::RegInOpcode:
+            instr.add_operand(register_operand(opcode & 0x07));
+            break;
+        case OperandForm::RegImm32:
+            instr.add_operand(register_operand(opcode & 0x07));
+            instr.add_operand(immediate_operand(memory.read_text_dword(modrm_address)));
+            break;
+        case OperandForm::EaxMoffs32:
+            instr.add_operand(register_operand(0));
+            instr.add_operand(memory_operand(memory.read_text_dword(modrm_address)));
+            break;
+        case OperandForm::Imm8:
+            instr.add_operand(immediate_operand(memory.read_text(modrm_address)));
+            break;
+        case OperandForm::AlImm8:
+            instr.add_operand(register_operand(0, 8));
+            instr.add_operand(immediate_operand(memory.read_text(modrm_address)));
+            break;
+        case OperandForm::Imm8Al:
+            instr.add_operand(immediate_operand(memory.read_text(modrm_address)));
+            instr.add_operand(register_operand(0, 8));
+            break;
+        case OperandForm::Reg32Rm8: {
+            uint8_t modrm = memory.read_text(modrm_address);
+            instr.add_operand(register_operand((modrm >> 3) & 0x07)); // Destination is r32
+            instr.add_operand(register_operand(modrm & 0x07, 8));    // Source is r8
+            break;
+        }
+    }
 }
 
-std::string Decoder::getMnemonic(uint8_t opcode) const {
-    if (auto it = opcode_to_mnemonic.find(opcode); it != opcode_to_mnemonic.end()) {
-        return it->second;
+} // namespace
+
+const char* mnemonic_name(Mnemonic mnemonic) {
+    size_t index = static_cast<size_t>(mnemonic);
+    return index < static_cast<size_t>(Mnemonic::Count) ? kMnemonicNames[index] : "unknown";
+}
+
+Mnemonic mnemonic_from_name(const std::string& name) {
+    for (size_t index = 0; index < static_cast<size_t>(Mnemonic::Count); ++index) {
+        if (name == kMnemonicNames[index]) {
+            return static_cast<Mnemonic>(index);
+        }
     }
-    return "UNKNOWN";
+    return Mnemonic::Unknown;
 }
 
-uint8_t Decoder::getOpcode(const std::string& mnemonic) const {
-    if (auto it = mnemonic_to_opcode.find(mnemonic); it != mnemonic_to_opcode.end()) {
-        return it->second;
+std::string Decoder::getMnemonic(uint8_t opcode) {
+    if (opcode == 0x66) {
+        return "TWO_BYTE_OPCODE_PREFIX";
+    }
+    std::string mnemonic = mnemonic_name(kOneByteOpcodes[opcode].mnemonic);
+    std::transform(mnemonic.begin(), mnemonic.end(), mnemonic.begin(), ::toupper);
+    return mnemonic;
+}
+
+uint8_t Decoder::getOpcode(const std::string& mnemonic) {
+    for (const MnemonicOpcode& entry : kMnemonicOpcodes) {
+        if (mnemonic == entry.mnemonic) {
+            return entry.opcode;
+        }
     }
     return 0; // or throw an exception for unknown mnemonic
 }
 
-std::unique_ptr<DecodedInstruction> Decoder::decodeInstruction(const Memory& memory, address_t address) {
+bool Decoder::decode(const Memory& memory, address_t address, CompactDecodedInstruction& out) {
     if (address >= memory.get_data_segment_start()) {
-        return nullptr;
+        return false;
     }
 
-    auto decoded_instr = std::make_unique<DecodedInstruction>();
-    decoded_instr->address = address;
+    out = CompactDecodedInstruction{};
+    out.address = address;
     uint8_t opcode = memory.read_text(address);
     address_t current_address = address;
 
     if (opcode == 0xC4 || opcode == 0xC5) {
         VEX_Prefix vex_prefix = decodeVEXPrefix(memory, current_address);
         uint8_t vex_opcode = memory.read_text(current_address);
-	/*
-        std::cout << "\n--- VEX DECODE TRACE ---" << std::endl;
-        std::cout << "Address: 0x" << std::hex << address << std::endl;
-        std::cout << "VEX Opcode: 0x" << std::hex << (int)vex_opcode << std::endl;
-        std::cout << "Map Select: " << std::dec << vex_prefix.map_select << std::endl;
-	*/
-        if (auto it = vex_opcode_to_mnemonic.find({vex_prefix.map_select, vex_opcode}); it != vex_opcode_to_mnemonic.end()) {
-            std::string mnemonic = it->second;
-            // std::cout << "Mnemonic Found: " << mnemonic << std::endl;
-            std::transform(mnemonic.begin(), mnemonic.end(), mnemonic.begin(), ::tolower);
-            decoded_instr->mnemonic = mnemonic;
-        } else {
-	  //std::cout << "Mnemonic NOT Found" << std::endl;
-            decoded_instr->mnemonic = "avx_instruction_unknown";
-        }
+        Mnemonic mnemonic = vex_prefix.map_select == 1 ? kVex0FOpcodes[vex_opcode].mnemonic : Mnemonic::Unknown;
+        out.mnemonic = mnemonic == Mnemonic::Unknown ? Mnemonic::AvxUnknown : mnemonic;
 
-
-        decodeAVXOperands(*decoded_instr, vex_prefix, memory, current_address);
-        decoded_instr->length_in_bytes = vex_prefix.bytes + 1 + 1; // VEX + opcode + ModR/M
-        for (const auto& op : decoded_instr->operands) {
-            if (op.type == OperandType::MEMORY) {
-                decoded_instr->length_in_bytes += 4; // 32-bit displacement
-                break;
-            }
-        } 
-
-    } else if (opcode == 0x0F) {
-        current_address++;
-        uint8_t next_byte = memory.read_text(current_address);
-        if (next_byte == 0xB6) { // MOVZX
-            decoded_instr->mnemonic = "movzx";
-        } else if (next_byte == 0xBE) { // MOVSX
-            decoded_instr->mnemonic = "movsx";
-        } else if (next_byte == 0x8E) { // JLE
-            decoded_instr->mnemonic = "jle";
+        decodeAVXOperands(out, vex_prefix, memory, current_address);
+        out.length_in_bytes = vex_prefix.bytes + 1; // VEX + opcode
+        if (mnemonic != Mnemonic::Vzeroupper) {
+            out.length_in_bytes += 1; // ModR/M
         }
-        auto it = two_byte_opcode_to_mnemonic.find(next_byte);
-        if (it != two_byte_opcode_to_mnemonic.end()) {
-            decoded_instr->mnemonic = it->second;
-            std::transform(decoded_instr->mnemonic.begin(), decoded_instr->mnemonic.end(), decoded_instr->mnemonic.begin(), ::tolower);
-
-            const auto& mnemonic = decoded_instr->mnemonic;
-            if (mnemonic == "jo" || mnemonic == "jno" || mnemonic == "jb" || mnemonic == "jae" ||
-                mnemonic == "je" || mnemonic == "jne" || mnemonic == "jbe" || mnemonic == "js" ||
-                mnemonic == "jns" || mnemonic == "jl" || mnemonic == "jge" || mnemonic == "jle" ||
-                mnemonic == "jg") {
-                decoded_instr->length_in_bytes = 6;
-                current_address++;
-                int32_t offset = memory.read_text_dword(current_address);
-                address_t target_address = address + decoded_instr->length_in_bytes + offset;
-                DecodedOperand op;
-                op.type = OperandType::IMMEDIATE;
-                op.value = target_address;
-                std::stringstream ss;
-                ss << "0x" << std::hex << target_address;
-                op.text = ss.str();
-                decoded_instr->operands.push_back(op);
-            } else if (decoded_instr->mnemonic == "movsx") {
-                decoded_instr->length_in_bytes = 3; // 0F + BE + ModRM
-                current_address++;
-                uint8_t modrm = memory.read_text(current_address);
-                uint8_t reg_field = (modrm >> 3) & 0x07;
-                uint8_t rm = modrm & 0x07;
-
-                DecodedOperand dest, src;
-                dest.type = OperandType::REGISTER;
-                dest.text = getRegisterName(reg_field); // Destination is r32
-
-                src.type = OperandType::REGISTER;
-                src.text = getRegisterName8(rm); // Source is r8
-
-                decoded_instr->operands.push_back(dest);
-                decoded_instr->operands.push_back(src);
-            } else if (decoded_instr->mnemonic == "movzx") {
-                decoded_instr->length_in_bytes = 3; // 0F + B6 + ModRM
-                current_address++;
-                uint8_t modrm = memory.read_text(current_address);
-                uint8_t reg_field = (modrm >> 3) & 0x07;
-                uint8_t rm = modrm & 0x07;
-
-                DecodedOperand dest, src;
-                dest.type = OperandType::REGISTER;
-                dest.text = getRegisterName(reg_field); // Destination is r32
-
-                src.type = OperandType::REGISTER;
-                src.text = getRegisterName8(rm); // Source is r8
-
-                decoded_instr->operands.push_back(dest);
-                decoded_instr->operands.push_back(src);
+        for (uint8_t i = 0; i < out.operand_count; ++i) {
+            if (out.operands[i].type == OperandType::MEMORY) {
+                out.length_in_bytes += 4; // 32-bit displacement
+                break;
             }
         }
-    } else if (opcode == 0x66) { // Operand-size override prefix
-        current_address++;
-        uint8_t next_byte = memory.read_text(current_address);
-        if (next_byte == 0xA5) {
-            decoded_instr->mnemonic = "movsw";
-            decoded_instr->length_in_bytes = 2;
-        }
-    } else {
-        // Existing logic for non-AVX instructions
-        current_address++;
-        std::string mnemonic = decodeMnemonic(opcode);
-        std::transform(mnemonic.begin(), mnemonic.end(), mnemonic.begin(), ::tolower);
-        decoded_instr->mnemonic = mnemonic;
-        if (decoded_instr->mnemonic == "UNKNOWN") {
-            return nullptr;
-        }
-
-        if (opcode == 0xA1) { // MOV EAX, [addr32]
-            decoded_instr->length_in_bytes = 5;
-            address_t mem_address = memory.read_text_dword(current_address);
-            
-            DecodedOperand dest, src;
-            dest.type = OperandType::REGISTER;
-            dest.text = "eax";
-            
-            src.type = OperandType::MEMORY;
-            src.value = mem_address;
-            std::stringstream ss;
-            ss << "[0x" << std::hex << mem_address << "]";
-            src.text = ss.str();
-            
-            decoded_instr->operands.push_back(dest);
-            decoded_instr->operands.push_back(src);
-        } else if (opcode >= 0xB8 && opcode <= 0xBF) { // MOV r32, imm32
-            decoded_instr->length_in_bytes = 5;
-            uint32_t imm_value = memory.read_text_dword(current_address);
-            DecodedOperand reg, imm;
-            reg.type = OperandType::REGISTER;
-            reg.text = getRegisterName(opcode - 0xB8);
-            imm.type = OperandType::IMMEDIATE;
-            imm.value = imm_value;
-            std::stringstream ss;
-            ss << "0x" << std::hex << imm_value;
-            imm.text = ss.str();
-            decoded_instr->operands.push_back(reg);
-            decoded_instr->operands.push_back(imm);
-        } else if (opcode == 0x89 || opcode == 0x01 || opcode == 0x29 || opcode == 0x39 || opcode == 0x21 || opcode == 0x09 || opcode == 0x31 || opcode == 0x87) { // Register-register operations
-            decoded_instr->length_in_bytes = 2;
-            uint8_t modrm = memory.read_text(current_address);
-            decodeModRM(modrm, *decoded_instr, false);
-        } else if (opcode == 0x8D) { // LEA r32, m
-            decoded_instr->length_in_bytes = 2; // Base length
-            uint8_t modrm = memory.read_text(current_address);
-            uint8_t mod = (modrm >> 6) & 0x03;
-            uint8_t reg_field = (modrm >> 3) & 0x07;
-            uint8_t rm = modrm & 0x07;
-
-            DecodedOperand dest_reg, src_mem;
-
-            dest_reg.type = OperandType::REGISTER;
-            dest_reg.text = getRegisterName(reg_field);
-
-            src_mem.type = OperandType::MEMORY;
-            // This is a simplified decoder for [reg] form
-            if (mod == 0b00 && rm != 0b101) {
-                src_mem.text = "[" + std::string(getRegisterName(rm)) + "]";
-            } else {
-                // More complex ModR/M forms (with displacement, SIB byte) would be handled here.
-                src_mem.text = "[mem]";
-            }
-
-            decoded_instr->operands.push_back(dest_reg);
-            decoded_instr->operands.push_back(src_mem);
-        } else if (opcode == 0xFF) { // INC r/m32
-            decoded_instr->length_in_bytes = 2;
-            uint8_t modrm = memory.read_text(current_address);
-            uint8_t reg_field = (modrm >> 3) & 0x07;
-            if (reg_field == 0) decoded_instr->mnemonic = "inc";
-            else if (reg_field == 1) decoded_instr->mnemonic = "dec";
-            // other group members...
-
-            uint8_t rm = modrm & 0x07;
-            DecodedOperand op;
-            op.type = OperandType::REGISTER;
-            op.text = getRegisterName(rm);
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0xF7) { // Group with MUL, DIV, NOT
-            decoded_instr->length_in_bytes = 2;
-            uint8_t modrm = memory.read_text(current_address);
-            uint8_t reg_field = (modrm >> 3) & 0x07;
-            if (reg_field == 2) decoded_instr->mnemonic = "not";
-            else if (reg_field == 4) decoded_instr->mnemonic = "mul";
-            else if (reg_field == 5) decoded_instr->mnemonic = "imul";
-            else if (reg_field == 6) decoded_instr->mnemonic = "div";
-            else if (reg_field == 7) decoded_instr->mnemonic = "idiv";
-            // other group members...
+        return true;
+    }
 
-            uint8_t rm = modrm & 0x07;
-            DecodedOperand op;
-            op.type = OperandType::REGISTER;
-            op.text = getRegisterName(rm);
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x83) { // Group with ADD, OR, ADC, SBB, AND, SUB, XOR, CMP with imm8
-            decoded_instr->length_in_bytes = 3;
-            uint8_t modrm = memory.read_text(current_address++);
-            uint8_t imm = memory.read_text(current_address);
-            uint8_t reg_field = (modrm >> 3) & 0x07;
-
-            // Decode the specific instruction from the /reg field
-            if (reg_field == 6) {
-                decoded_instr->mnemonic = "xor";
-            } else if (reg_field == 7) {
-                decoded_instr->mnemonic = "cmp";
-            }
-            // Other instructions in this group (ADD, OR, etc.) can be added here.
-
-
-            DecodedOperand reg, imm_op;
-            reg.type = OperandType::REGISTER;
-            reg.text = getRegisterName(modrm & 0x07);
-            imm_op.type = OperandType::IMMEDIATE;
-            imm_op.value = imm;
-            std::stringstream ss;
-            ss << "0x" << std::hex << (int)imm;
-            imm_op.text = ss.str();
-            decoded_instr->operands.push_back(reg);
-            decoded_instr->operands.push_back(imm_op);
-        } else if (opcode == 0xC1) { // Group with SHL, SHR, etc. with imm8
-            decoded_instr->length_in_bytes = 3;
-            uint8_t modrm = memory.read_text(current_address++);
-            uint8_t imm = memory.read_text(current_address);
-            uint8_t reg_field = (modrm >> 3) & 0x07;
-
-            // Decode the specific instruction from the /reg field
-            if (reg_field == 0) {
-                decoded_instr->mnemonic = "rol";
-            } else if (reg_field == 1) {
-                decoded_instr->mnemonic = "ror";
-            }else if (reg_field == 4) {
-                decoded_instr->mnemonic = "shl";
-            } else if (reg_field == 5) {
-                decoded_instr->mnemonic = "shr";
-            } else if (reg_field == 7) {
-                decoded_instr->mnemonic = "sar";
-            }
-            // Other instructions in this group (SHR, SAR, ROL, etc.) can be added here.
-
-            DecodedOperand reg, imm_op;
-            reg.type = OperandType::REGISTER;
-            reg.text = getRegisterName(modrm & 0x07);
-            imm_op.type = OperandType::IMMEDIATE;
-            imm_op.value = imm;
-            std::stringstream ss;
-            ss << "0x" << std::hex << (int)imm;
-            imm_op.text = ss.str();
-            decoded_instr->operands.push_back(reg);
-            decoded_instr->operands.push_back(imm_op);
-        } else if (opcode == 0x75) { // JNE rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-            // Operand is the target address
-        } else if (opcode == 0x74) { // JE rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x72) { // JB rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x73) { // JAE rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x76) { // JBE rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x78) { // JS rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x79) { // JNS rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x70) { // JO rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x71) { // JNO rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x7C) { // JL rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x7D) { // JGE rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0x7F) { // JG rel8
-            decoded_instr->length_in_bytes = 2;
-            int8_t offset = memory.read_text(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-        } else if (opcode == 0xE9 || opcode == 0xE8) { // JMP rel32 or CALL rel32
-            decoded_instr->length_in_bytes = 5;
-            int32_t offset = memory.read_text_dword(current_address);
-            address_t target_address = address + decoded_instr->length_in_bytes + offset;
-            DecodedOperand op;
-            op.type = OperandType::IMMEDIATE;
-            op.value = target_address;
-            std::stringstream ss;
-            ss << "0x" << std::hex << target_address;
-            op.text = ss.str();
-            decoded_instr->operands.push_back(op);
-
-        } else if (opcode >= 0x50 && opcode <= 0x57) { // PUSH r32
-            decoded_instr->mnemonic = "push";
-            decoded_instr->length_in_bytes = 1;
-            DecodedOperand reg;
-            reg.type = OperandType::REGISTER;
-            reg.text = getRegisterName(opcode - 0x50);
-            decoded_instr->operands.push_back(reg);
-        } else if (opcode >= 0x58 && opcode <= 0x5F) { // POP r32
-            decoded_instr->mnemonic = "pop";
-            decoded_instr->length_in_bytes = 1;
-            DecodedOperand reg;
-            reg.type = OperandType::REGISTER;
-            reg.text = getRegisterName(opcode - 0x58);
-            decoded_instr->operands.push_back(reg);
-        } else if (opcode == 0xCD) { // INT imm8
-            decoded_instr->length_in_bytes = 2;
-            uint8_t imm_value = memory.read_text(current_address);
-            DecodedOperand imm;
-            imm.type = OperandType::IMMEDIATE;
-            imm.value = imm_value;
-            std::stringstream ss;
-            ss << "0x" << std::hex << (int)imm_value;
-            imm.text = ss.str();
-            decoded_instr->operands.push_back(imm);
-        } else if (opcode == 0xE4) { // IN AL, imm8
-            decoded_instr->length_in_bytes = 2;
-            uint8_t imm_value = memory.read_text(current_address);
-            DecodedOperand reg, imm;
-            reg.type = OperandType::REGISTER;
-            reg.text = "al";
-            imm.type = OperandType::IMMEDIATE;
-            imm.value = imm_value;
-            std::stringstream ss;
-            ss << "0x" << std::hex << (int)imm_value;
-            imm.text = ss.str();
-            decoded_instr->operands.push_back(reg);
-            decoded_instr->operands.push_back(imm);
-        } else if (opcode == 0xE6) { // OUT imm8, AL
-            decoded_instr->length_in_bytes = 2;
-            uint8_t imm_value = memory.read_text(current_address);
-            DecodedOperand imm, reg;
-            imm.type = OperandType::IMMEDIATE;
-            imm.value = imm_value;
-            std::stringstream ss;
-            ss << "0x" << std::hex << (int)imm_value;
-            imm.text = ss.str();
-            reg.type = OperandType::REGISTER;
-            reg.text = "al";
-            decoded_instr->operands.push_back(imm);
-            decoded_instr->operands.push_back(reg);
-        } else {
-            decoded_instr->length_in_bytes = getInstructionLength(opcode);
-            // No specific operand decoding for this instruction yet
+    if (opcode == 0x66) { // Operand-size override prefix
+        if (memory.read_text(address + 1) == 0xA5) {
+            out.mnemonic = Mnemonic::Movsw;
+            out.length_in_bytes = 2;
         }
+        return true;
     }
 
-    return decoded_instr;
+    const bool two_byte = opcode == 0x0F;
+    if (two_byte) {
+        opcode = memory.read_text(++current_address);
+    }
+    const OpcodeInfo& info = two_byte ? kTwoByteOpcodes[opcode] : kOneByteOpcodes[opcode];
+    out.mnemonic = info.mnemonic;
+    // Unknown two-byte opcodes have no length so callers stop there; unknown
+    // one-byte opcodes are skipped a byte at a time.
+    out.length_in_bytes = two_byte && info.mnemonic == Mnemonic::Unknown ? 0 : info.length;
+    decodeOperands(info, opcode, memory, current_address + 1, out);
+    return true;
 }
 
-std::string Decoder::decodeMnemonic(uint8_t instruction_id) const {
-    auto it = opcode_to_mnemonic.find(instruction_id);
-    if (it != opcode_to_mnemonic.end()) {
-        return it->second;
+std::unique_ptr<DecodedInstruction> Decoder::decodeInstruction(const Memory& memory, address_t address) {
+    CompactDecodedInstruction compact;
+    if (!decode(memory, address, compact)) {
+        return nullptr;
     }
-    return "UNKNOWN";
+    return std::make_unique<DecodedInstruction>(format_instruction(compact));
 }
 
-DecodedOperand Decoder::decodeOperand(uint64_t encoded_operand) const {
+std::string Decoder::decodeMnemonic(uint8_t instruction_id) {
+    return getMnemonic(instruction_id);
+}
+
+DecodedOperand Decoder::decodeOperand(uint64_t encoded_operand) {
     // This is a placeholder; a real implementation would be much more complex.
     DecodedOperand operand;
     operand.text = "0x" + std::to_string(encoded_operand);
@@ -747,93 +411,51 @@ DecodedOperand Decoder::decodeOperand(uint64_t encoded_operand) const {
     return operand;
 }
 
-size_t Decoder::getInstructionLength(uint8_t instruction_id) const {
-    auto it = instruction_lengths.find(instruction_id);
-    if (it != instruction_lengths.end()) {
-        return it->second;
-    }
-    return 1; // Default length
+size_t Decoder::getInstructionLength(uint8_t instruction_id) {
+    return kOneByteOpcodes[instruction_id].length;
 }
 
-void Decoder::decodeAVXOperands(DecodedInstruction& instr, const VEX_Prefix& vex_prefix, const Memory& memory, address_t opcode_address) {
+void Decoder::decodeAVXOperands(CompactDecodedInstruction& instr, const VEX_Prefix& vex_prefix, const Memory& memory, address_t opcode_address) {
     uint8_t modrm = memory.read_text(opcode_address + 1);
     uint8_t mod = (modrm >> 6) & 0x03;
     uint8_t reg = (modrm >> 3) & 0x07;
     uint8_t rm  = modrm & 0x07;
 
-    if (instr.mnemonic == "vaddps" || instr.mnemonic == "vdivps" || instr.mnemonic == "vmaxps" || instr.mnemonic == "vpandn" || instr.mnemonic == "vpand" || instr.mnemonic == "vpmullw" || instr.mnemonic == "vminps" || instr.mnemonic == "vpxor" || instr.mnemonic == "vsubps" || instr.mnemonic == "vpor") {
-        DecodedOperand dest, src1, src2;
-        std::string reg_prefix = vex_prefix.L ? "ymm" : "xmm";
-
-        dest.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
-        dest.text = reg_prefix + std::to_string(reg);
-
-        src1.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
-        src1.text = reg_prefix + std::to_string(~vex_prefix.vvvv & 0b1111);
+    uint8_t vex_opcode = memory.read_text(opcode_address);
+    OperandForm form = vex_prefix.map_select == 1 ? kVex0FOpcodes[vex_opcode].form : OperandForm::None;
 
+    // r/m as a register, or a RIP-relative address; other memory forms are
+    // not decoded yet and leave an empty operand.
+    auto rm_operand = [&](bool rip_relative) {
+        CompactOperand op;
         if (mod == 0b11) { // Register-to-register
-            src2.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
-            src2.text = reg_prefix + std::to_string(rm);
-        } else {
-            // Memory operand decoding not implemented yet.
-        }
-
-        instr.operands.push_back(dest);
-        instr.operands.push_back(src1);
-        instr.operands.push_back(src2);
-    } else if (instr.mnemonic == "vmovups") {
-        DecodedOperand op1, op2;
-        std::string reg_prefix = vex_prefix.L ? "ymm" : "xmm";
-
-        op1.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
-        op1.text = reg_prefix + std::to_string(reg);
-
-        if (mod == 0b11) { // Register-to-register
-            op2.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
-            op2.text = reg_prefix + std::to_string(rm);
-        } else if (mod == 0b00 && rm == 0b101) { // Memory operand with 32-bit displacement
-            // This is RIP-relative addressing. The value in memory is a 32-bit displacement
-            // from the address of the *next* instruction.
-            op2.type = OperandType::MEMORY;
+            op = vector_operand(rm, vex_prefix);
+        } else if (rip_relative && mod == 0b00 && rm == 0b101) {
+            // The value in memory is a 32-bit displacement from the address
+            // of the *next* instruction.
             int32_t disp = memory.read_text_dword(opcode_address + 2);
             address_t next_instr_addr = instr.address + vex_prefix.bytes + 1 + 1 + 4;
-            op2.value = next_instr_addr + disp;
-            std::stringstream ss;
-            ss << "[0x" << std::hex << op2.value << "]";
-            op2.text = ss.str();
+            op = memory_operand(next_instr_addr + disp);
         }
+        return op;
+    };
 
-        uint8_t vex_opcode = memory.read_text(opcode_address);
+    if (form == OperandForm::VexNds) {
+        instr.add_operand(vector_operand(reg, vex_prefix));
+        instr.add_operand(vector_operand(~vex_prefix.vvvv & 0b1111, vex_prefix));
+        instr.add_operand(rm_operand(false));
+    } else if (form == OperandForm::VexMove) {
         if (vex_opcode == 0x10) { // Load from memory
-            instr.operands.push_back(op1); // dest is register
-            instr.operands.push_back(op2); // src is memory/register
-        } else if (vex_opcode == 0x11) { // Store to memory
-            instr.operands.push_back(op2); // dest is memory/register
-            instr.operands.push_back(op1); // src is register
+            instr.add_operand(vector_operand(reg, vex_prefix)); // dest is register
+            instr.add_operand(rm_operand(true));                // src is memory/register
+        } else { // Store to memory
+            instr.add_operand(rm_operand(true));                // dest is memory/register
+            instr.add_operand(vector_operand(reg, vex_prefix)); // src is register
         }
-    } else if (instr.mnemonic == "vrcpps" || instr.mnemonic == "vsqrtps") {
-        DecodedOperand dest, src;
-        std::string reg_prefix = vex_prefix.L ? "ymm" : "xmm";
-
-        dest.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
-        dest.text = reg_prefix + std::to_string(reg);
-
-        if (mod == 0b11) { // Register source
-            src.type = vex_prefix.L ? OperandType::YMM_REGISTER : OperandType::XMM_REGISTER;
-            src.text = reg_prefix + std::to_string(rm);
-        } else if (mod == 0b00 && rm == 0b101) { // Memory source (RIP-relative)
-            src.type = OperandType::MEMORY;
-            int32_t disp = memory.read_text_dword(opcode_address + 2);
-            address_t next_instr_addr = instr.address + vex_prefix.bytes + 1 + 1 + 4;
-            src.value = next_instr_addr + disp;
-            std::stringstream ss;
-            ss << "[0x" << std::hex << src.value << "]";
-            src.text = ss.str();
-        }
-
-        instr.operands.push_back(dest);
-        instr.operands.push_back(src);
-    } 
+    } else if (form == OperandForm::VexUnary) {
+        instr.add_operand(vector_operand(reg, vex_prefix));
+        instr.add_operand(rm_operand(true));
+    }
 }
 
 VEX_Prefix Decoder::decodeVEXPrefix(const Memory& memory, address_t& address) {
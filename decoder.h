@@ -6,7 +6,6 @@
 #include <vector>
 #include <optional>
 #include <memory>
-#include <map>
 #include "memory.h" // For address_t
 #include "operand_types.h" // For address_t
 
@@ -30,7 +29,8 @@ struct DecodedOperand {
   // Add more details, e.g., type (immediate, register, memory)
 };
 
-// Represents a single fully decoded instruction
+// Represents a single fully decoded instruction, with text. This is the
+// display form; execution works on CompactDecodedInstruction.
 struct DecodedInstruction {
   address_t address;
   std::string mnemonic;
@@ -38,44 +38,74 @@ struct DecodedInstruction {
   size_t length_in_bytes;
 };
 
-// The core Decoder class
-class Decoder {
-private:
-  // Helper function to decode the opcode to a mnemonic.
-  Decoder();
-  // Private static instance
-  static std::unique_ptr<Decoder> instance;
+// Instruction mnemonics known to the decoder. mnemonic_name() gives the
+// lower-case text stored in DecodedInstruction::mnemonic.
+enum class Mnemonic : uint8_t {
+  Unknown,
+  Add, And, Call, Cmp, Dec, Div, Idiv, Imul, In, Inc, Int,
+  Ja, Jae, Jb, Jbe, Je, Jg, Jge, Jl, Jle, Jmp, Jne, Jno, Jns, Jo, Js,
+  Lea, Mov, Movsb, Movsd, Movsw, Movsx, Movzx, Mul, Nop, Not, Or, Out,
+  Pop, Push, Ret, Rol, Ror, Sar, Shl, Shr, Sub, Xchg, Xor,
+  // Group opcodes whose ModR/M reg field selects no known instruction.
+  GroupC1, GroupF7, GroupFF,
+  Vaddps, Vdivps, Vmaxps, Vminps, Vmovups, Vpand, Vpandn, Vpmullw, Vpor, Vpxor,
+  Vrcpps, Vsqrtps, Vsubps, Vzeroupper, AvxUnknown,
+  Count
+};
 
-  std::map<uint8_t, std::string> opcode_to_mnemonic;
-  std::map<uint8_t, std::string> two_byte_opcode_to_mnemonic;
-  std::map<std::tuple<int, uint8_t>, std::string> vex_opcode_to_mnemonic;
-  std::map<std::string, uint8_t> mnemonic_to_opcode;
-  std::map<uint8_t, size_t> instruction_lengths;
+const char* mnemonic_name(Mnemonic mnemonic);
+// Inverse of mnemonic_name(); Unknown for text the decoder never produces.
+Mnemonic mnemonic_from_name(const std::string& name);
 
-public:
-  // Decodes the instruction at the given address in memory.
+// An operand as decoded: numbers only, no text. instruction_formatter.h turns
+// it into a DecodedOperand for display.
+struct CompactOperand {
+  OperandType type = OperandType::UNKNOWN_OPERAND_TYPE;
+  uint8_t reg = 0;        // Register number; the base register of a [reg] MEMORY operand.
+  bool has_base = false;  // MEMORY addressed through `reg` rather than `value`.
+  bool resolved = true;   // false for memory forms the decoder does not take apart.
+  uint16_t size = 0;      // Register width in bits: 8, 32, 128 or 256.
+  uint64_t value = 0;     // Immediate, branch target or absolute address.
+};
 
-  Decoder(const Decoder&) = delete;
-  Decoder(Decoder&&) = delete;
-  Decoder& operator=(const Decoder&) = delete;
-  Decoder& operator=(Decoder&&) = delete;
-  ~Decoder() = default;
+// The allocation-free result of Decoder::decode(). Trivially copyable, so
+// caches keep these by value.
+struct CompactDecodedInstruction {
+  static constexpr size_t kMaxOperands = 3;
 
-  // Static method to get the single instance
-  static Decoder& getInstance();
-  // Static method to reset the single instance (for testing)
-  static void resetInstance();
+  address_t address = 0;
+  Mnemonic mnemonic = Mnemonic::Unknown;
+  uint8_t operand_count = 0;
+  uint8_t length_in_bytes = 0;
+  CompactOperand operands[kMaxOperands];
 
+  void add_operand(const CompactOperand& operand) {
+    if (operand_count < kMaxOperands) {
+      operands[operand_count++] = operand;
+    }
+  }
+};
+
+// The core Decoder class. Opcode maps are constexpr tables in decoder.cpp and
+// every member is static and reads only those tables and the given Memory, so
+// any number of threads and simulators can decode concurrently without locks.
+// Instances are empty and may be created freely.
+class Decoder {
+public:
   // Helper function to decode an encoded operand.
-  DecodedOperand decodeOperand(uint64_t encoded_operand) const;
-  std::string getMnemonic(uint8_t opcode) const;
-  std::string decodeMnemonic(uint8_t instruction_id) const;  
-  std::unique_ptr<DecodedInstruction> decodeInstruction(const Memory& memory, address_t address);
-  VEX_Prefix decodeVEXPrefix(const Memory& memory, address_t& address);
-  void decodeAVXOperands(DecodedInstruction& instr, const VEX_Prefix& vex_prefix, const Memory& memory, address_t opcode_address);
-  uint8_t getOpcode(const std::string& mnemonic) const;
+  static DecodedOperand decodeOperand(uint64_t encoded_operand);
+  static std::string getMnemonic(uint8_t opcode);
+  static std::string decodeMnemonic(uint8_t instruction_id);
+  // Decodes the instruction at `address` into `out` without allocating.
+  // Returns false for addresses outside the text segment.
+  static bool decode(const Memory& memory, address_t address, CompactDecodedInstruction& out);
+  // decode() followed by format_instruction(), for callers that want text.
+  static std::unique_ptr<DecodedInstruction> decodeInstruction(const Memory& memory, address_t address);
+  static VEX_Prefix decodeVEXPrefix(const Memory& memory, address_t& address);
+  static void decodeAVXOperands(CompactDecodedInstruction& instr, const VEX_Prefix& vex_prefix, const Memory& memory, address_t opcode_address);
+  static uint8_t getOpcode(const std::string& mnemonic);
 
-  size_t getInstructionLength(uint8_t instruction_id) const;
+  static size_t getInstructionLength(uint8_t instruction_id);
 };
 
 #endif // DECODER_H
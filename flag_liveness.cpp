@@ -0,0 +1,66 @@
+#include "flag_liveness.h"
+
+namespace {
+
+// Overwrites all six status flags without reading any of them.
+bool writes_all_flags(IROpcode opcode) {
+    switch (opcode) {
+        case IROpcode::Add:
+        case IROpcode::Sub:
+        case IROpcode::Cmp:
+        case IROpcode::And:
+        case IROpcode::Or:
+        case IROpcode::Xor:
+        case IROpcode::Zero:
+        case IROpcode::CmpBranch:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Writes every status flag except CF, which passes through unchanged.
+bool preserves_carry(IROpcode opcode) {
+    return opcode == IROpcode::Inc || opcode == IROpcode::Dec || opcode == IROpcode::DecBranch;
+}
+
+// Neither reads nor writes flags.
+bool ignores_flags(IROpcode opcode) {
+    switch (opcode) {
+        case IROpcode::Move:
+        case IROpcode::Load:
+        case IROpcode::Store:
+        case IROpcode::Not:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+size_t analyze_flag_liveness(std::vector<IRInstruction>& instructions) {
+    size_t dead_writes = 0;
+    bool live = true; // Conservatively live at the block exit.
+    for (auto it = instructions.rbegin(); it != instructions.rend(); ++it) {
+        if (writes_all_flags(it->opcode)) {
+            it->flags_live = live;
+            if (!live) {
+                ++dead_writes;
+            }
+            live = false;
+        } else if (preserves_carry(it->opcode)) {
+            // CF from before still reaches whoever reads after, so liveness
+            // is unchanged across the instruction.
+            it->flags_live = live;
+            if (!live) {
+                ++dead_writes;
+            }
+        } else if (!ignores_flags(it->opcode)) {
+            // Branches read flags; shifts, multiplies and
+            // anything else are treated as readers to stay safe.
+            live = true;
+        }
+    }
+    return dead_writes;
+}
@@ -0,0 +1,23 @@
+#ifndef FLAG_LIVENESS_H
+#define FLAG_LIVENESS_H
+
+#include <cstddef>
+#include <vector>
+#include "ir.h"
+
+/**
+ * @brief Marks flag writes in a straight-line instruction sequence that no
+ *        later instruction can observe.
+ *
+ * Walks the block backwards. Flags are assumed live at the block exit (the
+ * successor may read them) and at any instruction that reads flags or whose
+ * flag behaviour is not modelled here. An Add, Sub, Cmp, And, Or, Xor or Zero
+ * whose flags are overwritten by a later full flag writer before being read
+ * gets flags_live = false, and the executor then skips its flag computation.
+ * Inc and Dec keep CF, so they are dead only where the flags after them are.
+ *
+ * @return The number of instructions whose flag writes were found dead.
+ */
+size_t analyze_flag_liveness(std::vector<IRInstruction>& instructions);
+
+#endif // FLAG_LIVENESS_H
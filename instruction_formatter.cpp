@@ -0,0 +1,68 @@
+#include "instruction_formatter.h"
+#include <sstream>
+
+namespace {
+
+std::string hex_text(uint64_t value) {
+    std::stringstream ss;
+    ss << "0x" << std::hex << value;
+    return ss.str();
+}
+
+} // namespace
+
+// Helper to get 32-bit register name from index
+const char* getRegisterName(uint8_t index) {
+    static const char* registers[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
+    if (index < 8) return registers[index];
+    return "err";
+}
+
+// Helper to get 8-bit register name from index
+const char* getRegisterName8(uint8_t index) {
+    static const char* registers[] = {"al", "cl", "dl", "bl", "ah", "ch", "dh", "bh"};
+    if (index < 8) return registers[index];
+    return "err";
+}
+
+std::string format_operand_text(const CompactOperand& operand) {
+    switch (operand.type) {
+        case OperandType::REGISTER:
+            return operand.size == 8 ? getRegisterName8(operand.reg) : getRegisterName(operand.reg);
+        case OperandType::XMM_REGISTER:
+            return "xmm" + std::to_string(operand.reg);
+        case OperandType::YMM_REGISTER:
+            return "ymm" + std::to_string(operand.reg);
+        case OperandType::IMMEDIATE:
+        case OperandType::LABEL:
+            return hex_text(operand.value);
+        case OperandType::MEMORY:
+            if (!operand.resolved) {
+                return "[mem]";
+            }
+            return "[" + (operand.has_base ? std::string(getRegisterName(operand.reg)) : hex_text(operand.value)) + "]";
+        case OperandType::UNKNOWN_OPERAND_TYPE:
+            break;
+    }
+    return "";
+}
+
+DecodedOperand format_operand(const CompactOperand& operand) {
+    DecodedOperand decoded;
+    decoded.text = format_operand_text(operand);
+    decoded.value = operand.value;
+    decoded.type = operand.type;
+    return decoded;
+}
+
+DecodedInstruction format_instruction(const CompactDecodedInstruction& instr) {
+    DecodedInstruction decoded;
+    decoded.address = instr.address;
+    decoded.mnemonic = mnemonic_name(instr.mnemonic);
+    decoded.length_in_bytes = instr.length_in_bytes;
+    decoded.operands.reserve(instr.operand_count);
+    for (uint8_t i = 0; i < instr.operand_count; ++i) {
+        decoded.operands.push_back(format_operand(instr.operands[i]));
+    }
+    return decoded;
+}
@@ -0,0 +1,21 @@
+#ifndef INSTRUCTION_FORMATTER_H
+#define INSTRUCTION_FORMATTER_H
+
+#include <cstdint>
+#include <string>
+#include "decoder.h"
+
+// Text for decoded instructions. Decoding produces numbers only; text is
+// built here on demand for the places that show it: the UI's text window
+// and InstructionDescriber (through ProgramDecoder) and dumpTextSegment.
+
+// "eax".."edi", or "err" past 7.
+const char* getRegisterName(uint8_t index);
+// "al".."bh", or "err" past 7.
+const char* getRegisterName8(uint8_t index);
+
+std::string format_operand_text(const CompactOperand& operand);
+DecodedOperand format_operand(const CompactOperand& operand);
+DecodedInstruction format_instruction(const CompactDecodedInstruction& instr);
+
+#endif // INSTRUCTION_FORMATTER_H
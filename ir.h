@@ -27,6 +27,8 @@ enum class IROpcode {
     Mul,    // dest, src1, src2
     IMul,   // dest, src1, src2 (signed multiply)
     Div,    // dest, src1, src2
+    Inc,    // dest (CF preserved)
+    Dec,    // dest (CF preserved)
 
     // Logical
     And,    // dest, src1, src2
@@ -74,8 +76,17 @@ enum class IROpcode {
 
     // Comparison
     Cmp,    // src1, src2 (sets flags)
+
+    // === Superinstructions ===
+    // Produced only by fuse_superinstructions() inside a basic block.
+    CmpBranch, // target, condition, src1, src2 (Cmp followed by Branch)
+    DecBranch, // target, condition, dest (Dec followed by JZ/JNZ)
+    Zero,      // dest (Xor of a register with itself)
 };
 
+// Number of IROpcode values; Zero must stay the last enumerator.
+constexpr size_t kNumIROpcodes = static_cast<size_t>(IROpcode::Zero) + 1;
+
 /**
  * @brief Defines the condition codes for branch instructions.
  *
@@ -103,6 +114,9 @@ enum class IRConditionCode {
     NotSign,        // JNS
 };
 
+// Number of IRConditionCode values; NotSign must stay the last enumerator.
+constexpr size_t kNumIRConditionCodes = static_cast<size_t>(IRConditionCode::NotSign) + 1;
+
 /**
  * @brief Defines the type of an abstract register.
  */
@@ -121,6 +135,9 @@ struct IRRegister {
     IRRegisterType type;
     uint32_t index; // e.g., 0 for GPR0, 1 for GPR1
     uint32_t size;  // Size in bits: 8, 16, 32, 64, 128, 256
+    // Register-file slot resolved at translation time (Reg64 for GPR/IP,
+    // RegYMM for VECTOR), or -1 if the executor must look the name up.
+    int32_t slot = -1;
 
     bool operator==(const IRRegister& other) const {
         return type == other.type && index == other.index && size == other.size;
@@ -154,6 +171,12 @@ using IROperand = std::variant<
 /**
  * @brief Represents a single, architecture-agnostic instruction in the Intermediate Representation.
  */
+class IRInstruction;
+class X86Simulator;
+
+// Executor entry point for one IR instruction; see ir_dispatch.h.
+using IRHandler = void (*)(const IRInstruction&, X86Simulator&);
+
 class IRInstruction {
 public:
     IRInstruction(IROpcode op, std::vector<IROperand> ops = {})
@@ -165,9 +188,16 @@ public:
     // Optional: Metadata about the original instruction
     uint64_t original_address = 0;
     uint32_t original_size = 0;
+
+    // Cleared by the flag-liveness pass when no later instruction can read the
+    // flags this instruction writes, so the executor may skip computing them.
+    bool flags_live = true;
+
+    // Handler chosen for this opcode and operand shape when the instruction was
+    // translated, or nullptr if it has not been bound yet.
+    IRHandler handler = nullptr;
 };
 
-// A program is a sequence of IR instructions.
-using IRProgram = std::vector<std::unique_ptr<IRInstruction>>;
+// ir_compact.h has a trivially-copyable encoding used to serialize IR.
 
 #endif // IR_H
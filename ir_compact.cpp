@@ -0,0 +1,135 @@
+#include "ir_compact.h"
+#include <cstring>
+#include <utility>
+#include <variant>
+
+namespace {
+
+bool pack_register(const IRRegister& reg, CompactIRRegister& out) {
+    if (reg.index > UINT8_MAX || reg.size % 8 != 0 || reg.size / 8 > UINT8_MAX ||
+        reg.slot < INT8_MIN || reg.slot > INT8_MAX) {
+        return false;
+    }
+    out.type = static_cast<uint8_t>(reg.type);
+    out.index = static_cast<uint8_t>(reg.index);
+    out.size_bytes = static_cast<uint8_t>(reg.size / 8);
+    out.slot = static_cast<int8_t>(reg.slot);
+    return true;
+}
+
+IRRegister unpack_register(const CompactIRRegister& reg) {
+    IRRegister out{static_cast<IRRegisterType>(reg.type), reg.index, reg.size_bytes * 8u};
+    out.slot = reg.slot;
+    return out;
+}
+
+bool encode_operand(const IROperand& op, CompactIROperand& out, IRLabelTable& labels) {
+    std::memset(&out, 0, sizeof(out));
+    if (const IRRegister* reg = std::get_if<IRRegister>(&op)) {
+        out.kind = CompactIROperandKind::Register;
+        return pack_register(*reg, out.reg);
+    }
+    if (const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+        if (mem->displacement < INT32_MIN || mem->displacement > INT32_MAX ||
+            mem->scale > UINT8_MAX || mem->size % 8 != 0 || mem->size / 8 > UINT8_MAX) {
+            return false;
+        }
+        out.kind = CompactIROperandKind::Memory;
+        out.scale = static_cast<uint8_t>(mem->scale);
+        out.size_bytes = static_cast<uint8_t>(mem->size / 8);
+        out.mem.displacement = static_cast<int32_t>(mem->displacement);
+        if (mem->base_reg) {
+            out.memory_regs |= CompactIROperand::kHasBase;
+            if (!pack_register(*mem->base_reg, out.mem.base)) return false;
+        }
+        if (mem->index_reg) {
+            out.memory_regs |= CompactIROperand::kHasIndex;
+            if (!pack_register(*mem->index_reg, out.mem.index)) return false;
+        }
+        return true;
+    }
+    if (const uint64_t* imm = std::get_if<uint64_t>(&op)) {
+        out.kind = CompactIROperandKind::Immediate;
+        out.immediate[0] = static_cast<uint32_t>(*imm);
+        out.immediate[1] = static_cast<uint32_t>(*imm >> 32);
+        return true;
+    }
+    if (const std::string* label = std::get_if<std::string>(&op)) {
+        out.kind = CompactIROperandKind::Label;
+        out.label = labels.intern(*label);
+        return true;
+    }
+    out.kind = CompactIROperandKind::Condition;
+    out.condition = std::get<IRConditionCode>(op);
+    return true;
+}
+
+IROperand decode_operand(const CompactIROperand& op, const IRLabelTable& labels) {
+    switch (op.kind) {
+        case CompactIROperandKind::Register:
+            return unpack_register(op.reg);
+        case CompactIROperandKind::Memory: {
+            IRMemoryOperand mem;
+            if (op.memory_regs & CompactIROperand::kHasBase) mem.base_reg = unpack_register(op.mem.base);
+            if (op.memory_regs & CompactIROperand::kHasIndex) mem.index_reg = unpack_register(op.mem.index);
+            mem.scale = op.scale;
+            mem.displacement = op.mem.displacement;
+            mem.size = op.size_bytes * 8u;
+            return mem;
+        }
+        case CompactIROperandKind::Immediate:
+            return op.immediate_value();
+        case CompactIROperandKind::Label:
+            return labels.name(op.label);
+        case CompactIROperandKind::Condition:
+        default:
+            return op.condition;
+    }
+}
+
+} // namespace
+
+uint32_t IRLabelTable::intern(const std::string& label) {
+    auto it = ids_.find(label);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.push_back(label);
+    ids_.emplace(label, id);
+    return id;
+}
+
+bool encode_ir(const IRInstruction& ir_instr, CompactIRInstruction& out, IRLabelTable& labels) {
+    if (ir_instr.operands.size() > CompactIRInstruction::kMaxOperands ||
+        ir_instr.original_size > UINT16_MAX) {
+        return false;
+    }
+    std::memset(&out, 0, sizeof(out));
+    out.opcode = ir_instr.opcode;
+    out.operand_count = static_cast<uint8_t>(ir_instr.operands.size());
+    out.flags_live = ir_instr.flags_live;
+    out.original_size = static_cast<uint16_t>(ir_instr.original_size);
+    out.original_address = ir_instr.original_address;
+    out.handler = ir_instr.handler;
+    for (size_t i = 0; i < ir_instr.operands.size(); ++i) {
+        if (!encode_operand(ir_instr.operands[i], out.operands[i], labels)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+IRInstruction decode_ir(const CompactIRInstruction& compact, const IRLabelTable& labels) {
+    std::vector<IROperand> ops;
+    ops.reserve(compact.operand_count);
+    for (size_t i = 0; i < compact.operand_count; ++i) {
+        ops.push_back(decode_operand(compact.operands[i], labels));
+    }
+    IRInstruction ir_instr(compact.opcode, std::move(ops));
+    ir_instr.original_address = compact.original_address;
+    ir_instr.original_size = compact.original_size;
+    ir_instr.flags_live = compact.flags_live;
+    ir_instr.handler = compact.handler;
+    return ir_instr;
+}
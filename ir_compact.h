@@ -0,0 +1,109 @@
+#ifndef IR_COMPACT_H
+#define IR_COMPACT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "ir.h"
+
+// Compact, trivially-copyable encoding of IRInstruction.
+//
+// IRInstruction (ir.h) stays the form the translator builds and the executor
+// and passes work on; it owns a heap-allocated operand vector whose variant can
+// hold a std::string. The compact form packs up to four operands of 16 bytes
+// each inline and interns labels to 32-bit IDs, so an array of them can be
+// written out and read back byte for byte. The program cache (program_cache.h)
+// stores blocks this way; blocks themselves execute the IRInstruction form.
+
+// A register packed into four bytes. Sizes are stored in bytes.
+struct CompactIRRegister {
+    uint8_t type;       // IRRegisterType
+    uint8_t index;
+    uint8_t size_bytes;
+    int8_t slot;        // -1 if unresolved
+};
+
+enum class CompactIROperandKind : uint8_t {
+    None,
+    Register,
+    Memory,
+    Immediate,
+    Label,
+    Condition,
+};
+
+struct CompactIROperand {
+    CompactIROperandKind kind;
+    uint8_t scale;          // Memory only
+    uint8_t size_bytes;     // Memory only
+    uint8_t memory_regs;    // Memory only: kHasBase | kHasIndex
+
+    union {
+        CompactIRRegister reg;
+        struct {
+            CompactIRRegister base;
+            CompactIRRegister index;
+            int32_t displacement;
+        } mem;
+        uint32_t immediate[2]; // Low word first, so the union stays 4-byte aligned.
+        uint32_t label;        // ID in an IRLabelTable
+        IRConditionCode condition;
+    };
+
+    static constexpr uint8_t kHasBase = 1;
+    static constexpr uint8_t kHasIndex = 2;
+
+    uint64_t immediate_value() const { return immediate[0] | (uint64_t{immediate[1]} << 32); }
+};
+
+struct CompactIRInstruction {
+    static constexpr size_t kMaxOperands = 4;
+
+    IROpcode opcode;
+    uint8_t operand_count;
+    bool flags_live;
+    uint16_t original_size;
+    uint64_t original_address;
+    // Bound handler. Process-specific: cleared when a program is serialized
+    // and rebound with bind_ir_handler() after it is loaded.
+    IRHandler handler;
+    CompactIROperand operands[kMaxOperands];
+};
+
+static_assert(sizeof(CompactIROperand) == 16, "Compact IR operands must stay 16 bytes");
+static_assert(std::is_trivially_copyable<CompactIRInstruction>::value,
+              "Compact IR must be copyable with memcpy");
+
+/**
+ * @brief Interns label strings to dense 32-bit IDs.
+ */
+class IRLabelTable {
+public:
+    uint32_t intern(const std::string& label);
+    // Returns the label for `id`; `id` must have come from intern().
+    const std::string& name(uint32_t id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<std::string> names_;
+};
+
+/**
+ * @brief Encodes `ir_instr` into `out`, interning labels into `labels`.
+ *
+ * @return false if the instruction has no compact form: more than
+ *         kMaxOperands operands, a displacement outside 32 bits, or a
+ *         register that does not fit the packed fields.
+ */
+bool encode_ir(const IRInstruction& ir_instr, CompactIRInstruction& out, IRLabelTable& labels);
+
+/**
+ * @brief Rebuilds the IRInstruction view of a compact instruction.
+ */
+IRInstruction decode_ir(const CompactIRInstruction& compact, const IRLabelTable& labels);
+
+#endif // IR_COMPACT_H
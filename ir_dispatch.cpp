@@ -0,0 +1,252 @@
+#include "ir_dispatch.h"
+#include "ir_executor_helpers.h"
+#include "ir_scalar_handlers.h"
+#include <variant>
+
+namespace {
+
+bool is_scalar_register(const IROperand& op) {
+    const IRRegister* reg = std::get_if<IRRegister>(&op);
+    return reg && reg->type != IRRegisterType::VECTOR &&
+           (reg->size == 8 || reg->size == 16 || reg->size == 32 || reg->size == 64);
+}
+
+bool is_vector_register(const IROperand& op) {
+    const IRRegister* reg = std::get_if<IRRegister>(&op);
+    return reg && reg->type == IRRegisterType::VECTOR;
+}
+
+bool is_memory(const IROperand& op) {
+    const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op);
+    return mem && (mem->size == 8 || mem->size == 16 || mem->size == 32 || mem->size == 64);
+}
+
+bool is_immediate(const IROperand& op) {
+    return std::holds_alternative<uint64_t>(op);
+}
+
+// A value getOperandValue() can read: register, immediate or memory.
+bool is_scalar_source(const IROperand& op) {
+    return is_scalar_register(op) || is_immediate(op) || is_memory(op);
+}
+
+bool is_vector_binary(const IRInstruction& ir_instr) {
+    return ir_instr.operands.size() == 2 &&
+           is_vector_register(ir_instr.operands[0]) && is_vector_register(ir_instr.operands[1]);
+}
+
+bool has_single_immediate(const IRInstruction& ir_instr) {
+    return ir_instr.operands.size() == 1 && is_immediate(ir_instr.operands[0]);
+}
+
+uint32_t operand_size(const IROperand& op) {
+    if (const IRRegister* reg = std::get_if<IRRegister>(&op)) return reg->size;
+    if (const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) return mem->size;
+    return 0;
+}
+
+// Handler families map a width and operand kinds to one template instantiation.
+template <class Op>
+struct ScalarFamily {
+    template <unsigned Bits, class Dest, class Src>
+    static IRHandler get() { return &handle_ir_scalar<Op, Bits, Dest, Src>; }
+};
+
+struct CmpBranchFamily {
+    template <unsigned Bits, class Lhs, class Rhs>
+    static IRHandler get() { return &handle_ir_cmp_branch<Bits, Lhs, Rhs>; }
+};
+
+struct NotFamily {
+    template <unsigned Bits>
+    static IRHandler get() { return &handle_ir_not_width<Bits>; }
+};
+
+template <FlagOp Step>
+struct IncDecFamily {
+    template <unsigned Bits>
+    static IRHandler get() { return &handle_ir_inc_dec<Step, Bits>; }
+};
+
+struct ZeroFamily {
+    template <unsigned Bits>
+    static IRHandler get() { return &handle_ir_zero<Bits>; }
+};
+
+struct DecBranchFamily {
+    template <unsigned Bits>
+    static IRHandler get() { return &handle_ir_dec_branch<Bits>; }
+};
+
+// Picks the instantiation for the source operand's kind. Memory sources must
+// match the operation width.
+template <class Family, unsigned Bits, class Dest>
+IRHandler select_scalar_source(const IROperand& src) {
+    if (std::holds_alternative<IRRegister>(src)) {
+        return Family::template get<Bits, Dest, IRRegisterAccess>();
+    }
+    if (is_immediate(src)) {
+        return Family::template get<Bits, Dest, IRImmediateAccess>();
+    }
+    if (operand_size(src) == Bits) {
+        return Family::template get<Bits, Dest, IRMemoryAccess>();
+    }
+    return nullptr;
+}
+
+template <class Family, class Dest>
+IRHandler select_scalar_width(const IROperand& dest, const IROperand& src) {
+    switch (operand_size(dest)) {
+        case 8:  return select_scalar_source<Family, 8, Dest>(src);
+        case 16: return select_scalar_source<Family, 16, Dest>(src);
+        case 32: return select_scalar_source<Family, 32, Dest>(src);
+        case 64: return select_scalar_source<Family, 64, Dest>(src);
+        default: return nullptr;
+    }
+}
+
+// dest register (or memory when allowed), scalar source
+template <class Family>
+IRHandler select_binary(const IROperand& dest, const IROperand& src, bool allow_memory_dest) {
+    if (!is_scalar_source(src)) {
+        return nullptr;
+    }
+    if (is_scalar_register(dest)) {
+        return select_scalar_width<Family, IRRegisterAccess>(dest, src);
+    }
+    if (allow_memory_dest && is_memory(dest)) {
+        return select_scalar_width<Family, IRMemoryAccess>(dest, src);
+    }
+    return nullptr;
+}
+
+template <class Op>
+IRHandler select_scalar(const IRInstruction& ir_instr, bool allow_memory_dest = false) {
+    if (ir_instr.operands.size() != 2) {
+        return nullptr;
+    }
+    return select_binary<ScalarFamily<Op>>(ir_instr.operands[0], ir_instr.operands[1], allow_memory_dest);
+}
+
+// single scalar register, read and written in place
+template <class Family>
+IRHandler select_unary(const IROperand& dest) {
+    if (!is_scalar_register(dest)) {
+        return nullptr;
+    }
+    switch (operand_size(dest)) {
+        case 8:  return Family::template get<8>();
+        case 16: return Family::template get<16>();
+        case 32: return Family::template get<32>();
+        default: return Family::template get<64>();
+    }
+}
+
+// target, condition, then the fused operation's own operands
+bool is_fused_branch(const IRInstruction& ir_instr, size_t operand_count) {
+    return ir_instr.operands.size() == operand_count && is_immediate(ir_instr.operands[0]) &&
+           std::holds_alternative<IRConditionCode>(ir_instr.operands[1]);
+}
+
+IRHandler select_dec_branch(const IRInstruction& ir_instr) {
+    if (!is_fused_branch(ir_instr, 3)) {
+        return nullptr;
+    }
+    IRConditionCode condition = std::get<IRConditionCode>(ir_instr.operands[1]);
+    if (condition != IRConditionCode::Equal && condition != IRConditionCode::NotEqual) {
+        return nullptr;
+    }
+    return select_unary<DecBranchFamily>(ir_instr.operands[2]);
+}
+
+} // namespace
+
+IRHandler select_ir_handler(const IRInstruction& ir_instr) {
+    const auto& ops = ir_instr.operands;
+    switch (ir_instr.opcode) {
+        case IROpcode::Move:
+            return select_scalar<IRMoveOp>(ir_instr);
+        case IROpcode::Load:
+            return ops.size() == 2 && is_memory(ops[1]) ? select_scalar<IRMoveOp>(ir_instr) : nullptr;
+        case IROpcode::Store:
+            return ops.size() == 2 && is_memory(ops[0]) ? select_scalar<IRMoveOp>(ir_instr, true) : nullptr;
+        case IROpcode::Add:
+            return select_scalar<IRAddOp>(ir_instr);
+        case IROpcode::Sub:
+            return select_scalar<IRSubOp>(ir_instr);
+        case IROpcode::And:
+            return select_scalar<IRAndOp>(ir_instr);
+        case IROpcode::Or:
+            return select_scalar<IROrOp>(ir_instr);
+        case IROpcode::Xor:
+            return select_scalar<IRXorOp>(ir_instr);
+        case IROpcode::Cmp:
+            return select_scalar<IRCmpOp>(ir_instr, true);
+        case IROpcode::Not:
+            return ops.size() == 1 ? select_unary<NotFamily>(ops[0]) : nullptr;
+        case IROpcode::Inc:
+            return ops.size() == 1 ? select_unary<IncDecFamily<FlagOp::Inc>>(ops[0]) : nullptr;
+        case IROpcode::Dec:
+            return ops.size() == 1 ? select_unary<IncDecFamily<FlagOp::Dec>>(ops[0]) : nullptr;
+        case IROpcode::Shl:
+            return select_scalar<IRShlOp>(ir_instr);
+        case IROpcode::Shr:
+            return select_scalar<IRShrOp>(ir_instr);
+        case IROpcode::Sar:
+            return select_scalar<IRSarOp>(ir_instr);
+        case IROpcode::Div:
+            return ops.size() == 1 && (is_scalar_register(ops[0]) || is_memory(ops[0])) ? handle_ir_div : nullptr;
+        case IROpcode::Jump:
+            return has_single_immediate(ir_instr) ? handle_ir_jump : nullptr;
+        case IROpcode::Call:
+            return has_single_immediate(ir_instr) ? handle_ir_call : nullptr;
+        case IROpcode::Branch:
+            return ops.size() == 2 && is_immediate(ops[0]) &&
+                   std::holds_alternative<IRConditionCode>(ops[1]) ? handle_ir_branch : nullptr;
+        case IROpcode::CmpBranch:
+            return is_fused_branch(ir_instr, 4) ? select_binary<CmpBranchFamily>(ops[2], ops[3], true) : nullptr;
+        case IROpcode::DecBranch:
+            return select_dec_branch(ir_instr);
+        case IROpcode::Zero:
+            return ops.size() == 1 ? select_unary<ZeroFamily>(ops[0]) : nullptr;
+        case IROpcode::Ret:
+            return handle_ir_ret;
+        case IROpcode::Syscall:
+            return has_single_immediate(ir_instr) ? handle_ir_syscall : nullptr;
+        case IROpcode::PackedAnd:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_and : nullptr;
+        case IROpcode::PackedAndNot:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_and_not : nullptr;
+        case IROpcode::PackedOr:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_or : nullptr;
+        case IROpcode::PackedXor:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_xor : nullptr;
+        case IROpcode::PackedAddPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_add_ps : nullptr;
+        case IROpcode::PackedSubPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_sub_ps : nullptr;
+        case IROpcode::PackedMulPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_mul_ps : nullptr;
+        case IROpcode::PackedDivPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_div_ps : nullptr;
+        case IROpcode::PackedMaxPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_max_ps : nullptr;
+        case IROpcode::PackedMinPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_min_ps : nullptr;
+        case IROpcode::PackedSqrtPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_sqrt_ps : nullptr;
+        case IROpcode::PackedReciprocalPS:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_reciprocal_ps : nullptr;
+        case IROpcode::PackedMulLowI16:
+            return is_vector_binary(ir_instr) ? handle_ir_packed_mul_low_i16 : nullptr;
+        case IROpcode::VectorZero:
+            return ops.size() == 1 && is_vector_register(ops[0]) ? handle_ir_vector_zero : nullptr;
+        default:
+            return nullptr;
+    }
+}
+
+bool bind_ir_handler(IRInstruction& ir_instr) {
+    ir_instr.handler = select_ir_handler(ir_instr);
+    return ir_instr.handler != nullptr;
+}
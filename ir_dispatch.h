@@ -0,0 +1,23 @@
+#ifndef IR_DISPATCH_H
+#define IR_DISPATCH_H
+
+#include "ir.h"
+
+/**
+ * @brief Chooses the executor handler for an IR instruction.
+ *
+ * Operand counts and operand kinds are checked here, once, so the handlers
+ * themselves can assume a well-formed instruction.
+ *
+ * @return The handler, or nullptr if the opcode has no handler or the
+ *         operands do not match what the handler expects.
+ */
+IRHandler select_ir_handler(const IRInstruction& ir_instr);
+
+/**
+ * @brief Stores select_ir_handler()'s choice in ir_instr.handler.
+ * @return false if the instruction is malformed or unsupported.
+ */
+bool bind_ir_handler(IRInstruction& ir_instr);
+
+#endif // IR_DISPATCH_H
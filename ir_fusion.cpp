@@ -0,0 +1,71 @@
+#include "ir_fusion.h"
+#include "ir_dispatch.h"
+#include <variant>
+
+namespace {
+
+bool is_branch_on(const IRInstruction& instr, bool zero_flag_only) {
+    if (instr.opcode != IROpcode::Branch || instr.operands.size() != 2) {
+        return false;
+    }
+    const IRConditionCode* condition = std::get_if<IRConditionCode>(&instr.operands[1]);
+    if (!condition) {
+        return false;
+    }
+    return !zero_flag_only || *condition == IRConditionCode::Equal || *condition == IRConditionCode::NotEqual;
+}
+
+bool is_self_xor(const IRInstruction& instr) {
+    if (instr.opcode != IROpcode::Xor || instr.operands.size() != 2) {
+        return false;
+    }
+    const IRRegister* dest = std::get_if<IRRegister>(&instr.operands[0]);
+    const IRRegister* src = std::get_if<IRRegister>(&instr.operands[1]);
+    return dest && src && *dest == *src;
+}
+
+// Builds the superinstruction for `first` (and `second`, if it is consumed),
+// or returns false if the shape is not fusable.
+bool try_fuse(const IRInstruction& first, const IRInstruction* second, IRInstruction& fused, bool& consumed_second) {
+    consumed_second = false;
+    if (second && first.opcode == IROpcode::Cmp && first.operands.size() == 2 && is_branch_on(*second, false)) {
+        fused = IRInstruction(IROpcode::CmpBranch,
+                              {second->operands[0], second->operands[1], first.operands[0], first.operands[1]});
+        consumed_second = true;
+    } else if (second && first.opcode == IROpcode::Dec && first.operands.size() == 1 && is_branch_on(*second, true)) {
+        fused = IRInstruction(IROpcode::DecBranch, {second->operands[0], second->operands[1], first.operands[0]});
+        consumed_second = true;
+    } else if (is_self_xor(first)) {
+        fused = IRInstruction(IROpcode::Zero, {first.operands[0]});
+    } else {
+        return false;
+    }
+
+    fused.original_address = first.original_address;
+    fused.original_size = first.original_size + (consumed_second ? second->original_size : 0);
+    return bind_ir_handler(fused);
+}
+
+} // namespace
+
+size_t fuse_superinstructions(std::vector<IRInstruction>& instructions) {
+    size_t fused_count = 0;
+    std::vector<IRInstruction> result;
+    result.reserve(instructions.size());
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        const IRInstruction* next = i + 1 < instructions.size() ? &instructions[i + 1] : nullptr;
+        IRInstruction fused(IROpcode::Nop);
+        bool consumed_next = false;
+        if (try_fuse(instructions[i], next, fused, consumed_next)) {
+            result.push_back(std::move(fused));
+            ++fused_count;
+            if (consumed_next) {
+                ++i;
+            }
+        } else {
+            result.push_back(std::move(instructions[i]));
+        }
+    }
+    instructions = std::move(result);
+    return fused_count;
+}
@@ -0,0 +1,26 @@
+#ifndef IR_FUSION_H
+#define IR_FUSION_H
+
+#include <cstddef>
+#include <vector>
+#include "ir.h"
+
+/**
+ * @brief Rewrites common instruction idioms in a basic block into single
+ *        superinstructions, saving a dispatch (and, for branches, a flag
+ *        evaluation) each time the block runs.
+ *
+ * Recognised patterns:
+ *   Cmp a, b ; Branch t, cc      ->  CmpBranch t, cc, a, b
+ *   Dec r    ; Branch t, JZ/JNZ  ->  DecBranch t, cc, r
+ *   Xor r, r                     ->  Zero r
+ *
+ * The fused instruction keeps the address of the first instruction and the
+ * combined size of the pair, and has its handler bound. A pair whose fused
+ * form has no handler is left as it was. Run before analyze_flag_liveness().
+ *
+ * @return The number of rewrites performed.
+ */
+size_t fuse_superinstructions(std::vector<IRInstruction>& instructions);
+
+#endif // IR_FUSION_H
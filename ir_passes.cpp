@@ -0,0 +1,552 @@
+#include "ir_passes.h"
+#include "flag_liveness.h"
+#include "ir_dispatch.h"
+#include <optional>
+#include <variant>
+
+namespace {
+
+constexpr int kMaxSlots = 64;
+constexpr uint64_t kAllSlots = ~uint64_t{0};
+
+// How an opcode uses its operands.
+enum class Shape {
+    Barrier, // Not modelled: may read or write anything.
+    NoGpr,   // Touches no general-purpose register or memory (jumps, vector ops).
+    Assign,  // op0 written, op1 read (Move, Load).
+    Store,   // op0 memory written, op1 read.
+    Update,  // op0 read and written, op1 read (ALU ops and shifts).
+    Compare, // op0 and op1 read.
+    Unary,   // op0 read and written (Not, Inc, Dec).
+};
+
+Shape shape_of(const IRInstruction& instr) {
+    const size_t count = instr.operands.size();
+    switch (instr.opcode) {
+        case IROpcode::Move:
+        case IROpcode::Load:
+            return count == 2 ? Shape::Assign : Shape::Barrier;
+        case IROpcode::Store:
+            return count == 2 ? Shape::Store : Shape::Barrier;
+        case IROpcode::Add:
+        case IROpcode::Sub:
+        case IROpcode::And:
+        case IROpcode::Or:
+        case IROpcode::Xor:
+        case IROpcode::Shl:
+        case IROpcode::Shr:
+        case IROpcode::Sar:
+            return count == 2 ? Shape::Update : Shape::Barrier;
+        case IROpcode::Cmp:
+            return count == 2 ? Shape::Compare : Shape::Barrier;
+        case IROpcode::Not:
+        case IROpcode::Inc:
+        case IROpcode::Dec:
+            return count == 1 ? Shape::Unary : Shape::Barrier;
+        case IROpcode::Jump:
+        case IROpcode::Branch:
+        case IROpcode::Nop:
+        case IROpcode::PackedAddPS:
+        case IROpcode::PackedSubPS:
+        case IROpcode::PackedMulPS:
+        case IROpcode::PackedDivPS:
+        case IROpcode::PackedMaxPS:
+        case IROpcode::PackedMinPS:
+        case IROpcode::PackedSqrtPS:
+        case IROpcode::PackedReciprocalPS:
+        case IROpcode::PackedAnd:
+        case IROpcode::PackedAndNot:
+        case IROpcode::PackedOr:
+        case IROpcode::PackedXor:
+        case IROpcode::PackedMulLowI16:
+        case IROpcode::VectorZero:
+            return Shape::NoGpr;
+        default:
+            return Shape::Barrier;
+    }
+}
+
+bool writes_flags(IROpcode opcode) {
+    switch (opcode) {
+        case IROpcode::Add:
+        case IROpcode::Sub:
+        case IROpcode::And:
+        case IROpcode::Or:
+        case IROpcode::Xor:
+        case IROpcode::Cmp:
+        case IROpcode::Shl:
+        case IROpcode::Shr:
+        case IROpcode::Sar:
+        case IROpcode::Inc:
+        case IROpcode::Dec:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint64_t slot_bit(int slot) { return uint64_t{1} << slot; }
+
+// Register-file slot of a general-purpose register, or -1.
+int gpr_slot(const IRRegister& reg) {
+    return reg.type == IRRegisterType::GPR && reg.slot >= 0 && reg.slot < kMaxSlots ? reg.slot : -1;
+}
+
+// A 32- or 64-bit GPR with a slot. 32-bit writes zero-extend, so either width
+// replaces the whole register; 8- and 16-bit registers are never rewritten.
+const IRRegister* full_width_gpr(const IROperand& op) {
+    const IRRegister* reg = std::get_if<IRRegister>(&op);
+    return reg && gpr_slot(*reg) >= 0 && (reg->size == 32 || reg->size == 64) ? reg : nullptr;
+}
+
+const IRMemoryOperand* constant_address(const IROperand& op) {
+    const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op);
+    return mem && !mem->base_reg && !mem->index_reg ? mem : nullptr;
+}
+
+uint64_t truncate(uint64_t value, uint32_t bits) {
+    return bits >= 64 ? value : value & ((uint64_t{1} << bits) - 1);
+}
+
+struct Effects {
+    uint64_t reads = 0;    // Slots read, including merged 8/16-bit writes and address registers.
+    uint64_t writes = 0;   // Slots written.
+    int full_write = -1;   // Slot of a 32/64-bit register destination.
+    bool barrier = false;  // Unmodelled, or uses a register without a slot.
+    bool memory = false;   // Has a memory operand.
+};
+
+void add_read(Effects& fx, const IROperand& op) {
+    if (const IRRegister* reg = std::get_if<IRRegister>(&op)) {
+        if (reg->type == IRRegisterType::VECTOR) return;
+        int slot = gpr_slot(*reg);
+        if (slot < 0) {
+            fx.barrier = true;
+        } else {
+            fx.reads |= slot_bit(slot);
+        }
+    } else if (const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+        fx.memory = true;
+        if (mem->base_reg) add_read(fx, *mem->base_reg);
+        if (mem->index_reg) add_read(fx, *mem->index_reg);
+    }
+}
+
+void add_write(Effects& fx, const IROperand& op) {
+    const IRRegister* reg = std::get_if<IRRegister>(&op);
+    if (!reg || reg->type == IRRegisterType::VECTOR) return;
+    int slot = gpr_slot(*reg);
+    if (slot < 0) {
+        fx.barrier = true;
+        return;
+    }
+    fx.writes |= slot_bit(slot);
+    if (reg->size == 32 || reg->size == 64) {
+        fx.full_write = slot;
+    } else {
+        fx.reads |= slot_bit(slot); // Narrow writes merge into the old value.
+    }
+}
+
+Effects effects_of(const IRInstruction& instr) {
+    Effects fx;
+    const auto& ops = instr.operands;
+    switch (shape_of(instr)) {
+        case Shape::Barrier: fx.barrier = true; break;
+        case Shape::NoGpr: break;
+        case Shape::Assign: add_write(fx, ops[0]); add_read(fx, ops[1]); break;
+        case Shape::Store: add_read(fx, ops[0]); add_read(fx, ops[1]); break;
+        case Shape::Update: add_read(fx, ops[0]); add_write(fx, ops[0]); add_read(fx, ops[1]); break;
+        case Shape::Compare: add_read(fx, ops[0]); add_read(fx, ops[1]); break;
+        case Shape::Unary: add_read(fx, ops[0]); add_write(fx, ops[0]); break;
+    }
+    return fx;
+}
+
+// Operands whose value (not address) an instruction reads, other than a
+// read-modify-write destination.
+bool reads_value(Shape shape, size_t operand) {
+    switch (shape) {
+        case Shape::Assign:
+        case Shape::Store:
+        case Shape::Update:
+            return operand == 1;
+        case Shape::Compare:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Replaces `instr` with `replacement` if a handler can be bound for it.
+bool replace(IRInstruction& instr, IRInstruction replacement) {
+    replacement.original_address = instr.original_address;
+    replacement.original_size = instr.original_size;
+    replacement.flags_live = instr.flags_live;
+    if (!bind_ir_handler(replacement)) {
+        return false;
+    }
+    instr = std::move(replacement);
+    return true;
+}
+
+void erase_marked(std::vector<IRInstruction>& instructions, const std::vector<bool>& dead) {
+    size_t out = 0;
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        if (!dead[i]) {
+            if (out != i) instructions[out] = std::move(instructions[i]);
+            ++out;
+        }
+    }
+    instructions.erase(instructions.begin() + out, instructions.end());
+}
+
+// --- Constant folding ---
+
+using KnownValues = std::array<std::optional<uint64_t>, kMaxSlots>;
+
+std::optional<uint64_t> fold_alu(IROpcode opcode, uint32_t bits, uint64_t a, uint64_t b) {
+    switch (opcode) {
+        case IROpcode::Add: return truncate(a + b, bits);
+        case IROpcode::Sub: return truncate(a - b, bits);
+        case IROpcode::And: return truncate(a & b, bits);
+        case IROpcode::Or:  return truncate(a | b, bits);
+        case IROpcode::Xor: return truncate(a ^ b, bits);
+        default: return std::nullopt;
+    }
+}
+
+bool fold_address(IRMemoryOperand& mem, const KnownValues& known) {
+    bool changed = false;
+    if (mem.base_reg) {
+        int slot = gpr_slot(*mem.base_reg);
+        if (slot >= 0 && known[slot]) {
+            mem.displacement = static_cast<int64_t>(static_cast<uint64_t>(mem.displacement) + *known[slot]);
+            mem.base_reg.reset();
+            changed = true;
+        }
+    }
+    if (mem.index_reg) {
+        int slot = gpr_slot(*mem.index_reg);
+        if (slot >= 0 && known[slot]) {
+            mem.displacement = static_cast<int64_t>(static_cast<uint64_t>(mem.displacement) + *known[slot] * mem.scale);
+            mem.index_reg.reset();
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void fold_constants(std::vector<IRInstruction>& instructions, IRPassStats& stats) {
+    KnownValues known;
+    for (IRInstruction& instr : instructions) {
+        const Effects fx = effects_of(instr);
+        if (fx.barrier) {
+            known.fill(std::nullopt);
+            continue;
+        }
+        const Shape shape = shape_of(instr);
+        IRInstruction candidate = instr;
+        bool changed = false;
+
+        for (size_t i = 0; i < candidate.operands.size(); ++i) {
+            IROperand& op = candidate.operands[i];
+            if (IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+                changed |= fold_address(*mem, known);
+            } else if (const IRRegister* reg = full_width_gpr(op)) {
+                // A Cmp's first operand must stay a register or memory.
+                bool may_be_immediate = reads_value(shape, i) && !(shape == Shape::Compare && i == 0);
+                if (may_be_immediate && known[reg->slot]) {
+                    op = truncate(*known[reg->slot], reg->size);
+                    changed = true;
+                }
+            }
+        }
+
+        // Value of the full-width destination afterwards, if it is known.
+        std::optional<uint64_t> result;
+        const IRRegister* dest = candidate.operands.empty() ? nullptr : full_width_gpr(candidate.operands[0]);
+        if (dest && shape == Shape::Assign) {
+            if (const uint64_t* imm = std::get_if<uint64_t>(&candidate.operands[1])) {
+                result = truncate(*imm, dest->size);
+            }
+        } else if (dest && shape == Shape::Update && !instr.flags_live) {
+            const IRRegister* src = std::get_if<IRRegister>(&candidate.operands[1]);
+            const uint64_t* imm = std::get_if<uint64_t>(&candidate.operands[1]);
+            if (instr.opcode == IROpcode::Xor && src && *src == *dest) {
+                result = 0;
+            } else if (imm && known[dest->slot]) {
+                result = fold_alu(instr.opcode, dest->size, truncate(*known[dest->slot], dest->size), *imm);
+            }
+            if (result) {
+                candidate = IRInstruction(IROpcode::Move, {*dest, *result});
+                changed = true;
+            }
+        }
+
+        // Every rewrite above preserves the instruction's effect, so `result`
+        // holds whether or not the replacement can be bound.
+        if (changed && replace(instr, std::move(candidate))) {
+            ++stats.rewritten;
+        }
+        for (int slot = 0; slot < kMaxSlots; ++slot) {
+            if (fx.writes & slot_bit(slot)) known[slot].reset();
+        }
+        if (result && fx.full_write >= 0) {
+            known[fx.full_write] = result;
+        }
+    }
+}
+
+// --- Copy propagation ---
+
+void propagate_copies(std::vector<IRInstruction>& instructions, IRPassStats& stats) {
+    // copy_of[slot] is a register whose low `size` bits the slot's register
+    // equals, zero-extended.
+    std::array<std::optional<IRRegister>, kMaxSlots> copy_of;
+    for (IRInstruction& instr : instructions) {
+        const Effects fx = effects_of(instr);
+        if (fx.barrier) {
+            copy_of.fill(std::nullopt);
+            continue;
+        }
+        const Shape shape = shape_of(instr);
+        IRInstruction candidate = instr;
+        bool changed = false;
+
+        // Address registers are read at 64 bits, so only 64-bit copies apply.
+        auto substitute_address = [&](std::optional<IRRegister>& reg) {
+            int slot = reg ? gpr_slot(*reg) : -1;
+            if (slot >= 0 && copy_of[slot] && copy_of[slot]->size == 64) {
+                IRRegister source = *copy_of[slot];
+                source.size = reg->size;
+                reg = source;
+                changed = true;
+            }
+        };
+        for (size_t i = 0; i < candidate.operands.size(); ++i) {
+            IROperand& op = candidate.operands[i];
+            if (IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+                substitute_address(mem->base_reg);
+                substitute_address(mem->index_reg);
+            } else if (const IRRegister* reg = full_width_gpr(op)) {
+                const auto& copy = copy_of[reg->slot];
+                if (reads_value(shape, i) && copy && reg->size <= copy->size) {
+                    IRRegister source = *copy;
+                    source.size = reg->size;
+                    op = source;
+                    changed = true;
+                }
+            }
+        }
+        if (changed && replace(instr, std::move(candidate))) {
+            ++stats.rewritten;
+        }
+
+        for (int slot = 0; slot < kMaxSlots; ++slot) {
+            if (!(fx.writes & slot_bit(slot))) continue;
+            copy_of[slot].reset();
+            for (auto& copy : copy_of) {
+                if (copy && copy->slot == slot) copy.reset();
+            }
+        }
+        if (instr.opcode == IROpcode::Move && shape == Shape::Assign) {
+            const IRRegister* dest = full_width_gpr(instr.operands[0]);
+            const IRRegister* src = full_width_gpr(instr.operands[1]);
+            if (dest && src && dest->size == src->size && dest->slot != src->slot) {
+                copy_of[dest->slot] = *src;
+            }
+        }
+    }
+}
+
+// --- Redundant load/store elimination ---
+
+// Memory at [address, address + size / 8) holds the low bits of `reg`.
+struct MemoryValue {
+    uint64_t address;
+    uint32_t size;
+    IRRegister reg;
+};
+
+// A constant-address store nothing has read yet.
+struct PendingStore {
+    uint64_t address;
+    uint32_t size;
+    size_t index;
+};
+
+bool overlaps(uint64_t a, uint32_t a_bits, uint64_t b, uint32_t b_bits) {
+    return a < b + b_bits / 8 && b < a + a_bits / 8;
+}
+
+template <typename T>
+void erase_overlapping(std::vector<T>& entries, uint64_t address, uint32_t size) {
+    for (size_t i = entries.size(); i-- > 0;) {
+        if (overlaps(entries[i].address, entries[i].size, address, size)) {
+            entries.erase(entries.begin() + i);
+        }
+    }
+}
+
+void eliminate_loads_stores(std::vector<IRInstruction>& instructions, IRPassStats& stats) {
+    std::vector<MemoryValue> values;
+    std::vector<PendingStore> pending;
+    std::vector<bool> dead(instructions.size(), false);
+    auto find_value = [&](uint64_t address, uint32_t size) -> const MemoryValue* {
+        for (const auto& value : values) {
+            if (value.address == address && value.size == size) return &value;
+        }
+        return nullptr;
+    };
+
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        IRInstruction& instr = instructions[i];
+        const Effects fx = effects_of(instr);
+        if (fx.barrier) {
+            values.clear();
+            pending.clear();
+            continue;
+        }
+        const Shape shape = shape_of(instr);
+
+        // Any memory read keeps the stores it may observe. A computed address
+        // may also fault, which must see every earlier store.
+        for (size_t op = 0; op < instr.operands.size(); ++op) {
+            const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&instr.operands[op]);
+            if (!mem) continue;
+            if (!constant_address(instr.operands[op])) {
+                pending.clear();
+            } else if (!(shape == Shape::Store && op == 0)) {
+                erase_overlapping(pending, static_cast<uint64_t>(mem->displacement), mem->size);
+            }
+        }
+
+        // A full-width register loaded from a constant address, copied out
+        // before the instruction is rewritten.
+        std::optional<MemoryValue> loaded;
+        const IRRegister* dest = instr.operands.empty() ? nullptr : full_width_gpr(instr.operands[0]);
+        const IRMemoryOperand* load = shape == Shape::Assign ? constant_address(instr.operands[1]) : nullptr;
+        if (dest && load && load->size == dest->size) {
+            loaded = MemoryValue{static_cast<uint64_t>(load->displacement), load->size, *dest};
+            if (const MemoryValue* value = find_value(loaded->address, loaded->size)) {
+                IRRegister source = value->reg;
+                source.size = loaded->reg.size;
+                if (replace(instr, IRInstruction(IROpcode::Move, {loaded->reg, source}))) {
+                    ++stats.rewritten;
+                }
+            }
+        }
+
+        if (shape == Shape::Store) {
+            const IRMemoryOperand* store = constant_address(instr.operands[0]);
+            if (!store) {
+                values.clear(); // May alias anything.
+            } else {
+                const uint64_t address = static_cast<uint64_t>(store->displacement);
+                const IRRegister* src = full_width_gpr(instr.operands[1]);
+                if (src && src->size != store->size) src = nullptr;
+                const MemoryValue* current = find_value(address, store->size);
+                if (src && current && current->reg.slot == src->slot) {
+                    dead[i] = true; // Memory already holds this value.
+                    ++stats.removed;
+                    continue;
+                }
+                for (size_t p = pending.size(); p-- > 0;) {
+                    if (pending[p].address == address && pending[p].size == store->size) {
+                        dead[pending[p].index] = true; // Overwritten before being read.
+                        ++stats.removed;
+                        pending.erase(pending.begin() + p);
+                    }
+                }
+                erase_overlapping(values, address, store->size);
+                pending.push_back({address, store->size, i});
+                if (src) values.push_back({address, store->size, *src});
+            }
+        }
+
+        for (size_t v = values.size(); v-- > 0;) {
+            if (fx.writes & slot_bit(values[v].reg.slot)) values.erase(values.begin() + v);
+        }
+        if (loaded) {
+            erase_overlapping(values, loaded->address, loaded->size);
+            values.push_back(*loaded);
+        }
+    }
+    erase_marked(instructions, dead);
+}
+
+// --- Dead register-write elimination ---
+
+void eliminate_dead_writes(std::vector<IRInstruction>& instructions, IRPassStats& stats) {
+    uint64_t live = kAllSlots; // Every register is live at the block exit.
+    std::vector<bool> dead(instructions.size(), false);
+    for (size_t i = instructions.size(); i-- > 0;) {
+        const IRInstruction& instr = instructions[i];
+        const Effects fx = effects_of(instr);
+        if (fx.barrier) {
+            live = kAllSlots;
+            continue;
+        }
+        const Shape shape = shape_of(instr);
+        const bool register_only = shape == Shape::Assign || shape == Shape::Update || shape == Shape::Unary;
+        if (register_only && fx.full_write >= 0 && fx.writes == slot_bit(fx.full_write) && !fx.memory &&
+            !(writes_flags(instr.opcode) && instr.flags_live) && !(live & slot_bit(fx.full_write))) {
+            dead[i] = true;
+            ++stats.removed;
+            continue;
+        }
+        if (fx.full_write >= 0) {
+            live &= ~slot_bit(fx.full_write);
+        }
+        live |= fx.reads;
+        if (fx.memory) {
+            live = kAllSlots; // A faulting access exposes every register.
+        }
+    }
+    erase_marked(instructions, dead);
+}
+
+using PassFn = void (*)(std::vector<IRInstruction>&, IRPassStats&);
+
+constexpr PassFn kPasses[kNumIRPasses] = {
+    fold_constants,
+    propagate_copies,
+    eliminate_loads_stores,
+    eliminate_dead_writes,
+};
+
+} // namespace
+
+IRPassManager::IRPassManager() {
+    enabled_.fill(true);
+}
+
+void IRPassManager::run(std::vector<IRInstruction>& instructions) {
+    analyze_flag_liveness(instructions);
+    for (size_t i = 0; i < kNumIRPasses; ++i) {
+        if (!enabled_[i]) continue;
+        ++stats_[i].blocks;
+        kPasses[i](instructions, stats_[i]);
+        // Rewrites can turn a flag writer into a Move, exposing earlier writes.
+        analyze_flag_liveness(instructions);
+    }
+}
+
+void IRPassManager::add_stats(const IRPassManager& other) {
+    for (size_t i = 0; i < kNumIRPasses; ++i) {
+        stats_[i].blocks += other.stats_[i].blocks;
+        stats_[i].rewritten += other.stats_[i].rewritten;
+        stats_[i].removed += other.stats_[i].removed;
+    }
+}
+
+const char* IRPassManager::name(IRPass pass) {
+    switch (pass) {
+        case IRPass::ConstantFolding: return "constant-folding";
+        case IRPass::CopyPropagation: return "copy-propagation";
+        case IRPass::LoadStoreElimination: return "load-store-elimination";
+        case IRPass::DeadWriteElimination: return "dead-write-elimination";
+    }
+    return "unknown";
+}
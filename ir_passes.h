@@ -0,0 +1,76 @@
+#ifndef IR_PASSES_H
+#define IR_PASSES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ir.h"
+
+/**
+ * @brief Block-local IR optimizations, in the order IRPassManager runs them.
+ *
+ * All passes reason only about general-purpose registers with a resolved
+ * register-file slot. Anything they do not model (Div, Call, Syscall, ...)
+ * is a barrier that forgets everything known so far. Registers, memory and
+ * live flags are left exactly as the unoptimized block would leave them at
+ * its exit.
+ */
+enum class IRPass {
+    // Tracks registers holding known constants. Known register sources and
+    // address registers become immediates, and Move/Add/Sub/And/Or/Xor whose
+    // flags are dead are folded into a Move of the result.
+    ConstantFolding,
+    // Replaces reads of a register copied by `Move dst, src` with `src` while
+    // both are unchanged.
+    CopyPropagation,
+    // For memory operands with a constant address: forwards stored or loaded
+    // registers to later loads, drops stores of a value already in memory,
+    // and drops stores overwritten before anything could read them.
+    LoadStoreElimination,
+    // Removes register-only instructions whose result is overwritten before
+    // it is read and whose flags are dead.
+    DeadWriteElimination,
+};
+
+constexpr size_t kNumIRPasses = 4;
+
+struct IRPassStats {
+    uint64_t blocks = 0;     // Blocks the pass ran on.
+    uint64_t rewritten = 0;  // Instructions replaced with a cheaper form.
+    uint64_t removed = 0;    // Instructions deleted.
+};
+
+/**
+ * @brief Runs the enabled IRPass optimizations over a block's instructions.
+ *
+ * Every pass is enabled by default. run() expects translated instructions
+ * with bound handlers, refreshes flag liveness first, and rebinds the
+ * handler of every instruction it rewrites. Terminators are never removed.
+ */
+class IRPassManager {
+public:
+    IRPassManager();
+
+    void set_enabled(IRPass pass, bool enabled) { enabled_[index(pass)] = enabled; }
+    bool is_enabled(IRPass pass) const { return enabled_[index(pass)]; }
+    void set_all_enabled(bool enabled) { enabled_.fill(enabled); }
+
+    void run(std::vector<IRInstruction>& instructions);
+
+    const IRPassStats& get_stats(IRPass pass) const { return stats_[index(pass)]; }
+    void reset_stats() { stats_.fill(IRPassStats{}); }
+    // Adds the counters of `other`, e.g. a copy that optimized blocks on
+    // another thread.
+    void add_stats(const IRPassManager& other);
+
+    static const char* name(IRPass pass);
+
+private:
+    static size_t index(IRPass pass) { return static_cast<size_t>(pass); }
+
+    std::array<bool, kNumIRPasses> enabled_;
+    std::array<IRPassStats, kNumIRPasses> stats_{};
+};
+
+#endif // IR_PASSES_H
@@ -0,0 +1,331 @@
+#ifndef IR_SCALAR_HANDLERS_H
+#define IR_SCALAR_HANDLERS_H
+
+// Width- and operand-kind-specialised handlers for scalar IR operations.
+//
+// Each handler is instantiated per (operation, width, destination kind, source
+// kind) and chosen by select_ir_handler() at translation time, so the code that
+// runs has no size switch and no variant inspection. Operands are assumed to
+// have been validated by the selector.
+
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include "ir.h"
+#include "ir_executor_helpers.h"
+#include "x86_simulator.h"
+
+template <unsigned Bits> struct IROperandWidth;
+template <> struct IROperandWidth<8>  { using type = uint8_t; };
+template <> struct IROperandWidth<16> { using type = uint16_t; };
+template <> struct IROperandWidth<32> { using type = uint32_t; };
+template <> struct IROperandWidth<64> { using type = uint64_t; };
+
+template <unsigned Bits>
+using IRWord = typename IROperandWidth<Bits>::type;
+
+// --- Operand access policies ---
+
+struct IRRegisterAccess {
+    template <unsigned Bits>
+    static IRWord<Bits> read(const IROperand& op, X86Simulator& simulator) {
+        const IRRegister& reg = *std::get_if<IRRegister>(&op);
+        if (reg.slot >= 0) {
+            return static_cast<IRWord<Bits>>(simulator.getRegisterMap().get64(static_cast<Reg64>(reg.slot)));
+        }
+        return static_cast<IRWord<Bits>>(getOperandValue(op, simulator));
+    }
+
+    template <unsigned Bits>
+    static void write(const IROperand& op, IRWord<Bits> value, X86Simulator& simulator) {
+        const IRRegister& reg = *std::get_if<IRRegister>(&op);
+        if (reg.slot < 0) {
+            setRegisterValue(reg, value, simulator);
+            return;
+        }
+        auto& regs = simulator.getRegisterMap();
+        const Reg64 slot = static_cast<Reg64>(reg.slot);
+        if constexpr (Bits == 8) {
+            regs.set8(slot, value);
+        } else if constexpr (Bits == 16) {
+            regs.set16(slot, value);
+        } else {
+            regs.set64(slot, value); // 32-bit writes zero-extend
+        }
+    }
+};
+
+struct IRImmediateAccess {
+    template <unsigned Bits>
+    static IRWord<Bits> read(const IROperand& op, X86Simulator&) {
+        return static_cast<IRWord<Bits>>(*std::get_if<uint64_t>(&op));
+    }
+};
+
+struct IRMemoryAccess {
+    template <unsigned Bits>
+    static IRWord<Bits> read(const IROperand& op, X86Simulator& simulator) {
+        address_t addr = getEffectiveAddress(*std::get_if<IRMemoryOperand>(&op), simulator);
+        auto& mem = simulator.getMemory();
+        if constexpr (Bits == 8) {
+            return mem.read_byte(addr);
+        } else if constexpr (Bits == 16) {
+            return mem.read_word(addr);
+        } else if constexpr (Bits == 32) {
+            return mem.read_dword(addr);
+        } else {
+            return mem.read_qword(addr);
+        }
+    }
+
+    template <unsigned Bits>
+    static void write(const IROperand& op, IRWord<Bits> value, X86Simulator& simulator) {
+        address_t addr = getEffectiveAddress(*std::get_if<IRMemoryOperand>(&op), simulator);
+        auto& mem = simulator.getMemory();
+        if constexpr (Bits == 8) {
+            mem.write_byte(addr, value);
+        } else if constexpr (Bits == 16) {
+            mem.write_word(addr, value);
+        } else if constexpr (Bits == 32) {
+            mem.write_dword(addr, value);
+        } else {
+            mem.write_qword(addr, value);
+        }
+    }
+};
+
+// --- Operations ---
+//
+// kReadsDest:  the destination's old value is an input.
+// kWritesDest: the result is stored back to the destination.
+// update_flags() runs only when the flag-liveness pass left flags_live set.
+
+struct IRMoveOp {
+    static constexpr bool kReadsDest = false;
+    static constexpr bool kWritesDest = true;
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits>, IRWord<Bits> src) { return src; }
+    template <unsigned Bits> static void update_flags(X86Simulator&, IRWord<Bits>, IRWord<Bits>, IRWord<Bits>) {}
+};
+
+template <FlagOp Flags, bool WritesDest>
+struct IRFlagRecordingOp {
+    static constexpr bool kReadsDest = true;
+    static constexpr bool kWritesDest = WritesDest;
+    template <unsigned Bits>
+    static void update_flags(X86Simulator& simulator, IRWord<Bits> dest, IRWord<Bits> src, IRWord<Bits> result) {
+        simulator.record_flags(Flags, Bits, dest, src, result);
+    }
+};
+
+struct IRAddOp : IRFlagRecordingOp<FlagOp::Add, true> {
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> b) { return a + b; }
+};
+struct IRSubOp : IRFlagRecordingOp<FlagOp::Sub, true> {
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> b) { return a - b; }
+};
+struct IRCmpOp : IRFlagRecordingOp<FlagOp::Sub, false> {
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> b) { return a - b; }
+};
+struct IRAndOp : IRFlagRecordingOp<FlagOp::Logic, true> {
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> b) { return a & b; }
+};
+struct IROrOp : IRFlagRecordingOp<FlagOp::Logic, true> {
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> b) { return a | b; }
+};
+struct IRXorOp : IRFlagRecordingOp<FlagOp::Logic, true> {
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> b) { return a ^ b; }
+};
+
+// Shift counts are masked to 5 bits (6 for 64-bit operands). A masked count of
+// zero leaves the flags untouched; OF is only defined for 1-bit shifts and AF
+// is left as it was.
+template <unsigned Bits>
+constexpr unsigned shift_count(uint64_t count) {
+    return static_cast<unsigned>(count) & (Bits == 64 ? 0x3F : 0x1F);
+}
+
+template <unsigned Bits>
+constexpr bool sign_of(IRWord<Bits> value) {
+    return (value >> (Bits - 1)) & 1;
+}
+
+template <unsigned Bits>
+void set_shift_result_flags(X86Simulator& simulator, IRWord<Bits> result, bool carry) {
+    simulator.set_CF(carry);
+    simulator.set_ZF(result == 0);
+    simulator.set_SF(sign_of<Bits>(result));
+    uint8_t low = static_cast<uint8_t>(result);
+    low ^= low >> 4;
+    low ^= low >> 2;
+    low ^= low >> 1;
+    simulator.set_PF((low & 1) == 0);
+}
+
+struct IRShlOp {
+    static constexpr bool kReadsDest = true;
+    static constexpr bool kWritesDest = true;
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> count) {
+        const unsigned n = shift_count<Bits>(count);
+        return n >= Bits ? 0 : static_cast<IRWord<Bits>>(a << n);
+    }
+    template <unsigned Bits>
+    static void update_flags(X86Simulator& simulator, IRWord<Bits> dest, IRWord<Bits> count, IRWord<Bits> result) {
+        const unsigned n = shift_count<Bits>(count);
+        if (n == 0) return;
+        bool carry = n <= Bits && ((static_cast<uint64_t>(dest) >> (Bits - n)) & 1);
+        set_shift_result_flags<Bits>(simulator, result, carry);
+        if (n == 1) simulator.set_OF(sign_of<Bits>(result) != carry);
+    }
+};
+
+struct IRShrOp {
+    static constexpr bool kReadsDest = true;
+    static constexpr bool kWritesDest = true;
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> count) {
+        const unsigned n = shift_count<Bits>(count);
+        return n >= Bits ? 0 : static_cast<IRWord<Bits>>(a >> n);
+    }
+    template <unsigned Bits>
+    static void update_flags(X86Simulator& simulator, IRWord<Bits> dest, IRWord<Bits> count, IRWord<Bits> result) {
+        const unsigned n = shift_count<Bits>(count);
+        if (n == 0) return;
+        bool carry = n <= Bits && ((static_cast<uint64_t>(dest) >> (n - 1)) & 1);
+        set_shift_result_flags<Bits>(simulator, result, carry);
+        if (n == 1) simulator.set_OF(sign_of<Bits>(dest));
+    }
+};
+
+struct IRSarOp {
+    static constexpr bool kReadsDest = true;
+    static constexpr bool kWritesDest = true;
+    template <unsigned Bits> static IRWord<Bits> apply(IRWord<Bits> a, IRWord<Bits> count) {
+        using Signed = std::make_signed_t<IRWord<Bits>>;
+        const unsigned n = shift_count<Bits>(count);
+        return static_cast<IRWord<Bits>>(static_cast<Signed>(a) >> (n >= Bits ? Bits - 1 : n));
+    }
+    template <unsigned Bits>
+    static void update_flags(X86Simulator& simulator, IRWord<Bits> dest, IRWord<Bits> count, IRWord<Bits> result) {
+        const unsigned n = shift_count<Bits>(count);
+        if (n == 0) return;
+        bool carry = n >= Bits ? sign_of<Bits>(dest) : ((static_cast<uint64_t>(dest) >> (n - 1)) & 1);
+        set_shift_result_flags<Bits>(simulator, result, carry);
+        if (n == 1) simulator.set_OF(false);
+    }
+};
+
+// --- Handlers ---
+
+/**
+ * @brief Executes `dest = Op(dest, src)` at a fixed width and operand shape.
+ */
+template <class Op, unsigned Bits, class Dest, class Src>
+void handle_ir_scalar(const IRInstruction& ir_instr, X86Simulator& simulator) {
+    const IROperand& dest_op = ir_instr.operands[0];
+    IRWord<Bits> dest = 0;
+    if constexpr (Op::kReadsDest) {
+        dest = Dest::template read<Bits>(dest_op, simulator);
+    }
+    IRWord<Bits> src = Src::template read<Bits>(ir_instr.operands[1], simulator);
+    IRWord<Bits> result = Op::template apply<Bits>(dest, src);
+    if constexpr (Op::kWritesDest) {
+        Dest::template write<Bits>(dest_op, result, simulator);
+    }
+    if (ir_instr.flags_live) {
+        Op::template update_flags<Bits>(simulator, dest, src, result);
+    }
+}
+
+/**
+ * @brief Executes a bitwise 'Not' at a fixed width. Flags are not affected.
+ */
+template <unsigned Bits>
+void handle_ir_not_width(const IRInstruction& ir_instr, X86Simulator& simulator) {
+    const IROperand& op = ir_instr.operands[0];
+    IRRegisterAccess::write<Bits>(op, static_cast<IRWord<Bits>>(~IRRegisterAccess::read<Bits>(op, simulator)), simulator);
+}
+
+/**
+ * @brief Executes 'Inc' (Step == FlagOp::Inc) or 'Dec' at a fixed width. CF is preserved.
+ */
+template <FlagOp Step, unsigned Bits>
+void handle_ir_inc_dec(const IRInstruction& ir_instr, X86Simulator& simulator) {
+    const IROperand& op = ir_instr.operands[0];
+    const IRWord<Bits> value = IRRegisterAccess::read<Bits>(op, simulator);
+    const IRWord<Bits> result = Step == FlagOp::Inc ? value + 1 : value - 1;
+    IRRegisterAccess::write<Bits>(op, result, simulator);
+    if (ir_instr.flags_live) {
+        simulator.record_flags_preserving_carry(Step, Bits, value, result);
+    }
+}
+
+/**
+ * @brief Executes the 'Zero' idiom (`xor reg, reg`) at a fixed width.
+ */
+template <unsigned Bits>
+void handle_ir_zero(const IRInstruction& ir_instr, X86Simulator& simulator) {
+    IRRegisterAccess::write<Bits>(ir_instr.operands[0], 0, simulator);
+    if (ir_instr.flags_live) {
+        simulator.record_flags(FlagOp::Logic, Bits, 0, 0, 0);
+    }
+}
+
+// Evaluates a branch condition on `lhs - rhs` straight from the operands,
+// without going through the recorded flags.
+template <unsigned Bits>
+bool compare_condition_holds(IRConditionCode condition, IRWord<Bits> lhs, IRWord<Bits> rhs) {
+    using Signed = std::make_signed_t<IRWord<Bits>>;
+    const IRWord<Bits> result = lhs - rhs;
+    const bool overflow = sign_of<Bits>(static_cast<IRWord<Bits>>((lhs ^ rhs) & (lhs ^ result)));
+    switch (condition) {
+        case IRConditionCode::Equal:          return lhs == rhs;
+        case IRConditionCode::NotEqual:       return lhs != rhs;
+        case IRConditionCode::Below:          return lhs < rhs;
+        case IRConditionCode::AboveOrEqual:   return lhs >= rhs;
+        case IRConditionCode::Less:           return static_cast<Signed>(lhs) < static_cast<Signed>(rhs);
+        case IRConditionCode::GreaterOrEqual: return static_cast<Signed>(lhs) >= static_cast<Signed>(rhs);
+        case IRConditionCode::LessOrEqual:    return static_cast<Signed>(lhs) <= static_cast<Signed>(rhs);
+        case IRConditionCode::Greater:        return static_cast<Signed>(lhs) > static_cast<Signed>(rhs);
+        case IRConditionCode::Overflow:       return overflow;
+        case IRConditionCode::NotOverflow:    return !overflow;
+        case IRConditionCode::Sign:           return sign_of<Bits>(result);
+        case IRConditionCode::NotSign:        return !sign_of<Bits>(result);
+    }
+    return false;
+}
+
+/**
+ * @brief Executes a fused 'Cmp' + 'Branch': records the compare's flags and
+ *        jumps to the target if the condition holds for the two operands.
+ */
+template <unsigned Bits, class Lhs, class Rhs>
+void handle_ir_cmp_branch(const IRInstruction& ir_instr, X86Simulator& simulator) {
+    const IRWord<Bits> lhs = Lhs::template read<Bits>(ir_instr.operands[2], simulator);
+    const IRWord<Bits> rhs = Rhs::template read<Bits>(ir_instr.operands[3], simulator);
+    if (ir_instr.flags_live) {
+        simulator.record_flags(FlagOp::Sub, Bits, lhs, rhs, static_cast<IRWord<Bits>>(lhs - rhs));
+    }
+    const auto condition = *std::get_if<IRConditionCode>(&ir_instr.operands[1]);
+    if (compare_condition_holds<Bits>(condition, lhs, rhs)) {
+        simulator.getRegisterMap().set64(RIP, *std::get_if<uint64_t>(&ir_instr.operands[0]));
+    }
+}
+
+/**
+ * @brief Executes a fused 'Dec' + JZ/JNZ on the decremented register.
+ */
+template <unsigned Bits>
+void handle_ir_dec_branch(const IRInstruction& ir_instr, X86Simulator& simulator) {
+    const IROperand& op = ir_instr.operands[2];
+    const IRWord<Bits> value = IRRegisterAccess::read<Bits>(op, simulator);
+    const IRWord<Bits> result = value - 1;
+    IRRegisterAccess::write<Bits>(op, result, simulator);
+    if (ir_instr.flags_live) {
+        simulator.record_flags_preserving_carry(FlagOp::Dec, Bits, value, result);
+    }
+    const bool jump_if_zero = *std::get_if<IRConditionCode>(&ir_instr.operands[1]) == IRConditionCode::Equal;
+    if ((result == 0) == jump_if_zero) {
+        simulator.getRegisterMap().set64(RIP, *std::get_if<uint64_t>(&ir_instr.operands[0]));
+    }
+}
+
+#endif // IR_SCALAR_HANDLERS_H
@@ -0,0 +1,286 @@
+#include "jit_compiler.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <variant>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#include <sys/mman.h>
+#include <unistd.h>
+#define X86SIM_HAVE_JIT 1
+#else
+#define X86SIM_HAVE_JIT 0
+#endif
+
+namespace {
+
+// RFLAGS bits each IR opcode writes in the interpreter.
+constexpr uint32_t kArithmeticFlagsMask = (1u << 0) | (1u << 2) | (1u << 4) |
+                                          (1u << 6) | (1u << 7) | (1u << 11);   // CF, PF, AF, ZF, SF, OF
+// AF is undefined after a host logic op; the interpreter clears it, so it is
+// written but not taken from the host flags.
+constexpr uint32_t kLogicHostFlagsMask = kArithmeticFlagsMask & ~(1u << 4);
+// INC and DEC leave CF alone on both the guest and the host.
+constexpr uint32_t kIncDecFlagsMask = kArithmeticFlagsMask & ~(1u << 0);
+constexpr uint32_t kZeroFlagMask = 1u << 6;
+
+constexpr int32_t gpr_offset(uint32_t index) {
+    return static_cast<int32_t>(offsetof(JitState, gpr) + index * sizeof(uint64_t));
+}
+constexpr int32_t kRflagsOffset = static_cast<int32_t>(offsetof(JitState, rflags));
+constexpr int32_t kMemoryBaseOffset = static_cast<int32_t>(offsetof(JitState, memory_base));
+
+// Host register numbers used by the emitter. rdi holds the JitState pointer.
+enum HostReg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RSI = 6, RDI = 7 };
+
+class Emitter {
+public:
+    std::vector<uint8_t> code;
+
+    void byte(uint8_t b) { code.push_back(b); }
+    void imm32(uint32_t v) { for (int i = 0; i < 4; ++i) byte(static_cast<uint8_t>(v >> (8 * i))); }
+    void imm64(uint64_t v) { for (int i = 0; i < 8; ++i) byte(static_cast<uint8_t>(v >> (8 * i))); }
+
+    // mov reg64, [rdi + disp32]
+    void load_state(HostReg reg, int32_t disp) { byte(0x48); byte(0x8B); byte(0x87 | (reg << 3)); imm32(disp); }
+    // mov [rdi + disp32], reg64
+    void store_state(HostReg reg, int32_t disp) { byte(0x48); byte(0x89); byte(0x87 | (reg << 3)); imm32(disp); }
+    // movabs reg64, imm64
+    void mov_imm64(HostReg reg, uint64_t value) { byte(0x48); byte(0xB8 | reg); imm64(value); }
+    // mov ecx/rcx, [rdx + disp32]
+    void load_rcx_from_rdx(int32_t disp, bool wide) { if (wide) byte(0x48); byte(0x8B); byte(0x8A); imm32(disp); }
+    // mov ecx, ecx (zero-extends)
+    void truncate_rcx() { byte(0x89); byte(0xC9); }
+    // <op> eax/rax, ecx/rcx
+    void alu_rax_rcx(uint8_t opcode, bool wide) { if (wide) byte(0x48); byte(opcode); byte(0xC8); }
+    // inc/dec eax/rax
+    void inc_dec_rax(bool increment, bool wide) { if (wide) byte(0x48); byte(0xFF); byte(increment ? 0xC0 : 0xC8); }
+
+    // Replaces the guest RFLAGS bits in `written_mask` with the host flags in `host_mask`.
+    void merge_flags(uint32_t written_mask, uint32_t host_mask) {
+        byte(0x9C);                                   // pushfq
+        byte(0x5A);                                   // pop rdx
+        byte(0x48); byte(0x81); byte(0xE2); imm32(host_mask);      // and rdx, host_mask
+        load_state(RSI, kRflagsOffset);
+        byte(0x48); byte(0x81); byte(0xE6); imm32(~written_mask);  // and rsi, ~written_mask
+        byte(0x48); byte(0x09); byte(0xD6);           // or rsi, rdx
+        store_state(RSI, kRflagsOffset);
+    }
+
+    void ret() { byte(0xC3); }
+};
+
+bool is_jit_gpr(const IRRegister& reg) {
+    return reg.type == IRRegisterType::GPR && reg.index < 8 && (reg.size == 32 || reg.size == 64);
+}
+
+// Loads a source operand into rcx (zero-extended to the operation width).
+bool emit_source(Emitter& e, const IROperand& src, bool wide, size_t memory_size) {
+    if (const IRRegister* reg = std::get_if<IRRegister>(&src)) {
+        if (!is_jit_gpr(*reg)) return false;
+        e.load_state(RCX, gpr_offset(reg->index));
+        if (!wide || reg->size == 32) e.truncate_rcx();
+        return true;
+    }
+    if (const uint64_t* imm = std::get_if<uint64_t>(&src)) {
+        e.mov_imm64(RCX, wide ? *imm : static_cast<uint32_t>(*imm));
+        return true;
+    }
+    if (const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&src)) {
+        // Only absolute addresses are resolved at compile time; the interpreter
+        // would throw for an out-of-range access, so those stay interpreted.
+        uint32_t bytes = mem->size / 8;
+        if (mem->base_reg || mem->index_reg || (mem->size != 32 && mem->size != 64)) return false;
+        if (mem->displacement < 0 || mem->displacement > INT32_MAX ||
+            static_cast<uint64_t>(mem->displacement) + bytes > memory_size) return false;
+        e.load_state(RDX, kMemoryBaseOffset);
+        e.load_rcx_from_rdx(static_cast<int32_t>(mem->displacement), mem->size == 64);
+        if (!wide && mem->size == 64) e.truncate_rcx();
+        return true;
+    }
+    return false;
+}
+
+bool emit_inc_dec(Emitter& e, const IRInstruction& instr) {
+    if (instr.operands.size() != 1) return false;
+    const IRRegister* dest = std::get_if<IRRegister>(&instr.operands[0]);
+    if (!dest || !is_jit_gpr(*dest)) return false;
+
+    e.load_state(RAX, gpr_offset(dest->index));
+    e.inc_dec_rax(instr.opcode == IROpcode::Inc, dest->size == 64);
+    e.store_state(RAX, gpr_offset(dest->index));
+    if (instr.flags_live) {
+        e.merge_flags(kIncDecFlagsMask, kIncDecFlagsMask);
+    }
+    return true;
+}
+
+bool emit_instruction(Emitter& e, const IRInstruction& instr, size_t memory_size) {
+    if (instr.opcode == IROpcode::Inc || instr.opcode == IROpcode::Dec) {
+        return emit_inc_dec(e, instr);
+    }
+    if (instr.opcode == IROpcode::Zero && instr.operands.size() == 1) {
+        IRInstruction self_xor(IROpcode::Xor, {instr.operands[0], instr.operands[0]});
+        self_xor.flags_live = instr.flags_live;
+        return emit_instruction(e, self_xor, memory_size);
+    }
+    if (instr.operands.size() != 2) return false;
+    const IRRegister* dest = std::get_if<IRRegister>(&instr.operands[0]);
+    if (!dest || !is_jit_gpr(*dest)) return false;
+    const bool wide = dest->size == 64;
+
+    uint8_t alu_opcode = 0;
+    uint32_t host_flags_mask = kArithmeticFlagsMask;
+    bool writes_dest = true;
+    switch (instr.opcode) {
+        case IROpcode::Move: break;
+        case IROpcode::Add: alu_opcode = 0x01; break;
+        case IROpcode::Sub: alu_opcode = 0x29; break;
+        case IROpcode::Cmp: alu_opcode = 0x39; writes_dest = false; break;
+        case IROpcode::Xor: alu_opcode = 0x31; host_flags_mask = kLogicHostFlagsMask; break;
+        default: return false;
+    }
+
+    if (instr.opcode == IROpcode::Cmp && !instr.flags_live) return true; // Nothing to emit
+
+    if (!emit_source(e, instr.operands[1], wide, memory_size)) return false;
+
+    if (instr.opcode == IROpcode::Move) {
+        e.store_state(RCX, gpr_offset(dest->index));
+        return true;
+    }
+
+    e.load_state(RAX, gpr_offset(dest->index));
+    e.alu_rax_rcx(alu_opcode, wide);
+    if (writes_dest) {
+        e.store_state(RAX, gpr_offset(dest->index)); // 32-bit ops zero-extended rax
+    }
+    if (instr.flags_live) {
+        e.merge_flags(kArithmeticFlagsMask, host_flags_mask);
+    }
+    return true;
+}
+
+bool emit_exit(Emitter& e, const IRInstruction& instr, uint64_t end_address, size_t memory_size) {
+    if (instr.operands.empty() || !std::holds_alternative<uint64_t>(instr.operands[0])) return false;
+    uint64_t target = std::get<uint64_t>(instr.operands[0]);
+
+    // A fused exit is compiled as the Cmp or Dec it absorbed, then the branch.
+    if (instr.opcode == IROpcode::CmpBranch || instr.opcode == IROpcode::DecBranch) {
+        if (instr.operands.size() < 3) return false;
+        IRInstruction body(instr.opcode == IROpcode::CmpBranch ? IROpcode::Cmp : IROpcode::Dec,
+                           std::vector<IROperand>(instr.operands.begin() + 2, instr.operands.end()));
+        body.flags_live = true; // The branch reads them.
+        if (!emit_instruction(e, body, memory_size)) return false;
+    }
+
+    if (instr.opcode == IROpcode::Jump) {
+        e.mov_imm64(RAX, target);
+        e.ret();
+        return true;
+    }
+
+    // Branch: only the conditions the interpreter evaluates are compiled.
+    if (instr.operands.size() < 2 || !std::holds_alternative<IRConditionCode>(instr.operands[1])) return false;
+    IRConditionCode condition = std::get<IRConditionCode>(instr.operands[1]);
+    if (condition != IRConditionCode::Equal && condition != IRConditionCode::NotEqual) return false;
+
+    e.load_state(RDX, kRflagsOffset);
+    e.byte(0xF7); e.byte(0xC2); e.imm32(kZeroFlagMask);   // test edx, ZF
+    e.mov_imm64(RAX, end_address);
+    e.mov_imm64(RCX, target);
+    // cmovne (ZF set) for Equal, cmove (ZF clear) for NotEqual
+    e.byte(0x48); e.byte(0x0F); e.byte(condition == IRConditionCode::Equal ? 0x45 : 0x44); e.byte(0xC1);
+    e.ret();
+    return true;
+}
+
+} // namespace
+
+JitCompiler::JitCompiler(size_t code_cache_size) {
+#if X86SIM_HAVE_JIT
+    void* region = mmap(nullptr, code_cache_size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region != MAP_FAILED) {
+        code_cache_ = static_cast<uint8_t*>(region);
+        capacity_ = code_cache_size;
+    }
+#else
+    (void)code_cache_size;
+#endif
+}
+
+JitCompiler::~JitCompiler() {
+#if X86SIM_HAVE_JIT
+    if (code_cache_) {
+        munmap(code_cache_, capacity_);
+    }
+#endif
+}
+
+bool JitCompiler::is_supported() {
+    return X86SIM_HAVE_JIT != 0;
+}
+
+JitBlockFn JitCompiler::compile(const std::vector<IRInstruction>& instructions, uint64_t end_address, size_t memory_size) {
+    if (!code_cache_ || instructions.empty()) {
+        return nullptr;
+    }
+
+    Emitter e;
+    size_t body_size = instructions.size();
+    const IRInstruction& last = instructions.back();
+    bool has_exit = last.opcode == IROpcode::Jump || last.opcode == IROpcode::Branch ||
+                    last.opcode == IROpcode::CmpBranch || last.opcode == IROpcode::DecBranch;
+    if (has_exit) {
+        --body_size;
+    }
+    for (size_t i = 0; i < body_size; ++i) {
+        if (!emit_instruction(e, instructions[i], memory_size)) {
+            return nullptr;
+        }
+    }
+    if (has_exit) {
+        if (!emit_exit(e, last, end_address, memory_size)) {
+            return nullptr;
+        }
+    } else {
+        // Any other terminator (Call, Ret, Syscall, ...) was rejected above.
+        e.mov_imm64(RAX, end_address);
+        e.ret();
+    }
+
+    if (used_ + e.code.size() > capacity_) {
+        full_ = true;
+        return nullptr;
+    }
+
+#if X86SIM_HAVE_JIT
+    // Only the pages the new code lands on change protection.
+    uint8_t* entry = code_cache_ + used_;
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t first_page = used_ / page_size * page_size;
+    const size_t last_page = (used_ + e.code.size() + page_size - 1) / page_size * page_size;
+    uint8_t* pages = code_cache_ + first_page;
+    const size_t pages_size = std::min(last_page, capacity_) - first_page;
+    if (mprotect(pages, pages_size, PROT_READ | PROT_WRITE) != 0) {
+        return nullptr;
+    }
+    std::memcpy(entry, e.code.data(), e.code.size());
+    if (mprotect(pages, pages_size, PROT_READ | PROT_EXEC) != 0) {
+        // Earlier blocks on these pages are no longer executable either;
+        // report the cache as full so the caller flushes every entry point.
+        full_ = true;
+        return nullptr;
+    }
+    used_ += e.code.size();
+    ++compiled_blocks_;
+    return reinterpret_cast<JitBlockFn>(entry);
+#else
+    return nullptr;
+#endif
+}
+
+void JitCompiler::flush() {
+    used_ = 0;
+    full_ = false;
+}
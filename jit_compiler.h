@@ -0,0 +1,77 @@
+#ifndef JIT_COMPILER_H
+#define JIT_COMPILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ir.h"
+#include "memory.h"
+
+/**
+ * @brief Guest state seen by JIT-compiled code.
+ *
+ * General purpose registers are indexed like IRRegister::index (x86 encoding
+ * order: rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi).
+ */
+struct JitState {
+    uint64_t gpr[8];
+    uint64_t rflags;
+    uint8_t* memory_base;
+};
+
+/**
+ * @brief Entry point of a compiled block. Returns the guest RIP to continue at.
+ */
+using JitBlockFn = uint64_t (*)(JitState* state);
+
+/**
+ * @brief Emits x86-64 host code for hot IR blocks into an executable code cache.
+ *
+ * Supported: Move, Add, Sub, Xor and Cmp on 32/64-bit GPRs with register,
+ * immediate or constant-address memory sources, plus Inc, Dec and Zero on
+ * those GPRs. A block may end in Jump; in a Branch, CmpBranch or DecBranch
+ * on Equal or NotEqual; or in a plain fall-through. Compiled code writes all
+ * six status flags (CF, PF, AF, ZF, SF, OF) bit-identically to LazyFlags;
+ * Inc and Dec leave CF unchanged. Any other instruction makes compile()
+ * return nullptr and the block stays interpreted.
+ *
+ * The pages a block is written to are mapped read/write for the copy and
+ * then flipped back to read/execute. If that fails the cache reports itself
+ * full so callers flush it. It is only available on x86-64 hosts with mmap.
+ */
+class JitCompiler {
+public:
+    explicit JitCompiler(size_t code_cache_size = kDefaultCodeCacheSize);
+    ~JitCompiler();
+
+    JitCompiler(const JitCompiler&) = delete;
+    JitCompiler& operator=(const JitCompiler&) = delete;
+
+    static bool is_supported();
+
+    // Compiles a block whose instructions are `instructions` and whose
+    // fall-through address is `end_address`. Returns nullptr if the block
+    // uses unsupported IR, lies outside `memory_size`, or the cache is full
+    // (see is_full()).
+    JitBlockFn compile(const std::vector<IRInstruction>& instructions, uint64_t end_address, size_t memory_size);
+
+    // True once a compile failed for lack of space or could not make its
+    // pages executable again; flush() to start over.
+    bool is_full() const { return full_; }
+    // Discards all compiled code. No returned entry point may be used afterwards.
+    void flush();
+
+    size_t get_code_size() const { return used_; }
+    uint64_t get_compiled_blocks() const { return compiled_blocks_; }
+
+    static constexpr size_t kDefaultCodeCacheSize = 4 * 1024 * 1024;
+
+private:
+    uint8_t* code_cache_ = nullptr;
+    size_t capacity_ = 0;
+    size_t used_ = 0;
+    bool full_ = false;
+    uint64_t compiled_blocks_ = 0;
+};
+
+#endif // JIT_COMPILER_H
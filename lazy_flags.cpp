@@ -0,0 +1,73 @@
+#include "lazy_flags.h"
+#include "x86_simulator.h"
+
+namespace {
+
+uint64_t width_mask(uint32_t size) {
+    return size >= 64 ? ~0ULL : (1ULL << size) - 1;
+}
+
+} // namespace
+
+void LazyFlags::record(FlagOp op, uint32_t size, uint64_t dest, uint64_t src, uint64_t result) {
+    const uint64_t mask = width_mask(size);
+    op_ = op;
+    size_ = size;
+    dest_ = dest & mask;
+    src_ = src & mask;
+    result_ = result & mask;
+}
+
+void LazyFlags::record_preserving_carry(FlagOp op, uint32_t size, uint64_t dest, uint64_t result, bool carry) {
+    record(op, size, dest, 1, result);
+    carry_ = carry;
+}
+
+bool LazyFlags::cf() const {
+    switch (op_) {
+        case FlagOp::Add:   return result_ < dest_;
+        case FlagOp::Sub:   return dest_ < src_;
+        case FlagOp::Inc:
+        case FlagOp::Dec:   return carry_;
+        default:            return false;
+    }
+}
+
+bool LazyFlags::pf() const {
+    uint8_t low = static_cast<uint8_t>(result_);
+    low ^= low >> 4;
+    low ^= low >> 2;
+    low ^= low >> 1;
+    return (low & 1) == 0;
+}
+
+bool LazyFlags::af() const {
+    if (op_ == FlagOp::Logic) {
+        return false;
+    }
+    return ((dest_ ^ src_ ^ result_) & 0x10) != 0;
+}
+
+bool LazyFlags::of() const {
+    switch (op_) {
+        case FlagOp::Add:
+        case FlagOp::Inc:   return ((dest_ ^ result_) & (src_ ^ result_) & sign_bit()) != 0;
+        case FlagOp::Sub:
+        case FlagOp::Dec:   return ((dest_ ^ src_) & (dest_ ^ result_) & sign_bit()) != 0;
+        default:            return false;
+    }
+}
+
+uint64_t LazyFlags::materialize(uint64_t rflags) const {
+    if (!pending()) {
+        return rflags;
+    }
+    rflags &= ~RFLAGS_STATUS_MASK;
+    rflags |= uint64_t{cf()} << RFLAGS_CF_BIT;
+    rflags |= uint64_t{pf()} << RFLAGS_PF_BIT;
+    rflags |= uint64_t{af()} << RFLAGS_AF_BIT;
+    rflags |= uint64_t{zf()} << RFLAGS_ZF_BIT;
+    rflags |= uint64_t{sf()} << RFLAGS_SF_BIT;
+    rflags |= uint64_t{of()} << RFLAGS_OF_BIT;
+    return rflags;
+}
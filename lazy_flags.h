@@ -0,0 +1,57 @@
+#ifndef LAZY_FLAGS_H
+#define LAZY_FLAGS_H
+
+#include <cstdint>
+
+/**
+ * @brief Kind of the last flag-producing operation.
+ */
+enum class FlagOp : uint8_t {
+    None,  // No pending operation; RFLAGS holds the flags
+    Add,
+    Sub,   // Also used for Cmp
+    Logic, // And, Or, Xor: CF, OF and AF cleared
+    Inc,   // Add 1, CF preserved
+    Dec,   // Sub 1, CF preserved
+};
+
+/**
+ * @brief Deferred condition-flag state.
+ *
+ * Arithmetic handlers record the operation, width, operands and result instead
+ * of computing CF, PF, AF, ZF, SF and OF after every instruction. Individual
+ * flags are derived only when a branch, a flag getter or the UI reads them.
+ */
+class LazyFlags {
+public:
+    void record(FlagOp op, uint32_t size, uint64_t dest, uint64_t src, uint64_t result);
+    // For Inc/Dec, which leave CF as it was before the operation.
+    void record_preserving_carry(FlagOp op, uint32_t size, uint64_t dest, uint64_t result, bool carry);
+
+    bool pending() const { return op_ != FlagOp::None; }
+    void clear() { op_ = FlagOp::None; }
+
+    bool cf() const;
+    bool pf() const;
+    bool af() const;
+    bool zf() const { return result_ == 0; }
+    bool sf() const { return (result_ & sign_bit()) != 0; }
+    bool of() const;
+
+    /**
+     * @brief Returns `rflags` with the six status flags replaced by the pending ones.
+     */
+    uint64_t materialize(uint64_t rflags) const;
+
+private:
+    uint64_t sign_bit() const { return 1ULL << (size_ - 1); }
+
+    FlagOp op_ = FlagOp::None;
+    uint32_t size_ = 32;
+    bool carry_ = false;
+    uint64_t dest_ = 0;
+    uint64_t src_ = 0;
+    uint64_t result_ = 0;
+};
+
+#endif // LAZY_FLAGS_H
@@ -1,6 +1,9 @@
 #include "memory.h"
 #include <iostream>
 #include <algorithm> // For std::fill and std::copy
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
 
 // Constructor for the default memory layout
 Memory::Memory()
@@ -13,12 +16,8 @@ Memory::Memory()
     heap_segment_start = bss_segment_start + initial_heap_size;
     total_memory_size = heap_segment_start + initial_heap_size + max_stack_size;
     
-    // Allocate main memory using std::vector and smart pointer.
-    main_memory = std::make_unique<std::vector<uint8_t>>(total_memory_size, 0);
-
-    // Explicitly zero the BSS segment.
-    std::fill(main_memory->begin() + bss_segment_start,
-              main_memory->begin() + heap_segment_start, 0);
+    // Reserve main memory; pages (BSS included) read as zero until written.
+    map_memory();
 
     // Set up stack boundaries and pointer.
     stack_bottom = total_memory_size;
@@ -38,12 +37,8 @@ Memory::Memory(size_t text_size, size_t data_size, size_t bss_size)
     heap_segment_start = bss_segment_start + bss_size;
     total_memory_size = heap_segment_start + initial_heap_size + max_stack_size;
 
-    // Allocate main memory using std::vector and smart pointer.
-    main_memory = std::make_unique<std::vector<uint8_t>>(total_memory_size, 0);
-    
-    // Explicitly zero the BSS segment.
-    std::fill(main_memory->begin() + bss_segment_start,
-              main_memory->begin() + heap_segment_start, 0);
+    // Reserve main memory; pages (BSS included) read as zero until written.
+    map_memory();
 
     // Set up stack boundaries and pointer.
     stack_bottom = total_memory_size;
@@ -52,51 +47,136 @@ Memory::Memory(size_t text_size, size_t data_size, size_t bss_size)
     stack_segment_start = stack_bottom - max_stack_size;
 }
 
+void Memory::Unmapper::operator()(uint8_t* base) const {
+    munmap(base, size);
+}
+
+void Memory::map_memory() {
+    if (main_memory && main_memory.get_deleter().size == total_memory_size) {
+        // Dropping the pages zero-fills them on the next touch.
+        madvise(main_memory.get(), total_memory_size, MADV_DONTNEED);
+        flush_tlb();
+        return;
+    }
+    main_memory.reset();
+    void* base = mmap(nullptr, total_memory_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    main_memory = std::unique_ptr<uint8_t, Unmapper>(static_cast<uint8_t*>(base), Unmapper{total_memory_size});
+    flush_tlb();
+}
+
+void Memory::flush_tlb() {
+    tlb_.fill(TlbEntry{});
+}
+
+// Pages overlapping the text segment are cached read-only so stores to them
+// reach notify_text_write().
+void Memory::fill_tlb(address_t page) const {
+    address_t page_start = page << kPageBits;
+    if (page_start + kPageSize > total_memory_size) {
+        return;
+    }
+    bool holds_text = page_start < text_segment_start + text_segment_size &&
+                      page_start + kPageSize > text_segment_start;
+    TlbEntry& entry = tlb_[page % kTlbEntries];
+    entry.page = page;
+    entry.host = main_memory.get() + page_start;
+    entry.permissions = holds_text ? kTlbRead : kTlbRead | kTlbWrite;
+}
+
+void Memory::load_slow(address_t address, void* out, size_t size) const {
+    check_bounds(address, size);
+    ++tlb_misses;
+    fill_tlb(address >> kPageBits);
+    std::memcpy(out, main_memory.get() + address, size);
+}
+
+void Memory::store_slow(address_t address, const void* in, size_t size) {
+    check_bounds(address, size);
+    ++tlb_misses;
+    fill_tlb(address >> kPageBits);
+    std::memcpy(main_memory.get() + address, in, size);
+    notify_text_write(address, size);
+}
+
+size_t Memory::get_resident_size() const {
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> pages((total_memory_size + page_size - 1) / page_size);
+    if (mincore(main_memory.get(), total_memory_size, pages.data()) != 0) {
+        return total_memory_size;
+    }
+    size_t resident = 0;
+    for (unsigned char page : pages) {
+        resident += page & 1;
+    }
+    return resident * page_size;
+}
+
 // Generic bounds checking helper function
 void Memory::check_bounds(address_t address, size_t size) const {
-    if (address + size > main_memory->size() || address < 0) {
+    if (size > total_memory_size || address > total_memory_size - size) {
         throw std::out_of_range("Memory access out of bounds!");
     }
 }
 
+// Tells instruction caches that code bytes changed. Writes outside the text
+// segment are the common case and cost a single comparison.
+void Memory::notify_text_write(address_t address, size_t size) {
+    if (text_write_listeners.empty() ||
+        address >= text_segment_start + text_segment_size ||
+        address + size <= text_segment_start) {
+        return;
+    }
+    for (const auto& entry : text_write_listeners) {
+        entry.second(address, size);
+    }
+}
+
+size_t Memory::add_text_write_listener(TextWriteListener listener) {
+    size_t listener_id = next_text_write_listener_id++;
+    text_write_listeners.emplace_back(listener_id, std::move(listener));
+    return listener_id;
+}
+
+void Memory::remove_text_write_listener(size_t listener_id) {
+    text_write_listeners.erase(
+        std::remove_if(text_write_listeners.begin(), text_write_listeners.end(),
+                       [listener_id](const auto& entry) { return entry.first == listener_id; }),
+        text_write_listeners.end());
+}
+
 // Accessors with updated implementation for text segment
 uint8_t Memory::read_text(address_t address) const {
     if (address < text_segment_start || address >= (text_segment_start + text_segment_size)) {
         throw std::out_of_range("Text segment read out of bounds!");
     }
-    return main_memory->at(address);
+    return main_memory.get()[address];
 }
 
 void Memory::write_text(address_t address, uint8_t value) {
     if (address < text_segment_start || address >= (text_segment_start + text_segment_size)) {
         throw std::out_of_range("Text segment write out of bounds!");
     }
-    main_memory->at(address) = value;
+    main_memory.get()[address] = value;
+    notify_text_write(address, 1);
 }
 
 uint32_t Memory::read_text_dword(address_t address) const {
     if (address < text_segment_start || address + 4 > (text_segment_start + text_segment_size)) {
         throw std::out_of_range("Text segment read out of bounds!");
     }
-    return *reinterpret_cast<uint32_t*>(main_memory->data() + address);
+    return *reinterpret_cast<uint32_t*>(main_memory.get() + address);
 }
 
 void Memory::write_text_dword(address_t address, uint32_t value) {
     if (address < text_segment_start || address + 4 > (text_segment_start + text_segment_size)) {
         throw std::out_of_range("Text segment write out of bounds!");
     }
-    *reinterpret_cast<uint32_t*>(main_memory->data() + address) = value;
-}
-
-// Generic byte access
-uint8_t Memory::read_byte(address_t address) const {
-    check_bounds(address, 1);
-    return main_memory->at(address);
-}
-
-void Memory::write_byte(address_t address, uint8_t value) {
-    check_bounds(address, 1);
-    main_memory->at(address) = value;
+    *reinterpret_cast<uint32_t*>(main_memory.get() + address) = value;
+    notify_text_write(address, 4);
 }
 
 // Accessors for data segment
@@ -104,80 +184,40 @@ uint8_t Memory::read_data(address_t address) const {
     if (address < data_segment_start || address >= bss_segment_start) {
         throw std::out_of_range("Data segment read out of bounds!");
     }
-    return main_memory->at(address);
+    return main_memory.get()[address];
 }
 
 void Memory::write_data(address_t address, uint8_t value) {
     if (address < data_segment_start || address >= bss_segment_start) {
         throw std::out_of_range("Data segment write out of bounds!");
     }
-    main_memory->at(address) = value;
+    main_memory.get()[address] = value;
 }
 
 uint32_t Memory::read_data_dword(address_t address) const {
     if (address < data_segment_start || address + 4 > bss_segment_start) {
         throw std::out_of_range("Data segment read out of bounds!");
     }
-    return *reinterpret_cast<uint32_t*>(main_memory->data() + address);
+    return *reinterpret_cast<uint32_t*>(main_memory.get() + address);
 }
 
 void Memory::write_data_dword(address_t address, uint32_t value) {
     if (address < data_segment_start || address + 4 > bss_segment_start) {
         throw std::out_of_range("Data segment write out of bounds!");
     }
-    *reinterpret_cast<uint32_t*>(main_memory->data() + address) = value;
+    *reinterpret_cast<uint32_t*>(main_memory.get() + address) = value;
 }
 
 // AVX2 read/write
 m256i_t Memory::read_ymm(address_t address) const {
     check_bounds(address, 32); // 32 bytes for AVX2 YMM register
-    return _mm256_loadu_si256_sim(main_memory->data() + address);
+    return _mm256_loadu_si256_sim(main_memory.get() + address);
 }
 
 void Memory::write_ymm(address_t address, m256i_t value) {
     check_bounds(address, 32); // 32 bytes for AVX2 YMM register
-    _mm256_storeu_si256_sim(main_memory->data() + address, value);
-}
-
-// Generic 64-bit read/write using reinterpret_cast
-uint64_t Memory::read64(address_t address) const {
-    check_bounds(address, 8);
-    return *reinterpret_cast<const uint64_t*>(main_memory->data() + address);
-}
-
-void Memory::write64(address_t address, uint64_t value) {
-    check_bounds(address, 8);
-    *reinterpret_cast<uint64_t*>(main_memory->data() + address) = value;
-}
-
-// 64-bit accessor aliases
-uint64_t Memory::read_qword(address_t address) const {
-    return read64(address);
-}
-
-void Memory::write_qword(address_t address, uint64_t value) {
-    write64(address, value);
-}
-
-// Generic 32-bit read using reinterpret_cast
-uint32_t Memory::read_dword(address_t address) const {
-    check_bounds(address, 4);
-    return *reinterpret_cast<const uint32_t*>(main_memory->data() + address);
-}
-
-void Memory::write_dword(address_t address, uint32_t value) {
-    check_bounds(address, 4);
-    *reinterpret_cast<uint32_t*>(main_memory->data() + address) = value;
-}
-
-uint16_t Memory::read_word(address_t address) const {
-    check_bounds(address, 2);
-    return *reinterpret_cast<const uint16_t*>(main_memory->data() + address);
-}
-
-void Memory::write_word(address_t address, uint16_t value) {
-    check_bounds(address, 2);
-    *reinterpret_cast<uint16_t*>(main_memory->data() + address) = value;
+    _mm256_storeu_si256_sim(main_memory.get() + address, value);
+    notify_text_write(address, 32);
 }
 
 // Stack accessors
@@ -192,25 +232,28 @@ void Memory::write_stack(address_t address, uint64_t value) {
     if (address < stack_segment_start || address + 8 > stack_segment_end) {
         throw std::out_of_range("Stack segment write out of bounds!");
     }
-    *reinterpret_cast<uint64_t*>(main_memory->data() + address) = value;
+    *reinterpret_cast<uint64_t*>(main_memory.get() + address) = value;
 }
 
 uint32_t Memory::read_stack_dword(address_t address) const {
     if (address < stack_segment_start || address + 4 > stack_segment_end) {
         throw std::out_of_range("Stack segment dword read out of bounds!");
     }
-    return *reinterpret_cast<const uint32_t*>(main_memory->data() + address);
+    return *reinterpret_cast<const uint32_t*>(main_memory.get() + address);
 }
 
 void Memory::write_stack_dword(address_t address, uint32_t value) {
     if (address < stack_segment_start || address + 4 > stack_segment_end) {
         throw std::out_of_range("Stack segment dword write out of bounds!");
     }
-    *reinterpret_cast<uint32_t*>(main_memory->data() + address) = value;
+    *reinterpret_cast<uint32_t*>(main_memory.get() + address) = value;
 }
 
 // Reset function that returns to a default state
 void Memory::reset() {
+    // Every cached instruction is about to become stale.
+    notify_text_write(text_segment_start, text_segment_size);
+
     // Re-initialize members to default-constructed state, avoiding assignment.
     text_segment_start = 0;
     data_segment_start = 0x200000;
@@ -220,10 +263,7 @@ void Memory::reset() {
     heap_segment_start = bss_segment_start + initial_heap_size;
     total_memory_size = heap_segment_start + initial_heap_size + max_stack_size;
     
-    main_memory = std::make_unique<std::vector<uint8_t>>(total_memory_size, 0);
-
-    std::fill(main_memory->begin() + bss_segment_start,
-              main_memory->begin() + heap_segment_start, 0);
+    map_memory();
 
     stack_bottom = total_memory_size;
     stack_pointer = stack_bottom;
@@ -238,4 +278,6 @@ size_t Memory::get_total_memory_size() const {
 
 void Memory::set_text_segment_size(size_t size) {
     text_segment_size = size;
+    // Write permission depends on which pages hold text.
+    flush_tlb();
 }
@@ -1,32 +1,98 @@
 #ifndef X86SIMULATOR_MEMORY_H
 #define X86SIMULATOR_MEMORY_H
 
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <cstddef>
 #include <stdexcept>
 #include <memory>
+#include <functional>
+#include <utility>
 #include "avx_core.h"
 
 // Use a fixed-size integer type for addresses for clarity and portability.
 // A 64-bit unsigned integer is appropriate for a 64-bit simulator.
 using address_t = uint64_t;
 
+// Guest memory is one anonymous mapping reserved for the whole layout. The
+// host hands out zeroed pages only when they are first written, so a process
+// that touches a few KB costs a few KB of RAM however large its heap and
+// stack segments are, and reset() returns the pages instead of reallocating.
+//
+// The generic read_*/write_* accessors go through a small direct-mapped
+// software TLB keyed by guest page number. A hit is a tag compare and a host
+// load or store inlined at the call site; misses, page-crossing accesses,
+// faults and writes to pages holding text (which must notify listeners) take
+// the out-of-line slow path. The TLB is refilled by const reads, so one
+// Memory's generic accessors belong to one thread; read_text* never touches
+// it and stays safe for concurrent decoders.
 class Memory {
 public:
+  // Callback invoked with the start address and byte count of every write that
+  // touches the text segment. Used by instruction caches to drop stale entries.
+  using TextWriteListener = std::function<void(address_t address, size_t size)>;
+
   // Public interface and constructors
   Memory();
   Memory(size_t text_size, size_t data_size, size_t bss_size);
 
+  // Software TLB geometry and entry layout, public so native tiers can
+  // probe tlb() inline. An entry maps guest page `page` to host memory at
+  // `host`; kTlbWrite is withheld from pages that overlap the text segment.
+  static constexpr unsigned kPageBits = 12;
+  static constexpr size_t kPageSize = size_t{1} << kPageBits;
+  static constexpr size_t kTlbEntries = 256;
+  static constexpr uint8_t kTlbRead = 1;
+  static constexpr uint8_t kTlbWrite = 2;
+  struct TlbEntry {
+    address_t page = ~address_t{0};
+    uint8_t* host = nullptr;
+    uint8_t permissions = 0;
+  };
+
+  // Loads/stores a T at `address`, hitting the TLB when the access fits in a
+  // cached page. Out-of-range accesses throw std::out_of_range.
+  template <typename T>
+  T load(address_t address) const {
+    const TlbEntry& entry = tlb_[(address >> kPageBits) % kTlbEntries];
+    size_t offset = address & (kPageSize - 1);
+    T value;
+    if (entry.page == (address >> kPageBits) && (entry.permissions & kTlbRead) &&
+        offset <= kPageSize - sizeof(T)) {
+      std::memcpy(&value, entry.host + offset, sizeof(T));
+    } else {
+      load_slow(address, &value, sizeof(T));
+    }
+    return value;
+  }
+
+  template <typename T>
+  void store(address_t address, T value) {
+    const TlbEntry& entry = tlb_[(address >> kPageBits) % kTlbEntries];
+    size_t offset = address & (kPageSize - 1);
+    if (entry.page == (address >> kPageBits) && (entry.permissions & kTlbWrite) &&
+        offset <= kPageSize - sizeof(T)) {
+      std::memcpy(entry.host + offset, &value, sizeof(T));
+    } else {
+      store_slow(address, &value, sizeof(T));
+    }
+  }
+
+  const TlbEntry* tlb() const { return tlb_.data(); }
+  void flush_tlb();
+  uint64_t get_tlb_misses() const { return tlb_misses; }
+
   // Accessors for different memory segments
   uint8_t read_text(address_t address) const;
   void write_text(address_t address, uint8_t value);
   uint32_t read_text_dword(address_t address) const;
   void write_text_dword(address_t address, uint32_t value);
-  uint8_t read_byte(address_t address) const;
-  void write_byte(address_t address, uint8_t value);
-  uint64_t read64(address_t address) const;
-  void write64(address_t address, uint64_t value);
+  uint8_t read_byte(address_t address) const { return load<uint8_t>(address); }
+  void write_byte(address_t address, uint8_t value) { store(address, value); }
+  uint64_t read64(address_t address) const { return load<uint64_t>(address); }
+  void write64(address_t address, uint64_t value) { store(address, value); }
   uint8_t read_data(address_t address) const;
   void write_data(address_t address, uint8_t value);
   uint32_t read_data_dword(address_t address) const;
@@ -42,18 +108,30 @@ public:
   void write_ymm(address_t address, m256i_t value);
 
   // Helper functions for various data sizes
-  uint64_t read_qword(address_t address) const;
-  void write_qword(address_t address, uint64_t value);
-  uint32_t read_dword(address_t address) const;
-  void write_dword(address_t address, uint32_t value);
-  uint16_t read_word(address_t address) const;
-  void write_word(address_t address, uint16_t value);
+  uint64_t read_qword(address_t address) const { return load<uint64_t>(address); }
+  void write_qword(address_t address, uint64_t value) { store(address, value); }
+  uint32_t read_dword(address_t address) const { return load<uint32_t>(address); }
+  void write_dword(address_t address, uint32_t value) { store(address, value); }
+  uint16_t read_word(address_t address) const { return load<uint16_t>(address); }
+  void write_word(address_t address, uint16_t value) { store(address, value); }
 
   // Management functions
   void reset();
   size_t get_total_memory_size() const;
   void set_text_segment_size(size_t size);
 
+  // Bytes of guest memory currently backed by host pages.
+  size_t get_resident_size() const;
+
+  // Host address of guest address 0, for native execution tiers that read
+  // memory directly. Changes only when reset() switches to a layout of a
+  // different size.
+  uint8_t* host_base() { return main_memory.get(); }
+
+  // Text-segment write observers (self-modifying code support)
+  size_t add_text_write_listener(TextWriteListener listener);
+  void remove_text_write_listener(size_t listener_id);
+
   // Getters for memory layout
   size_t get_text_segment_start() const { return text_segment_start; }
   size_t get_text_segment_size() const { return text_segment_size; }
@@ -66,9 +144,25 @@ public:
 private:
   // Helper for bounds checking
   void check_bounds(address_t address, size_t size) const;
+  // Notifies listeners if [address, address + size) overlaps the text segment.
+  void notify_text_write(address_t address, size_t size);
+  // TLB miss paths: bounds-check, refill the entry and copy `size` bytes.
+  void load_slow(address_t address, void* out, size_t size) const;
+  void store_slow(address_t address, const void* in, size_t size);
+  void fill_tlb(address_t page) const;
+
+  // Reserves zero-filled memory for total_memory_size bytes, reusing the
+  // current mapping when it already has that size.
+  void map_memory();
+
+  // Unmaps the guest memory mapping.
+  struct Unmapper {
+    size_t size;
+    void operator()(uint8_t* base) const;
+  };
 
   // Main memory and layout details
-  std::unique_ptr<std::vector<uint8_t>> main_memory;
+  std::unique_ptr<uint8_t, Unmapper> main_memory;
 
   // Memory segment boundaries
   address_t text_segment_start;
@@ -84,6 +178,13 @@ private:
   address_t stack_bottom;
   address_t stack_pointer;
   
+  mutable std::array<TlbEntry, kTlbEntries> tlb_;
+  mutable uint64_t tlb_misses = 0;
+
+  // Registered text-segment write observers, keyed by listener id.
+  std::vector<std::pair<size_t, TextWriteListener>> text_write_listeners;
+  size_t next_text_write_listener_id = 0;
+
   // Initial size constants
   const size_t initial_heap_size = 0x1000000;
   const size_t max_stack_size = 0x100000;
@@ -0,0 +1,430 @@
+#include "native_module.h"
+#include "ir_compact.h"
+#include "x86_simulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <variant>
+#include <dlfcn.h>
+#include <unistd.h>
+
+namespace {
+
+std::string hex(uint64_t value) {
+    std::ostringstream out;
+    out << "UINT64_C(0x" << std::hex << value << ")";
+    return out.str();
+}
+
+uint64_t width_mask(unsigned bits) {
+    return bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+}
+
+// Everything the generated functions share. JitState must stay identical to
+// the definition in jit_compiler.h.
+void emit_prelude(std::ostream& out) {
+    out << "// Generated by the x86 simulator from translated IR blocks. Do not edit.\n"
+        << "#include <cstdint>\n"
+        << "#include <cstring>\n\n"
+        << "struct JitState {\n"
+        << "    uint64_t gpr[8];\n"
+        << "    uint64_t rflags;\n"
+        << "    uint8_t* memory_base;\n"
+        << "};\n\n"
+        << "namespace {\n\n"
+        << "enum FlagKind { kAdd, kSub, kLogic, kInc, kDec };\n\n"
+        << "// Mirrors LazyFlags::materialize.\n"
+        << "inline uint64_t flags(uint64_t rflags, FlagKind op, unsigned bits, uint64_t d, uint64_t s, uint64_t r) {\n"
+        << "    const uint64_t mask = bits >= 64 ? ~UINT64_C(0) : (UINT64_C(1) << bits) - 1;\n"
+        << "    const uint64_t sign = UINT64_C(1) << (bits - 1);\n"
+        << "    d &= mask; s &= mask; r &= mask;\n"
+        << "    uint64_t cf = op == kAdd ? r < d : op == kSub ? d < s : (op == kInc || op == kDec) ? ((rflags >> "
+        << RFLAGS_CF_BIT << ") & 1) : 0;\n"
+        << "    uint8_t low = static_cast<uint8_t>(r);\n"
+        << "    low ^= low >> 4; low ^= low >> 2; low ^= low >> 1;\n"
+        << "    uint64_t pf = (low & 1) == 0;\n"
+        << "    uint64_t af = op != kLogic && ((d ^ s ^ r) & 0x10) != 0;\n"
+        << "    uint64_t of = (op == kAdd || op == kInc) ? ((d ^ r) & (s ^ r) & sign) != 0\n"
+        << "                : (op == kSub || op == kDec) ? ((d ^ s) & (d ^ r) & sign) != 0 : 0;\n"
+        << "    uint64_t zf = r == 0;\n"
+        << "    uint64_t sf = (r & sign) != 0;\n"
+        << "    rflags &= ~" << hex(RFLAGS_STATUS_MASK) << ";\n"
+        << "    return rflags | cf << " << RFLAGS_CF_BIT << " | pf << " << RFLAGS_PF_BIT << " | af << "
+        << RFLAGS_AF_BIT << " | zf << " << RFLAGS_ZF_BIT << " | sf << " << RFLAGS_SF_BIT << " | of << "
+        << RFLAGS_OF_BIT << ";\n"
+        << "}\n\n"
+        << "inline uint64_t ld32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }\n"
+        << "inline uint64_t ld64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }\n"
+        << "inline void st32(uint8_t* p, uint64_t v) { uint32_t w = static_cast<uint32_t>(v); std::memcpy(p, &w, 4); }\n"
+        << "inline void st64(uint8_t* p, uint64_t v) { std::memcpy(p, &v, 8); }\n\n";
+}
+
+std::string condition_expr(IRConditionCode condition, const std::string& flags) {
+    auto bit = [&](uint64_t position) { return "((" + flags + " >> " + std::to_string(position) + ") & 1)"; };
+    const std::string cf = bit(RFLAGS_CF_BIT), zf = bit(RFLAGS_ZF_BIT);
+    const std::string sf = bit(RFLAGS_SF_BIT), of = bit(RFLAGS_OF_BIT);
+    switch (condition) {
+        case IRConditionCode::Equal:          return zf;
+        case IRConditionCode::NotEqual:       return "!" + zf;
+        case IRConditionCode::Below:          return cf;
+        case IRConditionCode::AboveOrEqual:   return "!" + cf;
+        case IRConditionCode::Less:           return "(" + sf + " != " + of + ")";
+        case IRConditionCode::GreaterOrEqual: return "(" + sf + " == " + of + ")";
+        case IRConditionCode::LessOrEqual:    return "(" + zf + " || " + sf + " != " + of + ")";
+        case IRConditionCode::Greater:        return "(!" + zf + " && " + sf + " == " + of + ")";
+        case IRConditionCode::Overflow:       return of;
+        case IRConditionCode::NotOverflow:    return "!" + of;
+        case IRConditionCode::Sign:           return sf;
+        case IRConditionCode::NotSign:        return "!" + sf;
+    }
+    return "false";
+}
+
+// Translates one block into the body of a JitBlockFn.
+class BlockEmitter {
+public:
+    BlockEmitter(const Memory& memory, const BasicBlock& block) : memory_(memory), block_(block) {}
+
+    bool emit(std::ostream& out) {
+        for (const IRInstruction& instr : block_.instructions) {
+            if (returned_ || !emit_instruction(instr)) {
+                return false;
+            }
+        }
+        if (!returned_) {
+            body_ << "    return " << hex(block_.end_address) << ";\n";
+        }
+        out << body_.str();
+        return true;
+    }
+
+private:
+    static bool is_gpr(const IRRegister& reg) {
+        return reg.type == IRRegisterType::GPR && reg.index < 8 && (reg.size == 32 || reg.size == 64);
+    }
+
+    // Bits of a register or memory operand, or 0 for anything else.
+    static unsigned width_of(const IROperand& op) {
+        if (const IRRegister* reg = std::get_if<IRRegister>(&op)) return is_gpr(*reg) ? reg->size : 0;
+        if (const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+            return mem->size == 32 || mem->size == 64 ? mem->size : 0;
+        }
+        return 0;
+    }
+
+    bool constant_address(const IRMemoryOperand& mem, bool store) const {
+        const uint64_t bytes = mem.size / 8;
+        if (mem.base_reg || mem.index_reg || mem.displacement < 0 ||
+            static_cast<uint64_t>(mem.displacement) + bytes > memory_.get_total_memory_size()) {
+            return false;
+        }
+        return !store || static_cast<uint64_t>(mem.displacement) >= memory_.get_data_segment_start();
+    }
+
+    bool read(const IROperand& op, unsigned bits, std::string& expr) const {
+        if (const IRRegister* reg = std::get_if<IRRegister>(&op)) {
+            if (!is_gpr(*reg) || reg->size != bits) return false;
+            const std::string value = "s->gpr[" + std::to_string(reg->index) + "]";
+            expr = bits == 32 ? "static_cast<uint32_t>(" + value + ")" : value;
+            return true;
+        }
+        if (const uint64_t* imm = std::get_if<uint64_t>(&op)) {
+            expr = hex(*imm & width_mask(bits));
+            return true;
+        }
+        if (const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+            if (mem->size != bits || !constant_address(*mem, false)) return false;
+            expr = std::string(bits == 32 ? "ld32" : "ld64") + "(s->memory_base + " +
+                   hex(static_cast<uint64_t>(mem->displacement)) + ")";
+            return true;
+        }
+        return false;
+    }
+
+    bool write(const IROperand& op, unsigned bits, const std::string& value) {
+        if (const IRRegister* reg = std::get_if<IRRegister>(&op)) {
+            if (!is_gpr(*reg) || reg->size != bits) return false;
+            body_ << "        s->gpr[" << reg->index << "] = "
+                  << (bits == 32 ? "static_cast<uint32_t>(" + value + ")" : value) << ";\n";
+            return true;
+        }
+        if (const IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+            if (mem->size != bits || !constant_address(*mem, true)) return false;
+            body_ << "        " << (bits == 32 ? "st32" : "st64") << "(s->memory_base + "
+                  << hex(static_cast<uint64_t>(mem->displacement)) << ", " << value << ");\n";
+            return true;
+        }
+        return false;
+    }
+
+    void record_flags(const IRInstruction& instr, const char* kind, unsigned bits, const std::string& d,
+                      const std::string& v, const std::string& r) {
+        if (instr.flags_live) {
+            body_ << "        s->rflags = flags(s->rflags, " << kind << ", " << bits << ", " << d << ", " << v
+                  << ", " << r << ");\n";
+        }
+    }
+
+    bool emit_instruction(const IRInstruction& instr) {
+        const auto& ops = instr.operands;
+        std::string a, b;
+        body_ << "    {\n";
+        bool ok = false;
+        switch (instr.opcode) {
+            case IROpcode::Nop:
+                ok = true;
+                break;
+            case IROpcode::Move:
+            case IROpcode::Load:
+            case IROpcode::Store: {
+                unsigned bits = ops.size() == 2 ? width_of(ops[0]) : 0;
+                ok = bits && read(ops[1], bits, b) && write(ops[0], bits, b);
+                break;
+            }
+            case IROpcode::Add:
+            case IROpcode::Sub:
+            case IROpcode::And:
+            case IROpcode::Or:
+            case IROpcode::Xor:
+            case IROpcode::Cmp: {
+                unsigned bits = ops.size() == 2 ? width_of(ops[0]) : 0;
+                if (!bits || !read(ops[0], bits, a) || !read(ops[1], bits, b)) break;
+                static const std::pair<const char*, const char*> kOps[] = {
+                    {"+", "kAdd"}, {"-", "kSub"}, {"&", "kLogic"}, {"|", "kLogic"}, {"^", "kLogic"}, {"-", "kSub"},
+                };
+                const auto& op = kOps[instr.opcode == IROpcode::Add ? 0 : instr.opcode == IROpcode::Sub ? 1
+                                    : instr.opcode == IROpcode::And ? 2 : instr.opcode == IROpcode::Or ? 3
+                                    : instr.opcode == IROpcode::Xor ? 4 : 5];
+                body_ << "        const uint64_t d = " << a << ", v = " << b << ";\n"
+                      << "        const uint64_t r = (d " << op.first << " v) & " << hex(width_mask(bits)) << ";\n";
+                ok = instr.opcode == IROpcode::Cmp || write(ops[0], bits, "r");
+                record_flags(instr, op.second, bits, "d", "v", "r");
+                break;
+            }
+            case IROpcode::Inc:
+            case IROpcode::Dec:
+            case IROpcode::Not: {
+                unsigned bits = ops.size() == 1 ? width_of(ops[0]) : 0;
+                if (!bits || !std::holds_alternative<IRRegister>(ops[0]) || !read(ops[0], bits, a)) break;
+                const char* step = instr.opcode == IROpcode::Inc ? "d + 1" : instr.opcode == IROpcode::Dec ? "d - 1" : "~d";
+                body_ << "        const uint64_t d = " << a << ";\n"
+                      << "        const uint64_t r = (" << step << ") & " << hex(width_mask(bits)) << ";\n";
+                ok = write(ops[0], bits, "r");
+                if (instr.opcode != IROpcode::Not) {
+                    record_flags(instr, instr.opcode == IROpcode::Inc ? "kInc" : "kDec", bits, "d", "1", "r");
+                }
+                break;
+            }
+            case IROpcode::Zero: {
+                unsigned bits = ops.size() == 1 ? width_of(ops[0]) : 0;
+                ok = bits && std::holds_alternative<IRRegister>(ops[0]) && write(ops[0], bits, "0");
+                record_flags(instr, "kLogic", bits, "0", "0", "0");
+                break;
+            }
+            case IROpcode::Jump:
+                if (ops.size() == 1 && std::holds_alternative<uint64_t>(ops[0])) {
+                    body_ << "        return " << hex(std::get<uint64_t>(ops[0])) << ";\n";
+                    ok = returned_ = true;
+                }
+                break;
+            case IROpcode::Branch:
+                if (ops.size() == 2 && std::holds_alternative<uint64_t>(ops[0]) &&
+                    std::holds_alternative<IRConditionCode>(ops[1])) {
+                    body_ << "        return " << condition_expr(std::get<IRConditionCode>(ops[1]), "s->rflags")
+                          << " ? " << hex(std::get<uint64_t>(ops[0])) << " : " << hex(block_.end_address) << ";\n";
+                    ok = returned_ = true;
+                }
+                break;
+            case IROpcode::CmpBranch: {
+                unsigned bits = ops.size() == 4 ? width_of(ops[2]) : 0;
+                if (!bits || !std::holds_alternative<uint64_t>(ops[0]) ||
+                    !std::holds_alternative<IRConditionCode>(ops[1]) || !read(ops[2], bits, a) ||
+                    !read(ops[3], bits, b)) {
+                    break;
+                }
+                body_ << "        const uint64_t d = " << a << ", v = " << b << ";\n"
+                      << "        const uint64_t f = flags(s->rflags, kSub, " << bits << ", d, v, d - v);\n";
+                if (instr.flags_live) body_ << "        s->rflags = f;\n";
+                body_ << "        return " << condition_expr(std::get<IRConditionCode>(ops[1]), "f") << " ? "
+                      << hex(std::get<uint64_t>(ops[0])) << " : " << hex(block_.end_address) << ";\n";
+                ok = returned_ = true;
+                break;
+            }
+            case IROpcode::DecBranch: {
+                unsigned bits = ops.size() == 3 ? width_of(ops[2]) : 0;
+                if (!bits || !std::holds_alternative<uint64_t>(ops[0]) ||
+                    !std::holds_alternative<IRConditionCode>(ops[1]) ||
+                    !std::holds_alternative<IRRegister>(ops[2]) || !read(ops[2], bits, a)) {
+                    break;
+                }
+                body_ << "        const uint64_t d = " << a << ";\n"
+                      << "        const uint64_t r = (d - 1) & " << hex(width_mask(bits)) << ";\n";
+                if (!write(ops[2], bits, "r")) break;
+                record_flags(instr, "kDec", bits, "d", "1", "r");
+                const bool jump_if_zero = std::get<IRConditionCode>(ops[1]) == IRConditionCode::Equal;
+                body_ << "        return (r == 0) == " << (jump_if_zero ? "true" : "false") << " ? "
+                      << hex(std::get<uint64_t>(ops[0])) << " : " << hex(block_.end_address) << ";\n";
+                ok = returned_ = true;
+                break;
+            }
+            default:
+                break;
+        }
+        body_ << "    }\n";
+        return ok;
+    }
+
+    const Memory& memory_;
+    const BasicBlock& block_;
+    std::ostringstream body_;
+    bool returned_ = false;
+};
+
+std::string shell_quote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+} // namespace
+
+uint64_t fingerprint_block(const BasicBlock& block) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(&block.start_address, sizeof(block.start_address));
+    mix(&block.end_address, sizeof(block.end_address));
+    IRLabelTable labels;
+    for (const IRInstruction& instr : block.instructions) {
+        CompactIRInstruction compact;
+        if (encode_ir(instr, compact, labels)) {
+            compact.handler = nullptr;
+            mix(&compact, sizeof(compact));
+        } else {
+            mix(&instr.opcode, sizeof(instr.opcode));
+        }
+    }
+    return hash;
+}
+
+size_t emit_native_module(const BlockCache& blocks, const Memory& memory, std::ostream& out) {
+    emit_prelude(out);
+    std::vector<std::pair<address_t, uint64_t>> emitted;
+    blocks.for_each([&](const BasicBlock& block) {
+        std::ostringstream body;
+        if (!BlockEmitter(memory, block).emit(body)) {
+            return;
+        }
+        out << "uint64_t block_" << emitted.size() << "(JitState* s) { // " << hex(block.start_address) << "\n"
+            << body.str() << "}\n\n";
+        emitted.emplace_back(block.start_address, fingerprint_block(block));
+    });
+    out << "} // namespace\n\n";
+
+    out << "extern \"C\" const uint32_t x86sim_module_abi = " << kNativeModuleAbi << ";\n"
+        << "extern \"C\" const uint64_t x86sim_memory_size = " << hex(memory.get_total_memory_size()) << ";\n"
+        << "extern \"C\" const uint64_t x86sim_data_segment_start = " << hex(memory.get_data_segment_start()) << ";\n"
+        << "extern \"C\" const uint64_t x86sim_block_count = " << emitted.size() << ";\n";
+    // Arrays keep at least one element so an empty module still compiles.
+    out << "extern \"C\" const uint64_t x86sim_block_addresses[] = {";
+    for (const auto& entry : emitted) out << hex(entry.first) << ", ";
+    out << "0};\n"
+        << "extern \"C\" const uint64_t x86sim_block_fingerprints[] = {";
+    for (const auto& entry : emitted) out << hex(entry.second) << ", ";
+    out << "0};\n"
+        << "extern \"C\" uint64_t (*const x86sim_block_functions[])(JitState*) = {";
+    for (size_t i = 0; i < emitted.size(); ++i) out << "block_" << i << ", ";
+    out << "nullptr};\n";
+    return emitted.size();
+}
+
+NativeModule::~NativeModule() {
+    if (handle_) {
+        dlclose(handle_);
+    }
+}
+
+bool NativeModule::build(const BlockCache& blocks, const Memory& memory, const std::string& library_path,
+                         std::string& error) {
+    const std::string source_path = library_path + ".cpp";
+    {
+        std::ofstream source(source_path, std::ios::trunc);
+        emit_native_module(blocks, memory, source);
+        if (!source) {
+            error = "cannot write " + source_path;
+            return false;
+        }
+    }
+    const char* compiler = std::getenv("CXX");
+    // Build under a temporary name so a concurrent load never sees a partial file.
+    const std::string temp_path = library_path + ".tmp." + std::to_string(::getpid());
+    const std::string command = std::string(compiler && *compiler ? compiler : "c++") +
+                                " -std=c++17 -O2 -shared -fPIC -o " + shell_quote(temp_path) + " " +
+                                shell_quote(source_path);
+    if (std::system(command.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        error = "compiler failed: " + command;
+        return false;
+    }
+    if (std::rename(temp_path.c_str(), library_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        error = "cannot write " + library_path;
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<NativeModule> NativeModule::load(const std::string& library_path, const Memory& memory,
+                                                 std::string& error) {
+    std::unique_ptr<NativeModule> module(new NativeModule());
+    module->handle_ = dlopen(library_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!module->handle_) {
+        const char* reason = dlerror();
+        error = reason ? reason : "cannot open " + library_path;
+        return nullptr;
+    }
+    auto symbol = [&](const char* name) { return dlsym(module->handle_, name); };
+    const auto* abi = static_cast<const uint32_t*>(symbol("x86sim_module_abi"));
+    const auto* memory_size = static_cast<const uint64_t*>(symbol("x86sim_memory_size"));
+    const auto* data_start = static_cast<const uint64_t*>(symbol("x86sim_data_segment_start"));
+    const auto* count = static_cast<const uint64_t*>(symbol("x86sim_block_count"));
+    const auto* addresses = static_cast<const uint64_t*>(symbol("x86sim_block_addresses"));
+    const auto* fingerprints = static_cast<const uint64_t*>(symbol("x86sim_block_fingerprints"));
+    const auto* functions = static_cast<const JitBlockFn*>(symbol("x86sim_block_functions"));
+    if (!abi || !memory_size || !data_start || !count || !addresses || !fingerprints || !functions ||
+        *abi != kNativeModuleAbi) {
+        error = library_path + " is not a native module for this simulator";
+        return nullptr;
+    }
+    // Constant addresses were bounds-checked against the memory the module was built for.
+    if (*memory_size > memory.get_total_memory_size() || *data_start != memory.get_data_segment_start()) {
+        error = library_path + " was built for a different memory layout";
+        return nullptr;
+    }
+    for (uint64_t i = 0; i < *count; ++i) {
+        module->functions_[addresses[i]] = Entry{fingerprints[i], functions[i]};
+    }
+    return module;
+}
+
+size_t NativeModule::attach(BlockCache& blocks) const {
+    size_t attached = 0;
+    for (const auto& entry : functions_) {
+        BasicBlock* block = blocks.find(entry.first);
+        if (block && fingerprint_block(*block) == entry.second.fingerprint) {
+            block->native_code = entry.second.function;
+            block->native_code_owner = NativeCodeOwner::Module;
+            ++attached;
+        }
+    }
+    return attached;
+}
@@ -0,0 +1,84 @@
+#ifndef NATIVE_MODULE_H
+#define NATIVE_MODULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include "memory.h"
+#include "basic_block.h"
+#include "jit_compiler.h"
+
+// Ahead-of-time native code for translated blocks, built with the system C++
+// compiler.
+//
+// emit_native_module() writes a self-contained translation unit with one
+// function per block, each a JitBlockFn over JitState, so the block engine
+// calls it exactly like JIT output. NativeModule compiles that source into a
+// shared object, dlopens it and attaches the functions to the matching cached
+// blocks. Blocks using IR the generator does not cover keep running in the
+// interpreter (or the JIT).
+//
+// Covered: Move, Load, Store, Add, Sub, And, Or, Xor, Cmp, Inc, Dec, Not, Zero
+// and Nop on 32/64-bit GPRs, immediates and constant addresses, ending in a
+// direct Jump, Branch, CmpBranch, DecBranch or a fall-through. Stores must
+// land at or above the data segment, so text writes still go through Memory
+// and invalidate blocks. Flags match LazyFlags bit for bit.
+
+// Bump when JitState or the exported symbols change.
+constexpr uint32_t kNativeModuleAbi = 1;
+
+/**
+ * @brief Identifies a block's IR. A module function is attached only to a
+ *        block with the same start address and fingerprint.
+ */
+uint64_t fingerprint_block(const BasicBlock& block);
+
+/**
+ * @brief Writes C++ source for every covered block in `blocks` to `out`.
+ *
+ * @return The number of blocks emitted.
+ */
+size_t emit_native_module(const BlockCache& blocks, const Memory& memory, std::ostream& out);
+
+/**
+ * @brief A loaded shared object of compiled blocks. Closing it (destruction)
+ *        invalidates every function it handed out.
+ */
+class NativeModule {
+public:
+    ~NativeModule();
+
+    NativeModule(const NativeModule&) = delete;
+    NativeModule& operator=(const NativeModule&) = delete;
+
+    // Emits `library_path`.cpp from `blocks` and compiles it to `library_path`
+    // with $CXX (default "c++"). Returns false with `error` set on failure.
+    static bool build(const BlockCache& blocks, const Memory& memory, const std::string& library_path,
+                      std::string& error);
+    // Opens a module built by build(). Returns nullptr with `error` set if it
+    // cannot be opened, exports the wrong ABI, or was built for a larger memory.
+    static std::unique_ptr<NativeModule> load(const std::string& library_path, const Memory& memory,
+                                              std::string& error);
+
+    // Sets native_code on every cached block the module has a function for.
+    // Returns the number of blocks attached.
+    size_t attach(BlockCache& blocks) const;
+
+    size_t size() const { return functions_.size(); }
+
+private:
+    NativeModule() = default;
+
+    struct Entry {
+        uint64_t fingerprint;
+        JitBlockFn function;
+    };
+
+    void* handle_ = nullptr;
+    std::unordered_map<address_t, Entry> functions_;
+};
+
+#endif // NATIVE_MODULE_H
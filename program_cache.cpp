@@ -0,0 +1,356 @@
+#include "program_cache.h"
+#include "ir_compact.h"
+#include "ir_dispatch.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef X86SIM_BUILD_ID
+#define X86SIM_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+namespace {
+
+constexpr char kMagic[8] = {'X', '8', '6', 'C', 'A', 'C', 'H', 'E'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t instruction_size; // sizeof(CompactIRInstruction) of the writer
+    uint64_t source_hash;
+    uint64_t entry_point;
+    uint64_t text_start;
+    uint64_t text_size;
+    uint64_t data_start;
+    uint64_t data_size;
+    uint64_t symbol_count;
+    uint64_t label_count;
+    uint64_t block_count;
+    uint64_t instruction_count;
+    // Section offsets from the start of the file.
+    uint64_t text_offset;
+    uint64_t data_offset;
+    uint64_t strings_offset;      // Symbols, then IR labels
+    uint64_t blocks_offset;       // BlockRecord[block_count]
+    uint64_t instructions_offset; // CompactIRInstruction[instruction_count]
+    uint64_t file_size;
+};
+
+struct BlockRecord {
+    uint64_t start_address;
+    uint64_t end_address;
+    uint64_t taken_target;
+    uint32_t first_instruction;
+    uint32_t instruction_count;
+    uint8_t ends_with_terminator;
+    uint8_t has_taken_target;
+    uint8_t padding[6];
+};
+
+class Writer {
+public:
+    size_t size() const { return bytes_.size(); }
+    const std::vector<unsigned char>& bytes() const { return bytes_; }
+
+    void align(size_t alignment) { bytes_.resize((bytes_.size() + alignment - 1) / alignment * alignment, 0); }
+    void raw(const void* data, size_t size) {
+        const auto* begin = static_cast<const unsigned char*>(data);
+        bytes_.insert(bytes_.end(), begin, begin + size);
+    }
+    template <typename T>
+    void put(const T& value) { raw(&value, sizeof(value)); }
+    void string(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        raw(value.data(), value.size());
+    }
+    void patch(size_t offset, const void* data, size_t size) { std::memcpy(bytes_.data() + offset, data, size); }
+
+private:
+    std::vector<unsigned char> bytes_;
+};
+
+// Bounds-checked cursor over the strings section.
+class Reader {
+public:
+    Reader(const unsigned char* begin, const unsigned char* end) : cursor_(begin), end_(end) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end_ - cursor_) < sizeof(T)) return false;
+        std::memcpy(&value, cursor_, sizeof(T));
+        cursor_ += sizeof(T);
+        return true;
+    }
+    bool string(std::string& value) {
+        uint32_t size = 0;
+        if (!get(size) || static_cast<size_t>(end_ - cursor_) < size) return false;
+        value.assign(reinterpret_cast<const char*>(cursor_), size);
+        cursor_ += size;
+        return true;
+    }
+
+private:
+    const unsigned char* cursor_;
+    const unsigned char* end_;
+};
+
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const unsigned char*>(data);
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<unsigned char*>(data_), size_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+bool section_fits(uint64_t offset, uint64_t count, size_t element_size, size_t file_size) {
+    return offset <= file_size && count <= (file_size - offset) / element_size;
+}
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+
+void fnv_mix(uint64_t& hash, const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+} // namespace
+
+std::string program_cache_path(const std::string& source_path) {
+    return source_path + ".x86cache";
+}
+
+uint64_t program_cache_build_fingerprint() {
+    const uint64_t layout[] = {kNumIROpcodes, kNumIRConditionCodes, kNumIRPasses, sizeof(CompactIRInstruction),
+                               sizeof(CompactIROperand), sizeof(BlockRecord), sizeof(FileHeader)};
+    const char build_id[] = X86SIM_BUILD_ID;
+    uint64_t hash = kFnvOffset;
+    fnv_mix(hash, layout, sizeof(layout));
+    fnv_mix(hash, build_id, sizeof(build_id) - 1);
+    return hash;
+}
+
+uint64_t hash_program_source(const std::string& source, const IRPassManager& passes) {
+    uint64_t hash = kFnvOffset;
+    fnv_mix(hash, source.data(), source.size());
+    const uint32_t version = kProgramCacheVersion;
+    const uint64_t build = program_cache_build_fingerprint();
+    fnv_mix(hash, &version, sizeof(version));
+    fnv_mix(hash, &build, sizeof(build));
+    for (size_t i = 0; i < kNumIRPasses; ++i) {
+        const bool enabled = passes.is_enabled(static_cast<IRPass>(i));
+        fnv_mix(hash, &enabled, sizeof(enabled));
+    }
+    return hash;
+}
+
+bool write_program_cache(const std::string& path, uint64_t source_hash, const ProgramCacheContents& contents,
+                         const Memory& memory, const BlockCache& blocks) {
+    IRLabelTable labels;
+    std::vector<BlockRecord> records;
+    std::vector<CompactIRInstruction> instructions;
+    blocks.for_each([&](const BasicBlock& block) {
+        std::vector<CompactIRInstruction> encoded(block.instructions.size());
+        for (size_t i = 0; i < block.instructions.size(); ++i) {
+            if (!encode_ir(block.instructions[i], encoded[i], labels)) {
+                return; // Left for the block cache to build at run time.
+            }
+            encoded[i].handler = nullptr; // Process-specific; rebound on load.
+        }
+        BlockRecord record = {};
+        record.start_address = block.start_address;
+        record.end_address = block.end_address;
+        record.taken_target = block.taken_target;
+        record.first_instruction = static_cast<uint32_t>(instructions.size());
+        record.instruction_count = static_cast<uint32_t>(encoded.size());
+        record.ends_with_terminator = block.ends_with_terminator;
+        record.has_taken_target = block.has_taken_target;
+        records.push_back(record);
+        instructions.insert(instructions.end(), encoded.begin(), encoded.end());
+    });
+
+    FileHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kProgramCacheVersion;
+    header.instruction_size = sizeof(CompactIRInstruction);
+    header.source_hash = source_hash;
+    header.entry_point = contents.entry_point;
+    header.text_start = memory.get_text_segment_start();
+    header.text_size = contents.text_size;
+    header.data_start = memory.get_data_segment_start();
+    header.data_size = contents.data_size;
+    header.symbol_count = contents.symbols.size();
+    header.label_count = labels.size();
+    header.block_count = records.size();
+    header.instruction_count = instructions.size();
+
+    Writer out;
+    out.put(header);
+    header.text_offset = out.size();
+    for (size_t i = 0; i < contents.text_size; ++i) {
+        out.put(memory.read_text(header.text_start + i));
+    }
+    header.data_offset = out.size();
+    for (size_t i = 0; i < contents.data_size; ++i) {
+        out.put(memory.read_data(header.data_start + i));
+    }
+    header.strings_offset = out.size();
+    for (const auto& symbol : contents.symbols) {
+        out.put(static_cast<uint64_t>(symbol.second));
+        out.string(symbol.first);
+    }
+    for (uint32_t id = 0; id < labels.size(); ++id) {
+        out.string(labels.name(id));
+    }
+    out.align(alignof(BlockRecord));
+    header.blocks_offset = out.size();
+    out.raw(records.data(), records.size() * sizeof(BlockRecord));
+    out.align(alignof(CompactIRInstruction));
+    header.instructions_offset = out.size();
+    out.raw(instructions.data(), instructions.size() * sizeof(CompactIRInstruction));
+    header.file_size = out.size();
+    out.patch(0, &header, sizeof(header));
+
+    const std::string temp_path = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(out.bytes().data()), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool load_program_cache(const std::string& path, uint64_t source_hash, Memory& memory, BlockCache& blocks,
+                        ProgramCacheContents& contents) {
+    MappedFile file(path);
+    if (!file.data() || file.size() < sizeof(FileHeader)) {
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const size_t size = file.size();
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kProgramCacheVersion ||
+        header.instruction_size != sizeof(CompactIRInstruction) || header.source_hash != source_hash ||
+        header.file_size != size || header.text_start != memory.get_text_segment_start() ||
+        header.data_start != memory.get_data_segment_start() ||
+        header.text_size > header.data_start - header.text_start ||
+        header.data_size > memory.get_bss_segment_start() - header.data_start ||
+        !section_fits(header.text_offset, header.text_size, 1, size) ||
+        !section_fits(header.data_offset, header.data_size, 1, size) ||
+        !section_fits(header.strings_offset, 0, 1, size) ||
+        !section_fits(header.blocks_offset, header.block_count, sizeof(BlockRecord), size) ||
+        !section_fits(header.instructions_offset, header.instruction_count, sizeof(CompactIRInstruction), size) ||
+        header.blocks_offset < header.strings_offset ||
+        header.blocks_offset % alignof(BlockRecord) != 0 ||
+        header.instructions_offset % alignof(CompactIRInstruction) != 0) {
+        return false;
+    }
+
+    ProgramCacheContents loaded;
+    loaded.entry_point = header.entry_point;
+    loaded.text_size = header.text_size;
+    loaded.data_size = header.data_size;
+    Reader strings(file.data() + header.strings_offset, file.data() + header.blocks_offset);
+    for (uint64_t i = 0; i < header.symbol_count; ++i) {
+        uint64_t address = 0;
+        std::string name;
+        if (!strings.get(address) || !strings.string(name)) return false;
+        loaded.symbols[name] = address;
+    }
+    IRLabelTable labels;
+    for (uint64_t i = 0; i < header.label_count; ++i) {
+        std::string label;
+        if (!strings.string(label)) return false;
+        labels.intern(label);
+    }
+
+    // Records and compact instructions are validated in place in the mapping,
+    // then each is decoded into the block's own IRInstruction vector; blocks
+    // do not execute from the mapping.
+    const auto* records = reinterpret_cast<const BlockRecord*>(file.data() + header.blocks_offset);
+    const auto* instructions = reinterpret_cast<const CompactIRInstruction*>(file.data() + header.instructions_offset);
+    std::vector<std::unique_ptr<BasicBlock>> loaded_blocks;
+    loaded_blocks.reserve(header.block_count);
+    for (uint64_t b = 0; b < header.block_count; ++b) {
+        const BlockRecord& record = records[b];
+        if (record.instruction_count == 0 || record.first_instruction > header.instruction_count ||
+            record.instruction_count > header.instruction_count - record.first_instruction) {
+            return false;
+        }
+        auto block = std::make_unique<BasicBlock>();
+        block->start_address = record.start_address;
+        block->end_address = record.end_address;
+        block->taken_target = record.taken_target;
+        block->ends_with_terminator = record.ends_with_terminator != 0;
+        block->has_taken_target = record.has_taken_target != 0;
+        block->instructions.reserve(record.instruction_count);
+        for (uint32_t i = 0; i < record.instruction_count; ++i) {
+            const CompactIRInstruction& compact = instructions[record.first_instruction + i];
+            if (compact.operand_count > CompactIRInstruction::kMaxOperands) return false;
+            for (size_t op = 0; op < compact.operand_count; ++op) {
+                if (compact.operands[op].kind == CompactIROperandKind::Label &&
+                    compact.operands[op].label >= labels.size()) {
+                    return false;
+                }
+            }
+            IRInstruction ir_instr = decode_ir(compact, labels);
+            if (!bind_ir_handler(ir_instr)) {
+                return false;
+            }
+            block->instructions.push_back(std::move(ir_instr));
+        }
+        loaded_blocks.push_back(std::move(block));
+    }
+
+    // Everything checked out; copy the image into guest memory, then install
+    // the blocks built from it.
+    for (uint64_t i = 0; i < header.text_size; ++i) {
+        memory.write_text(header.text_start + i, file.data()[header.text_offset + i]);
+    }
+    memory.set_text_segment_size(header.text_size);
+    for (uint64_t i = 0; i < header.data_size; ++i) {
+        memory.write_data(header.data_start + i, file.data()[header.data_offset + i]);
+    }
+    for (auto& block : loaded_blocks) {
+        blocks.insert(std::move(block));
+    }
+    contents = std::move(loaded);
+    return true;
+}
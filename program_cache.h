@@ -0,0 +1,74 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include "memory.h"
+#include "basic_block.h"
+#include "ir_passes.h"
+
+// On-disk cache of an assembled program and its translated blocks.
+//
+// A `<program>.x86cache` file sits next to the source and holds the text and
+// data segment bytes, the symbol table, the entry point and every cached
+// BasicBlock as compact IR (ir_compact.h). The file is keyed by a hash of the
+// source text, the build that wrote it (program_cache_build_fingerprint()) and
+// the IR passes that were enabled, so a file written by another build or pass
+// configuration is ignored and rewritten rather than loaded as stale IR.
+//
+// The loader maps the file read-only and validates it in place, but the
+// image is copied into Memory and every block is decoded back to the
+// IRInstruction form BasicBlock executes, so the mapping is released once
+// loading returns. Loading still skips assembly, decoding and translation.
+
+// Bump whenever the file layout changes. IR and translator changes are
+// caught by the build fingerprint.
+constexpr uint32_t kProgramCacheVersion = 1;
+
+struct ProgramCacheContents {
+    address_t entry_point = 0;
+    size_t text_size = 0; // Bytes from the start of the text segment.
+    size_t data_size = 0; // Bytes from the start of the data segment.
+    std::map<std::string, address_t> symbols;
+};
+
+std::string program_cache_path(const std::string& source_path);
+
+// Identifies the IR a build produces: the IROpcode and condition counts, the
+// compact record sizes and X86SIM_BUILD_ID, which Makefile.mk derives from a
+// checksum of the sources (the compile date and time when it is not set).
+uint64_t program_cache_build_fingerprint();
+
+// FNV-1a hash of `source` mixed with kProgramCacheVersion, the build
+// fingerprint and the passes enabled in `passes`.
+uint64_t hash_program_source(const std::string& source, const IRPassManager& passes);
+
+/**
+ * @brief Writes `contents`, the segment bytes it covers and every block in
+ *        `blocks` to `path`.
+ *
+ * The file is written under a temporary name and renamed into place, so a
+ * concurrent reader sees either the old file or the complete new one. Blocks
+ * with an instruction that has no compact form are left out.
+ *
+ * @return false if the file could not be written.
+ */
+bool write_program_cache(const std::string& path, uint64_t source_hash, const ProgramCacheContents& contents,
+                         const Memory& memory, const BlockCache& blocks);
+
+/**
+ * @brief Restores a program written by write_program_cache().
+ *
+ * On success the segment bytes are copied into `memory`, the text segment
+ * size is set, the blocks are inserted into `blocks` with their handlers
+ * rebound, and `contents` is filled in.
+ *
+ * @return false, leaving everything untouched, if the file is missing,
+ *         malformed, or was written for another source hash or version.
+ */
+bool load_program_cache(const std::string& path, uint64_t source_hash, Memory& memory, BlockCache& blocks,
+                        ProgramCacheContents& contents);
+
+#endif // PROGRAM_CACHE_H
@@ -1,27 +1,219 @@
-
 #include "program_decoder.h"
+#include "instruction_formatter.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <iterator>
 
-ProgramDecoder::ProgramDecoder(const Memory& memory) : memory_(memory) {}
+namespace {
 
-void ProgramDecoder::decode() {
-    Decoder& decoder = Decoder::getInstance();
-    address_t addr = memory_.get_text_segment_start();
-    size_t index = 0;
-    while (addr < memory_.get_text_segment_start() + memory_.get_text_segment_size()) {
-        if (auto decoded_instr_opt = decoder.decodeInstruction(memory_, addr)) {
-            address_to_index_map_[addr] = index++;
-            addr += decoded_instr_opt->length_in_bytes;
-            decoded_program_.push_back(std::move(decoded_instr_opt));
+using Listing = std::vector<DecodedInstruction>;
+
+// Decodes and formats one instruction at `address`; returns where the sweep
+// continues. Undecodable bytes and zero-length instructions are stepped over
+// a byte at a time.
+address_t decode_one(const Memory& memory, address_t address, Listing& out) {
+    CompactDecodedInstruction instr;
+    if (!Decoder::decode(memory, address, instr)) {
+        return address + 1;
+    }
+    out.push_back(format_instruction(instr));
+    return address + (instr.length_in_bytes ? instr.length_in_bytes : 1);
+}
+
+// Linear sweep from `address` while it is below `end`. Returns the address
+// the sweep stopped at, which may lie past `end`.
+address_t sweep(const Memory& memory, address_t address, address_t end, Listing& out) {
+    while (address < end) {
+        address = decode_one(memory, address, out);
+    }
+    return address;
+}
+
+address_t end_of(const DecodedInstruction& instr) {
+    return instr.address + std::max<size_t>(instr.length_in_bytes, 1);
+}
+
+struct Chunk {
+    address_t begin = 0;
+    address_t end = 0;
+    address_t stop = 0; // Where this chunk's sweep ended.
+    Listing listing;
+};
+
+// Chunk starts: evenly spaced, each moved forward to the next known boundary
+// if one is close.
+std::vector<address_t> chunk_starts(address_t begin, address_t end, size_t chunks,
+                                    const std::vector<address_t>& boundaries) {
+    std::vector<address_t> starts = {begin};
+    const size_t chunk_size = (end - begin) / chunks;
+    for (size_t i = 1; i < chunks; ++i) {
+        address_t ideal = begin + i * chunk_size;
+        auto it = std::lower_bound(boundaries.begin(), boundaries.end(), ideal);
+        address_t start = it != boundaries.end() && *it < ideal + chunk_size / 2 ? *it : ideal;
+        if (start > starts.back() && start < end) {
+            starts.push_back(start);
+        }
+    }
+    return starts;
+}
+
+} // namespace
+
+ProgramDecoder::ProgramDecoder(Memory& memory) : memory_(memory) {
+    listener_id_ = memory_.add_text_write_listener([this](address_t address, size_t size) {
+        if (dirty_begin_ == dirty_end_) {
+            dirty_begin_ = address;
+            dirty_end_ = address + size;
         } else {
-            addr++;
+            dirty_begin_ = std::min(dirty_begin_, address);
+            dirty_end_ = std::max<address_t>(dirty_end_, address + size);
+        }
+    });
+}
+
+ProgramDecoder::~ProgramDecoder() {
+    memory_.remove_text_write_listener(listener_id_);
+}
+
+void ProgramDecoder::set_range(address_t begin, address_t end) {
+    has_range_ = true;
+    range_begin_ = begin;
+    range_end_ = end;
+}
+
+void ProgramDecoder::set_boundaries(std::vector<address_t> boundaries) {
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+    boundaries_ = std::move(boundaries);
+}
+
+void ProgramDecoder::decode() {
+    instructions_.clear();
+    index_.clear();
+    dirty_begin_ = dirty_end_ = 0;
+
+    address_t begin = memory_.get_text_segment_start();
+    address_t end = begin + memory_.get_text_segment_size();
+    if (has_range_) {
+        begin = std::max(begin, range_begin_);
+        end = std::min(end, range_end_);
+    } else {
+        // Skip the zero fill after the program.
+        while (end > begin && memory_.read_text(end - 1) == 0) {
+            --end;
+        }
+    }
+    begin_ = begin;
+    end_ = std::max(begin, end);
+    if (begin >= end) {
+        return;
+    }
+
+    const size_t threads = threads_ ? threads_ : ThreadPool::default_thread_count();
+    const size_t chunk_count = std::min(threads * 4, static_cast<size_t>(end - begin) / kMinChunkBytes);
+    if (threads <= 1 || chunk_count <= 1) {
+        sweep(memory_, begin, end, instructions_);
+    } else {
+        std::vector<address_t> starts = chunk_starts(begin, end, chunk_count, boundaries_);
+        std::vector<Chunk> chunks(starts.size());
+        ThreadPool pool(threads);
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            Chunk& chunk = chunks[i];
+            chunk.begin = starts[i];
+            chunk.end = i + 1 < starts.size() ? starts[i + 1] : end;
+            pool.submit([this, &chunk] { chunk.stop = sweep(memory_, chunk.begin, chunk.end, chunk.listing); });
+        }
+        pool.wait();
+
+        // Stitch in order. `next` is where a single sweep would be; when it
+        // is not at a chunk's start, re-decode from `next` until it lands on
+        // an instruction the chunk already found.
+        address_t next = begin;
+        for (Chunk& chunk : chunks) {
+            auto by_address = [](const DecodedInstruction& instr, address_t address) {
+                return instr.address < address;
+            };
+            while (next < chunk.end) {
+                auto it = std::lower_bound(chunk.listing.begin(), chunk.listing.end(), next, by_address);
+                if (it != chunk.listing.end() && it->address == next) {
+                    std::move(it, chunk.listing.end(), std::back_inserter(instructions_));
+                    next = chunk.stop;
+                    break;
+                }
+                next = decode_one(memory_, next, instructions_);
+            }
+        }
+    }
+
+    index_.assign(end_ - begin_, kNoInstruction);
+    index_from(0);
+}
+
+void ProgramDecoder::redecode(address_t begin, address_t end) {
+    begin = std::max(begin, begin_);
+    end = std::min(end, end_);
+    if (begin >= end) {
+        return;
+    }
+
+    // The first instruction that could read [begin, end) is the first one
+    // ending past `begin`; the sweep was at the end of the one before it.
+    auto first_it = std::lower_bound(instructions_.begin(), instructions_.end(), begin,
+                                     [](const DecodedInstruction& instr, address_t address) {
+                                         return end_of(instr) <= address;
+                                     });
+    const size_t first = first_it - instructions_.begin();
+    address_t address = first > 0 ? end_of(instructions_[first - 1]) : begin_;
+
+    // Sweep until past `end` at an instruction start the old listing shares;
+    // from there on both listings agree.
+    Listing replacement;
+    while (address < end_ && (address < end || index_[address - begin_] == kNoInstruction)) {
+        address = decode_one(memory_, address, replacement);
+    }
+    const size_t last = address < end_ ? index_[address - begin_] : instructions_.size();
+
+    for (size_t i = first; i < last; ++i) {
+        index_[instructions_[i].address - begin_] = kNoInstruction;
+    }
+    const bool shifted = replacement.size() != last - first;
+    instructions_.erase(instructions_.begin() + first, instructions_.begin() + last);
+    instructions_.insert(instructions_.begin() + first, std::make_move_iterator(replacement.begin()),
+                         std::make_move_iterator(replacement.end()));
+    if (shifted) {
+        index_from(first);
+    } else {
+        for (size_t i = first; i < first + replacement.size(); ++i) {
+            index_[instructions_[i].address - begin_] = static_cast<uint32_t>(i);
         }
     }
 }
 
-const std::vector<std::unique_ptr<DecodedInstruction>>& ProgramDecoder::getDecodedProgram() const {
-    return decoded_program_;
+void ProgramDecoder::refresh() {
+    if (dirty_begin_ == dirty_end_) {
+        return;
+    }
+    address_t begin = dirty_begin_;
+    address_t end = dirty_end_;
+    dirty_begin_ = dirty_end_ = 0;
+    redecode(begin, end);
 }
 
-const std::map<address_t, size_t>& ProgramDecoder::getAddressToIndexMap() const {
-    return address_to_index_map_;
+bool ProgramDecoder::index_of(address_t address, size_t& index) const {
+    if (address < begin_ || address >= end_ || index_[address - begin_] == kNoInstruction) {
+        return false;
+    }
+    index = index_[address - begin_];
+    return true;
+}
+
+const DecodedInstruction* ProgramDecoder::find(address_t address) const {
+    size_t index;
+    return index_of(address, index) ? &instructions_[index] : nullptr;
+}
+
+void ProgramDecoder::index_from(size_t first) {
+    for (size_t i = first; i < instructions_.size(); ++i) {
+        index_[instructions_[i].address - begin_] = static_cast<uint32_t>(i);
+    }
 }
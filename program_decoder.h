@@ -1,24 +1,77 @@
-
 #ifndef PROGRAM_DECODER_H
 #define PROGRAM_DECODER_H
 
+#include <cstdint>
 #include <vector>
-#include <map>
-#include <memory>
 #include "memory.h"
 #include "decoder.h"
 
+// Decodes the program listing shown by the UI.
+//
+// Only [begin, end) is swept: by default the text segment up to its last
+// non-zero byte. Large ranges are split into chunks that decode on a thread
+// pool, starting preferably at known instruction boundaries (symbols, branch
+// targets). Chunks are stitched back together so the listing is exactly what
+// one linear sweep from `begin` would produce, whatever the split.
+//
+// The listing is one contiguous array with a per-byte index over the range,
+// so address lookups are O(1). Text writes are recorded through the Memory
+// listener and refresh() re-decodes just the instructions they touched.
 class ProgramDecoder {
 public:
-    ProgramDecoder(const Memory& memory);
+    explicit ProgramDecoder(Memory& memory);
+    ~ProgramDecoder();
+
+    ProgramDecoder(const ProgramDecoder&) = delete;
+    ProgramDecoder& operator=(const ProgramDecoder&) = delete;
+
+    // Restricts decoding to [begin, end), e.g. to the assembled program.
+    void set_range(address_t begin, address_t end);
+    // Addresses known to start an instruction. Only used to choose where
+    // chunks start; wrong hints cost time, not correctness.
+    void set_boundaries(std::vector<address_t> boundaries);
+    // 0 uses ThreadPool::default_thread_count(); 1 decodes on the caller.
+    void set_threads(size_t threads) { threads_ = threads; }
+
     void decode();
-    const std::vector<std::unique_ptr<DecodedInstruction>>& getDecodedProgram() const;
-    const std::map<address_t, size_t>& getAddressToIndexMap() const;
+    // Re-decodes from the instruction overlapping `begin` until the sweep
+    // past `end` lands on an instruction start it already had.
+    void redecode(address_t begin, address_t end);
+    // Applies redecode() to the text written since the last decode.
+    void refresh();
+
+    const std::vector<DecodedInstruction>& getDecodedProgram() const { return instructions_; }
+    // Index into getDecodedProgram() of the instruction starting at `address`.
+    bool index_of(address_t address, size_t& index) const;
+    // The instruction starting at `address`, or nullptr.
+    const DecodedInstruction* find(address_t address) const;
+
+    // Below this many bytes per chunk the range is decoded on the caller.
+    static constexpr size_t kMinChunkBytes = 64 * 1024;
 
 private:
-    const Memory& memory_;
-    std::vector<std::unique_ptr<DecodedInstruction>> decoded_program_;
-    std::map<address_t, size_t> address_to_index_map_;
+    static constexpr uint32_t kNoInstruction = UINT32_MAX;
+
+    void index_from(size_t first);
+
+    Memory& memory_;
+    size_t listener_id_;
+    bool has_range_ = false;
+    address_t range_begin_ = 0;
+    address_t range_end_ = 0;
+    std::vector<address_t> boundaries_;
+    size_t threads_ = 0;
+
+    // The range the listing covers; index_[address - begin_] is the index of
+    // the instruction starting there, or kNoInstruction.
+    address_t begin_ = 0;
+    address_t end_ = 0;
+    std::vector<DecodedInstruction> instructions_;
+    std::vector<uint32_t> index_;
+
+    // Text written since the last decode, as one covering span.
+    address_t dirty_begin_ = 0;
+    address_t dirty_end_ = 0;
 };
 
 #endif // PROGRAM_DECODER_H
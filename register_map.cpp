@@ -1,122 +1,203 @@
 #include "register_map.h"
+#include <array>
 #include <stdexcept> // For std::out_of_range
+#include <string_view>
+
+namespace {
+
+enum class RegisterKind : uint8_t { None, Gpr64, Gpr32, Gpr16, Gpr8, Gpr8High, Ymm };
+
+struct RegisterName {
+  std::string_view name;
+  RegisterKind kind;
+  uint8_t index; // Reg64, Reg32 or RegYMM depending on kind.
+};
+
+constexpr RegisterName kRegisterNames[] = {
+  {"rax", RegisterKind::Gpr64, RAX}, {"rbx", RegisterKind::Gpr64, RBX},
+  {"rcx", RegisterKind::Gpr64, RCX}, {"rdx", RegisterKind::Gpr64, RDX},
+  {"rsi", RegisterKind::Gpr64, RSI}, {"rdi", RegisterKind::Gpr64, RDI},
+  {"rbp", RegisterKind::Gpr64, RBP}, {"rsp", RegisterKind::Gpr64, RSP},
+  {"r8", RegisterKind::Gpr64, R8}, {"r9", RegisterKind::Gpr64, R9},
+  {"r10", RegisterKind::Gpr64, R10}, {"r11", RegisterKind::Gpr64, R11},
+  {"r12", RegisterKind::Gpr64, R12}, {"r13", RegisterKind::Gpr64, R13},
+  {"r14", RegisterKind::Gpr64, R14}, {"r15", RegisterKind::Gpr64, R15},
+  {"rip", RegisterKind::Gpr64, RIP}, {"rflags", RegisterKind::Gpr64, RFLAGS},
+
+  {"eax", RegisterKind::Gpr32, EAX}, {"ebx", RegisterKind::Gpr32, EBX},
+  {"ecx", RegisterKind::Gpr32, ECX}, {"edx", RegisterKind::Gpr32, EDX},
+  {"esi", RegisterKind::Gpr32, ESI}, {"edi", RegisterKind::Gpr32, EDI},
+  {"ebp", RegisterKind::Gpr32, EBP}, {"esp", RegisterKind::Gpr32, ESP},
+  {"eflags", RegisterKind::Gpr32, EFLAGS},
+
+  {"ax", RegisterKind::Gpr16, RAX}, {"bx", RegisterKind::Gpr16, RBX},
+  {"cx", RegisterKind::Gpr16, RCX}, {"dx", RegisterKind::Gpr16, RDX},
+  {"si", RegisterKind::Gpr16, RSI}, {"di", RegisterKind::Gpr16, RDI},
+  {"bp", RegisterKind::Gpr16, RBP}, {"sp", RegisterKind::Gpr16, RSP},
+
+  {"al", RegisterKind::Gpr8, RAX}, {"bl", RegisterKind::Gpr8, RBX},
+  {"cl", RegisterKind::Gpr8, RCX}, {"dl", RegisterKind::Gpr8, RDX},
+  {"ah", RegisterKind::Gpr8High, RAX}, {"bh", RegisterKind::Gpr8High, RBX},
+  {"ch", RegisterKind::Gpr8High, RCX}, {"dh", RegisterKind::Gpr8High, RDX},
+
+  {"ymm0", RegisterKind::Ymm, YMM0}, {"ymm1", RegisterKind::Ymm, YMM1},
+  {"ymm2", RegisterKind::Ymm, YMM2}, {"ymm3", RegisterKind::Ymm, YMM3},
+  {"ymm4", RegisterKind::Ymm, YMM4}, {"ymm5", RegisterKind::Ymm, YMM5},
+  {"ymm6", RegisterKind::Ymm, YMM6}, {"ymm7", RegisterKind::Ymm, YMM7},
+  {"ymm8", RegisterKind::Ymm, YMM8}, {"ymm9", RegisterKind::Ymm, YMM9},
+  {"ymm10", RegisterKind::Ymm, YMM10}, {"ymm11", RegisterKind::Ymm, YMM11},
+  {"ymm12", RegisterKind::Ymm, YMM12}, {"ymm13", RegisterKind::Ymm, YMM13},
+  {"ymm14", RegisterKind::Ymm, YMM14}, {"ymm15", RegisterKind::Ymm, YMM15},
+};
+
+constexpr size_t kNumRegisterNames = sizeof(kRegisterNames) / sizeof(kRegisterNames[0]);
+constexpr size_t kNameTableSize = 256; // Power of two, so the hash is reduced with a mask.
+
+// FNV-1a, salted with a seed chosen at compile time so that no two names collide.
+constexpr uint32_t hash_name(std::string_view name, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (char c : name) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+  }
+  return hash ^ (hash >> 15);
+}
+
+constexpr bool seed_is_perfect(uint32_t seed) {
+  bool used[kNameTableSize] = {};
+  for (size_t i = 0; i < kNumRegisterNames; ++i) {
+    size_t slot = hash_name(kRegisterNames[i].name, seed) & (kNameTableSize - 1);
+    if (used[slot]) return false;
+    used[slot] = true;
+  }
+  return true;
+}
+
+constexpr uint32_t find_perfect_seed() {
+  for (uint32_t seed = 0; seed < 100000; ++seed) {
+    if (seed_is_perfect(seed)) return seed;
+  }
+  return UINT32_MAX;
+}
+
+constexpr uint32_t kNameSeed = find_perfect_seed();
+static_assert(kNameSeed != UINT32_MAX, "No collision-free seed for the register name table");
+
+// Maps each hash slot to 1 + its index in kRegisterNames, or 0 if empty.
+constexpr std::array<uint8_t, kNameTableSize> build_name_table() {
+  std::array<uint8_t, kNameTableSize> table{};
+  for (size_t i = 0; i < kNumRegisterNames; ++i) {
+    table[hash_name(kRegisterNames[i].name, kNameSeed) & (kNameTableSize - 1)] = static_cast<uint8_t>(i + 1);
+  }
+  return table;
+}
+
+constexpr std::array<uint8_t, kNameTableSize> kNameTable = build_name_table();
+
+// Resolves a name with one hash and one comparison; returns nullptr if unknown.
+const RegisterName* find_register(std::string_view name) {
+  uint8_t entry = kNameTable[hash_name(name, kNameSeed) & (kNameTableSize - 1)];
+  if (entry == 0 || kRegisterNames[entry - 1].name != name) {
+    return nullptr;
+  }
+  return &kRegisterNames[entry - 1];
+}
+
+const RegisterName& find_register(const std::string& name, RegisterKind kind, const char* width) {
+  const RegisterName* reg = find_register(name);
+  if (reg == nullptr || reg->kind != kind) {
+    throw std::out_of_range(std::string("Invalid ") + width + " register name: " + name);
+  }
+  return *reg;
+}
+
+template <typename Enum>
+std::map<std::string, Enum> build_name_map(RegisterKind kind) {
+  std::map<std::string, Enum> names;
+  for (const auto& reg : kRegisterNames) {
+    if (reg.kind == kind) {
+      names.emplace(std::string(reg.name), static_cast<Enum>(reg.index));
+    }
+  }
+  return names;
+}
+
+} // namespace
 
 RegisterMap::RegisterMap()
-  : register_name_map_64_({
-        {"rax", RAX}, {"rbx", RBX}, {"rcx", RCX}, {"rdx", RDX},
-        {"rsi", RSI}, {"rdi", RDI}, {"rbp", RBP}, {"rsp", RSP},
-        {"r8", R8}, {"r9", R9}, {"r10", R10}, {"r11", R11},
-        {"r12", R12}, {"r13", R13}, {"r14", R14}, {"r15", R15},
-        {"rip", RIP}, {"rflags", RFLAGS}
-    }),
-    register_name_map_32_({
-        {"eax", EAX}, {"ebx", EBX}, {"ecx", ECX}, {"edx", EDX},
-        {"esi", ESI}, {"edi", EDI}, {"ebp", EBP}, {"esp", ESP},
-        {"eflags", EFLAGS}
-    }),
-    register_name_map_16_({
-        {"ax", RAX}, {"bx", RBX}, {"cx", RCX}, {"dx", RDX},
-        {"si", RSI}, {"di", RDI}, {"bp", RBP}, {"sp", RSP}
-    }),
-    register_name_map_8_({
-        {"al", RAX}, {"bl", RBX}, {"cl", RCX}, {"dl", RDX}
-    }),
-    register_name_map_ymm_({
-        {"ymm0", YMM0}, {"ymm1", YMM1}, {"ymm2", YMM2}, {"ymm3", YMM3},
-        {"ymm4", YMM4}, {"ymm5", YMM5}, {"ymm6", YMM6}, {"ymm7", YMM7},
-        {"ymm8", YMM8}, {"ymm9", YMM9}, {"ymm10", YMM10}, {"ymm11", YMM11},
-        {"ymm12", YMM12}, {"ymm13", YMM13}, {"ymm14", YMM14}, {"ymm15", YMM15}
-    }),
-    registers64_(NUM_REG64, 0),
-    registers_ymm_(NUM_REG_YMM, _mm256_setzero_si256_sim()),
-    RegSeg_(NUM_REG_SEG, 0)
+  : file_{}
 {
-  // All initialization is now done in the member initializer list.
+  for (auto& ymm : file_.ymm) {
+    ymm = _mm256_setzero_si256_sim();
+  }
 }
 
 uint64_t RegisterMap::get64(const std::string& reg_name) const {
-  if (auto it = register_name_map_64_.find(reg_name); it != register_name_map_64_.end()) {
-    return registers64_[static_cast<size_t>(it->second)];
-  }
-  throw std::out_of_range("Invalid 64-bit register name: " + reg_name);
+  return get64(static_cast<Reg64>(find_register(reg_name, RegisterKind::Gpr64, "64-bit").index));
 }
 
 void RegisterMap::set64(const std::string& reg_name, uint64_t value) {
-  if (auto it = register_name_map_64_.find(reg_name); it != register_name_map_64_.end()) {
-    registers64_[static_cast<size_t>(it->second)] = value;
-    return;
-  }
-  throw std::out_of_range("Invalid 64-bit register name: " + reg_name);
+  set64(static_cast<Reg64>(find_register(reg_name, RegisterKind::Gpr64, "64-bit").index), value);
 }
 
 uint64_t RegisterMap::get32(const std::string& reg_name) const {
-  if (auto it = register_name_map_32_.find(reg_name); it != register_name_map_32_.end()) {
-    return static_cast<uint32_t>(registers64_[static_cast<size_t>(it->second)]);
-  }
-  throw std::out_of_range("Invalid 32-bit register name: " + reg_name);
+  return get32(static_cast<Reg32>(find_register(reg_name, RegisterKind::Gpr32, "32-bit").index));
 }
 
 void RegisterMap::set32(const std::string& reg_name, uint64_t value) {
-  if (auto it = register_name_map_32_.find(reg_name); it != register_name_map_32_.end()) {
-    registers64_[static_cast<size_t>(it->second)] = static_cast<uint32_t>(value);
-    return;
-  }
-  throw std::out_of_range("Invalid 32-bit register name: " + reg_name);
+  set32(static_cast<Reg32>(find_register(reg_name, RegisterKind::Gpr32, "32-bit").index), static_cast<uint32_t>(value));
 }
 
 uint16_t RegisterMap::get16(const std::string& reg_name) const {
-    if (auto it = register_name_map_16_.find(reg_name); it != register_name_map_16_.end()) {
-        return static_cast<uint16_t>(registers64_[static_cast<size_t>(it->second)]);
-    }
-    throw std::out_of_range("Invalid 16-bit register name: " + reg_name);
+  return get16(static_cast<Reg64>(find_register(reg_name, RegisterKind::Gpr16, "16-bit").index));
 }
 
 void RegisterMap::set16(const std::string& reg_name, uint16_t value) {
-    if (auto it = register_name_map_16_.find(reg_name); it != register_name_map_16_.end()) {
-        registers64_[static_cast<size_t>(it->second)] = (registers64_[static_cast<size_t>(it->second)] & 0xFFFFFFFFFFFF0000) | value;
-        return;
-    }
-    throw std::out_of_range("Invalid 16-bit register name: " + reg_name);
+  set16(static_cast<Reg64>(find_register(reg_name, RegisterKind::Gpr16, "16-bit").index), value);
 }
 
 uint8_t RegisterMap::get8(const std::string& reg_name) const {
-    if (auto it = register_name_map_8_.find(reg_name); it != register_name_map_8_.end()) {
-        return static_cast<uint8_t>(registers64_[static_cast<size_t>(it->second)]);
-    }
-    throw std::out_of_range("Invalid 8-bit register name: " + reg_name);
+  const RegisterName* reg = find_register(reg_name);
+  if (reg != nullptr && reg->kind == RegisterKind::Gpr8) {
+    return get8(static_cast<Reg64>(reg->index));
+  }
+  if (reg != nullptr && reg->kind == RegisterKind::Gpr8High) {
+    return get8High(static_cast<Reg64>(reg->index));
+  }
+  throw std::out_of_range("Invalid 8-bit register name: " + reg_name);
 }
 
 void RegisterMap::set8(const std::string& reg_name, uint8_t value) {
-    if (auto it = register_name_map_8_.find(reg_name); it != register_name_map_8_.end()) {
-        registers64_[static_cast<size_t>(it->second)] = (registers64_[static_cast<size_t>(it->second)] & 0xFFFFFFFFFFFFFF00) | value;
-        return;
-    }
-    throw std::out_of_range("Invalid 8-bit register name: " + reg_name);
+  const RegisterName* reg = find_register(reg_name);
+  if (reg != nullptr && reg->kind == RegisterKind::Gpr8) {
+    set8(static_cast<Reg64>(reg->index), value);
+    return;
+  }
+  if (reg != nullptr && reg->kind == RegisterKind::Gpr8High) {
+    set8High(static_cast<Reg64>(reg->index), value);
+    return;
+  }
+  throw std::out_of_range("Invalid 8-bit register name: " + reg_name);
 }
 
 const std::map<std::string, Reg64>& RegisterMap::getRegisterNameMap64() const {
-  return register_name_map_64_;
+  static const std::map<std::string, Reg64> names = build_name_map<Reg64>(RegisterKind::Gpr64);
+  return names;
 }
 
 const std::map<std::string, Reg32>& RegisterMap::getRegisterNameMap32() const {
-  return register_name_map_32_;
+  static const std::map<std::string, Reg32> names = build_name_map<Reg32>(RegisterKind::Gpr32);
+  return names;
 }
 
 m256i_t RegisterMap::getYmm(const std::string& reg_name) const {
-  if (auto it = register_name_map_ymm_.find(reg_name); it != register_name_map_ymm_.end()) {
-    return registers_ymm_[static_cast<size_t>(it->second)];
-  }
-  throw std::out_of_range("Invalid YMM register name: " + reg_name);
+  return getYmm(static_cast<RegYMM>(find_register(reg_name, RegisterKind::Ymm, "YMM").index));
 }
 
 void RegisterMap::setYmm(const std::string& reg_name, m256i_t value) {
-  if (auto it = register_name_map_ymm_.find(reg_name); it != register_name_map_ymm_.end()) {
-    registers_ymm_[static_cast<size_t>(it->second)] = value;
-    return;
-  }
-  throw std::out_of_range("Invalid YMM register name: " + reg_name);
+  setYmm(static_cast<RegYMM>(find_register(reg_name, RegisterKind::Ymm, "YMM").index), value);
 }
 
 const std::map<std::string, RegYMM>& RegisterMap::getRegisterNameMapYmm() const {
-    return register_name_map_ymm_;
+  static const std::map<std::string, RegYMM> names = build_name_map<RegYMM>(RegisterKind::Ymm);
+  return names;
 }
@@ -9,19 +9,31 @@
 #include "avx_core.h" // For m256i_t
 #include "register_enums.h"
 
+// Slot in the 64-bit register block backing each 32-bit register name.
+constexpr Reg64 kReg32Slots[NUM_REG32] = {
+    RAX, RBX, RCX, RDX, RSI, RDI, RBP, RSP,
+    RFLAGS
+};
+
 class RegisterMap {
 private:
-  std::map<std::string, Reg64> register_name_map_64_;
-  std::map<std::string, Reg32> register_name_map_32_;
-  std::map<std::string, Reg64> register_name_map_16_;
-  std::map<std::string, Reg64> register_name_map_8_;
-  std::map<std::string, RegYMM> register_name_map_ymm_;
-  std::vector<uint64_t> registers64_; 
-  std::vector<m256i_t> registers_ymm_; // YMM registers
-  std::vector<uint16_t> RegSeg_;
+  // All architectural state lives in one contiguous, cache-line-aligned block so
+  // that the hot execution paths touch as few lines as possible.
+  struct alignas(64) RegisterFile {
+    uint64_t gpr[NUM_REG64];   // Includes RIP and RFLAGS.
+    uint16_t seg[NUM_REG_SEG];
+    m256i_t ymm[NUM_REG_YMM];
+  };
+  RegisterFile file_;
+
 public:
   explicit RegisterMap();
   const std::map<std::string, RegYMM>& getRegisterNameMapYmm() const;
+  const std::map<std::string, Reg64>& getRegisterNameMap64() const;
+  const std::map<std::string, Reg32>& getRegisterNameMap32() const;
+
+  // String-keyed access for the UI and tests. Names are resolved through a
+  // compile-time perfect-hash table; unknown names throw std::out_of_range.
   uint64_t get64(const std::string& reg_name) const;
   void set64(const std::string& reg_name, uint64_t value);
   uint64_t get32(const std::string& reg_name) const;
@@ -32,8 +44,28 @@ public:
   void set8(const std::string& reg_name, uint8_t value);
   m256i_t getYmm(const std::string& reg_name) const;
   void setYmm(const std::string& reg_name, m256i_t value);
-  const std::map<std::string, Reg64>& getRegisterNameMap64() const;
-  const std::map<std::string, Reg32>& getRegisterNameMap32() const;
+
+  // Enum-indexed access for the execution paths (no name lookup).
+  uint64_t get64(Reg64 reg) const { return file_.gpr[reg]; }
+  void set64(Reg64 reg, uint64_t value) { file_.gpr[reg] = value; }
+  uint32_t get32(Reg32 reg) const { return static_cast<uint32_t>(file_.gpr[kReg32Slots[reg]]); }
+  // 32-bit writes zero-extend into the full 64-bit register.
+  void set32(Reg32 reg, uint32_t value) { file_.gpr[kReg32Slots[reg]] = value; }
+  uint16_t get16(Reg64 reg) const { return static_cast<uint16_t>(file_.gpr[reg]); }
+  // 16- and 8-bit writes merge into the low bits and preserve the rest.
+  void set16(Reg64 reg, uint16_t value) { file_.gpr[reg] = (file_.gpr[reg] & ~0xFFFFULL) | value; }
+  uint8_t get8(Reg64 reg) const { return static_cast<uint8_t>(file_.gpr[reg]); }
+  void set8(Reg64 reg, uint8_t value) { file_.gpr[reg] = (file_.gpr[reg] & ~0xFFULL) | value; }
+  // Legacy high-byte registers (ah, bh, ch, dh) live in bits 8..15.
+  uint8_t get8High(Reg64 reg) const { return static_cast<uint8_t>(file_.gpr[reg] >> 8); }
+  void set8High(Reg64 reg, uint8_t value) {
+    file_.gpr[reg] = (file_.gpr[reg] & ~0xFF00ULL) | (static_cast<uint64_t>(value) << 8);
+  }
+  const m256i_t& getYmm(RegYMM reg) const { return file_.ymm[reg]; }
+  m256i_t& getYmm(RegYMM reg) { return file_.ymm[reg]; }
+  void setYmm(RegYMM reg, const m256i_t& value) { file_.ymm[reg] = value; }
+  uint16_t getSeg(RegSeg reg) const { return file_.seg[reg]; }
+  void setSeg(RegSeg reg, uint16_t value) { file_.seg[reg] = value; }
 };
 
 #endif // REGISTER_MAP_H
@@ -1,24 +1,36 @@
 #include "x86_simulator.h"
-bool X86Simulator::get_CF() const { return (rflags_ >> RFLAGS_CF_BIT) & 1; }
+bool X86Simulator::get_CF() const {
+  return lazy_flags_.pending() ? lazy_flags_.cf() : (rflags_ >> RFLAGS_CF_BIT) & 1;
+}
 void X86Simulator::set_CF(bool value) {
+  materialize_flags();
   if (value) rflags_ |= (1ULL << RFLAGS_CF_BIT);
   else rflags_ &= ~(1ULL << RFLAGS_CF_BIT);
 }
 
-bool X86Simulator::get_ZF() const { return (rflags_ >> RFLAGS_ZF_BIT) & 1; }
+bool X86Simulator::get_ZF() const {
+  return lazy_flags_.pending() ? lazy_flags_.zf() : (rflags_ >> RFLAGS_ZF_BIT) & 1;
+}
 void X86Simulator::set_ZF(bool value) {
+  materialize_flags();
   if (value) rflags_ |= (1ULL << RFLAGS_ZF_BIT);
   else rflags_ &= ~(1ULL << RFLAGS_ZF_BIT);
 }
 
-bool X86Simulator::get_SF() const { return (rflags_ >> RFLAGS_SF_BIT) & 1; }
+bool X86Simulator::get_SF() const {
+  return lazy_flags_.pending() ? lazy_flags_.sf() : (rflags_ >> RFLAGS_SF_BIT) & 1;
+}
 void X86Simulator::set_SF(bool value) {
+  materialize_flags();
   if (value) rflags_ |= (1ULL << RFLAGS_SF_BIT);
   else rflags_ &= ~(1ULL << RFLAGS_SF_BIT);
 }
 
-bool X86Simulator::get_OF() const { return (rflags_ >> RFLAGS_OF_BIT) & 1; }
+bool X86Simulator::get_OF() const {
+  return lazy_flags_.pending() ? lazy_flags_.of() : (rflags_ >> RFLAGS_OF_BIT) & 1;
+}
 void X86Simulator::set_OF(bool value) {
+  materialize_flags();
   if (value) rflags_ |= (1ULL << RFLAGS_OF_BIT);
   else rflags_ &= ~(1ULL << RFLAGS_OF_BIT);
 }
@@ -29,18 +41,37 @@ void X86Simulator::set_DF(bool value) {
   else rflags_ &= ~(1ULL << RFLAGS_DF_BIT);
 }
 
-bool X86Simulator::get_AF() const { return (rflags_ >> RFLAGS_AF_BIT) & 1; }
+bool X86Simulator::get_AF() const {
+  return lazy_flags_.pending() ? lazy_flags_.af() : (rflags_ >> RFLAGS_AF_BIT) & 1;
+}
 void X86Simulator::set_AF(bool value) {
+  materialize_flags();
   if (value) rflags_ |= (1ULL << RFLAGS_AF_BIT);
   else rflags_ &= ~(1ULL << RFLAGS_AF_BIT);
 }
 
-bool X86Simulator::get_PF() const { return (rflags_ >> RFLAGS_PF_BIT) & 1; }
+bool X86Simulator::get_PF() const {
+  return lazy_flags_.pending() ? lazy_flags_.pf() : (rflags_ >> RFLAGS_PF_BIT) & 1;
+}
 void X86Simulator::set_PF(bool value) {
+  materialize_flags();
   if (value) rflags_ |= (1ULL << RFLAGS_PF_BIT);
   else rflags_ &= ~(1ULL << RFLAGS_PF_BIT);
 }
 
+void X86Simulator::record_flags_preserving_carry(FlagOp op, uint32_t size, uint64_t dest, uint64_t result) {
+    lazy_flags_.record_preserving_carry(op, size, dest, result, get_CF());
+}
+
+// Folds any pending lazy flags into rflags_ so that it can be read or modified bit by bit.
+void X86Simulator::materialize_flags() {
+    if (lazy_flags_.pending()) {
+        rflags_ = lazy_flags_.materialize(rflags_);
+        lazy_flags_.clear();
+    }
+}
+
 void X86Simulator::update_rflags_in_register_map() {
-    register_map_.set64("rflags", rflags_);
+    materialize_flags();
+    register_map_.set64(RFLAGS, rflags_);
 }
@@ -70,9 +70,32 @@ void SystemBus::create_and_configure_simulator(const json& process_info, bool ui
     int session_id = db_manager_.createSession(program_path);
     auto memory = std::make_unique<Memory>();
     auto simulator = std::make_unique<X86Simulator>(db_manager_, *memory, session_id, !ui_enabled);
-    simulator->loadProgram(program_path);
-    simulator->firstPass();
-    simulator->secondPass();
+    std::string execution_mode = process_info.value("execution_mode", "single_step");
+    if (execution_mode == "block") {
+        simulator->set_execution_mode(ExecutionMode::Block);
+    } else if (execution_mode == "jit" && JitCompiler::is_supported()) {
+        simulator->set_execution_mode(ExecutionMode::Jit);
+        simulator->set_jit_threshold(process_info.value("jit_threshold", kDefaultHotThreshold));
+    } else if (execution_mode == "tiered") {
+        simulator->set_execution_mode(ExecutionMode::Tiered);
+    }
+    if (process_info.contains("tiering")) {
+        // Keys left out keep the current policy, including jit_threshold.
+        const json& tiering = process_info["tiering"];
+        TieringPolicy policy = simulator->get_tiering_policy();
+        policy.warm_threshold = tiering.value("warm_threshold", policy.warm_threshold);
+        policy.hot_threshold = tiering.value("hot_threshold", policy.hot_threshold);
+        policy.jit_enabled = tiering.value("jit", policy.jit_enabled);
+        simulator->set_tiering_policy(policy);
+    }
+    if (process_info.value("aot", false)) {
+        simulator->set_aot_translation(true, process_info.value("aot_threads", size_t{0}));
+    }
+    simulator->set_program_cache(process_info.value("program_cache", false));
+    simulator->assembleProgram(program_path);
+    if (process_info.contains("native_module")) {
+        simulator->useNativeModule(process_info["native_module"].get<std::string>());
+    }
 	simulator->dumpTextSegment("text_segment.dump");
 	simulator->dumpDataSegment("data_segment.dump");
 	simulator->dumpSymbolTable("symbol_table.dump");
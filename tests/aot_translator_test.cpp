@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+#include "../aot_translator.h"
+#include "../x86_simulator.h"
+#include "mock_database_manager.h"
+#include "test_programs.h"
+#include <atomic>
+
+class AotTranslatorTest : public ::testing::Test {
+protected:
+    MockDatabaseManager dbManager;
+    Memory memory;
+
+    void SetUp() override {
+        load_text_program(memory, kSumLoop);
+    }
+};
+
+TEST(ThreadPoolTest, RunsEveryTaskBeforeWaitReturns) {
+    ThreadPool pool(4);
+    std::atomic<int> sum{0};
+    for (int i = 1; i <= 100; ++i) {
+        pool.submit([&sum, i] { sum += i; });
+    }
+    pool.wait();
+    EXPECT_EQ(sum.load(), 5050);
+    EXPECT_EQ(pool.size(), 4u);
+}
+
+TEST_F(AotTranslatorTest, RecoversBlocksFromBranchTargets) {
+    DecodeCache decode_cache(memory);
+    TranslationCache translation_cache(memory);
+    BlockCache blocks(memory, decode_cache, translation_cache);
+    ThreadPool pool(4);
+
+    // 0x1000 is past the text segment and must be ignored.
+    AotStats stats = translate_ahead_of_time(blocks, memory, {0, 0x1000}, pool);
+    EXPECT_EQ(stats.blocks, 2u);
+    EXPECT_EQ(stats.waves, 2u);
+    EXPECT_EQ(blocks.size(), 2u);
+    ASSERT_NE(blocks.find(0), nullptr);
+    ASSERT_NE(blocks.find(10), nullptr);
+    EXPECT_EQ(decode_cache.get_misses(), 0u);
+
+    // Built blocks match the ones the cache would form lazily.
+    DecodeCache lazy_decode(memory);
+    TranslationCache lazy_translation(memory);
+    BlockCache lazy(memory, lazy_decode, lazy_translation);
+    for (address_t address : {0, 10}) {
+        const BasicBlock* expected = lazy.lookup(address);
+        const BasicBlock* actual = blocks.find(address);
+        ASSERT_EQ(actual->instructions.size(), expected->instructions.size());
+        EXPECT_EQ(actual->end_address, expected->end_address);
+        EXPECT_EQ(actual->taken_target, expected->taken_target);
+        for (size_t i = 0; i < expected->instructions.size(); ++i) {
+            EXPECT_EQ(actual->instructions[i].opcode, expected->instructions[i].opcode);
+            EXPECT_EQ(actual->instructions[i].handler, expected->instructions[i].handler);
+        }
+    }
+    EXPECT_EQ(blocks.passes().get_stats(IRPass::ConstantFolding).blocks, 2u);
+
+    // A second run finds nothing new.
+    EXPECT_EQ(translate_ahead_of_time(blocks, memory, {0}, pool).blocks, 0u);
+}
+
+TEST_F(AotTranslatorTest, SkipsUntranslatableLeaders) {
+    // 0: jmp 3; 2: inc (0x40, decoded without operands); 3: nop
+    load_text_program(memory, {0xeb, 0x01, 0x40, 0x90});
+    DecodeCache decode_cache(memory);
+    TranslationCache translation_cache(memory);
+    BlockCache blocks(memory, decode_cache, translation_cache);
+    ThreadPool pool(2);
+
+    EXPECT_NO_THROW(translate_ahead_of_time(blocks, memory, {0, 2}, pool));
+    EXPECT_NE(blocks.find(0), nullptr);
+    EXPECT_EQ(blocks.find(2), nullptr);
+}
+
+TEST_F(AotTranslatorTest, SimulatorRunsWithoutBuildingBlocks) {
+    X86Simulator simulator(dbManager, memory, 1, true);
+    simulator.set_execution_mode(ExecutionMode::Block);
+    simulator.set_aot_translation(true, 2);
+    EXPECT_EQ(simulator.translateAheadOfTime().blocks, 2u);
+    EXPECT_EQ(simulator.get_aot_stats().blocks, 2u);
+
+    simulator.runProgram();
+    EXPECT_EQ(simulator.getRegisterMapForTesting().get32("eax"), 6);
+    EXPECT_EQ(simulator.get_block_cache().size(), 2u);
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "../x86_simulator.h"
+#include "../basic_block.h"
+#include "../memory.h"
+#include "mock_database_manager.h"
+#include "test_programs.h"
+
+class BasicBlockTest : public ::testing::Test {
+protected:
+    MockDatabaseManager dbManager;
+    Memory memory;
+    X86Simulator simulator;
+
+    BasicBlockTest() : memory(), simulator(dbManager, memory, 1, true) {}
+
+    void SetUp() override {
+        load_text_program(memory, kSumLoop);
+    }
+};
+
+TEST_F(BasicBlockTest, BlockEndsAtBranch) {
+    DecodeCache decode_cache(memory);
+    TranslationCache translation_cache(memory);
+    BlockCache blocks(memory, decode_cache, translation_cache);
+    blocks.passes().set_all_enabled(false); // Count the translated instructions as-is.
+
+    const BasicBlock* entry = blocks.lookup(0);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->instructions.size(), 6);
+    EXPECT_EQ(entry->end_address, kSumLoop.size());
+    EXPECT_TRUE(entry->ends_with_terminator);
+    EXPECT_EQ(entry->instructions.back().opcode, IROpcode::Branch);
+
+    const BasicBlock* loop = blocks.lookup(10);
+    ASSERT_NE(loop, nullptr);
+    EXPECT_EQ(loop->instructions.size(), 4);
+    EXPECT_EQ(blocks.lookup(10), loop);
+}
+
+TEST_F(BasicBlockTest, TextWriteDropsOverlappingBlocks) {
+    DecodeCache decode_cache(memory);
+    TranslationCache translation_cache(memory);
+    BlockCache blocks(memory, decode_cache, translation_cache);
+    ASSERT_NE(blocks.lookup(0), nullptr);
+    ASSERT_NE(blocks.lookup(10), nullptr);
+
+    memory.write_text(13, 0x02); // mov ebx, 2
+    EXPECT_EQ(blocks.size(), 0);
+}
+
+TEST_F(BasicBlockTest, BlockModeMatchesSingleStep) {
+    simulator.set_execution_mode(ExecutionMode::Block);
+    simulator.runProgram();
+
+    auto& regs = simulator.getRegisterMapForTesting();
+    EXPECT_EQ(regs.get32("eax"), 6);
+    EXPECT_EQ(regs.get32("ecx"), 0);
+    EXPECT_EQ(regs.get64("rip"), kSumLoop.size());
+    EXPECT_TRUE(simulator.get_ZF());
+    EXPECT_TRUE((regs.get64("rflags") >> RFLAGS_ZF_BIT) & 1); // written back at block exit
+}
+
+TEST_F(BasicBlockTest, SingleStepRunsSameLoop) {
+    simulator.runProgram();
+
+    auto& regs = simulator.getRegisterMapForTesting();
+    EXPECT_EQ(regs.get32("eax"), 6);
+    EXPECT_EQ(regs.get32("ecx"), 0);
+    EXPECT_TRUE(simulator.get_ZF());
+}
+
+TEST_F(BasicBlockTest, SuccessorsAreChainedAfterFirstTraversal) {
+    DecodeCache decode_cache(memory);
+    TranslationCache translation_cache(memory);
+    BlockCache blocks(memory, decode_cache, translation_cache);
+
+    BasicBlock* entry = blocks.lookup(0);
+    ASSERT_NE(entry, nullptr);
+    BasicBlock* loop = blocks.successor(*entry, 10);
+    ASSERT_NE(loop, nullptr);
+    EXPECT_EQ(entry->taken_successor, loop);
+
+    EXPECT_EQ(blocks.successor(*loop, 10), loop);
+    EXPECT_EQ(blocks.get_chained_transitions(), 0);
+    EXPECT_EQ(blocks.successor(*loop, 10), loop);
+    EXPECT_EQ(blocks.get_chained_transitions(), 1);
+    EXPECT_EQ(loop->predecessors.size(), 2);
+}
+
+TEST_F(BasicBlockTest, InvalidationUnlinksChains) {
+    DecodeCache decode_cache(memory);
+    TranslationCache translation_cache(memory);
+    BlockCache blocks(memory, decode_cache, translation_cache);
+
+    BasicBlock* entry = blocks.lookup(0);
+    BasicBlock* loop = blocks.successor(*entry, 10);
+    ASSERT_NE(loop, nullptr);
+
+    memory.write_text(1, 0x01); // mov eax, 1 (only the entry block covers it)
+    EXPECT_FALSE(entry->valid);
+    EXPECT_EQ(entry->taken_successor, nullptr);
+    EXPECT_TRUE(loop->predecessors.empty());
+    EXPECT_EQ(blocks.lookup(10), loop);
+}
+
+static uint64_t fake_native_code(JitState*) { return 0; }
+
+TEST_F(BasicBlockTest, DroppingJitCodeKeepsModuleCode) {
+    DecodeCache decode_cache(memory);
+    TranslationCache translation_cache(memory);
+    BlockCache blocks(memory, decode_cache, translation_cache);
+    BasicBlock* entry = blocks.lookup(0);
+    BasicBlock* loop = blocks.lookup(10);
+    ASSERT_NE(entry, nullptr);
+    ASSERT_NE(loop, nullptr);
+    entry->native_code = fake_native_code;
+    entry->native_code_owner = NativeCodeOwner::Module;
+    loop->native_code = fake_native_code;
+    loop->native_code_owner = NativeCodeOwner::Jit;
+    loop->execution_count = 100;
+
+    EXPECT_EQ(blocks.drop_native_code(NativeCodeOwner::Jit), 1u);
+    EXPECT_EQ(loop->native_code, nullptr);
+    EXPECT_EQ(loop->execution_count, 0u);
+    EXPECT_EQ(entry->native_code, fake_native_code);
+
+    EXPECT_EQ(blocks.drop_native_code(NativeCodeOwner::Module), 1u);
+    EXPECT_EQ(entry->native_code, nullptr);
+    EXPECT_EQ(entry->native_code_owner, NativeCodeOwner::None);
+}
+
+TEST(BlockChainingTest, ReturnStackPredictsCallReturnPairs) {
+    //  0: mov eax, 0
+    //  5: mov ecx, 1
+    // 10: call 30
+    // 15: call 30
+    // 20: jmp 33 (end of text)
+    // 25: nop x5
+    // 30: add eax, ecx
+    // 32: ret
+    const std::vector<uint8_t> program = {
+        0xb8, 0x00, 0x00, 0x00, 0x00,
+        0xb9, 0x01, 0x00, 0x00, 0x00,
+        0xe8, 0x0f, 0x00, 0x00, 0x00,
+        0xe8, 0x0a, 0x00, 0x00, 0x00,
+        0xe9, 0x08, 0x00, 0x00, 0x00,
+        0x90, 0x90, 0x90, 0x90, 0x90,
+        0x01, 0xc8,
+        0xc3,
+    };
+    MockDatabaseManager dbManager;
+    Memory memory;
+    for (size_t i = 0; i < program.size(); ++i) {
+        memory.write_text(i, program[i]);
+    }
+    memory.set_text_segment_size(program.size());
+    X86Simulator simulator(dbManager, memory, 1, true);
+
+    simulator.set_execution_mode(ExecutionMode::Block);
+    simulator.runProgram();
+
+    EXPECT_EQ(simulator.getRegisterMapForTesting().get32("eax"), 2);
+    EXPECT_EQ(simulator.getRegisterMapForTesting().get64("rsp"), memory.get_stack_bottom());
+    EXPECT_EQ(simulator.get_block_cache().get_return_hits(), 2);
+    EXPECT_EQ(simulator.get_block_cache().get_return_misses(), 0);
+}
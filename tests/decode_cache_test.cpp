@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "../decode_cache.h"
+#include "../memory.h"
+
+class DecodeCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // mov eax, 5
+        mem.write_text(0, 0xb8);
+        mem.write_text_dword(1, 5);
+        // nop
+        mem.write_text(5, 0x90);
+        mem.set_text_segment_size(6);
+    }
+
+    Memory mem;
+};
+
+TEST_F(DecodeCacheTest, ReturnsSameEntryOnRepeatedLookup) {
+    DecodeCache cache(mem);
+
+    const CompactDecodedInstruction* first = cache.lookup(0);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->mnemonic, Mnemonic::Mov);
+    EXPECT_EQ(first->length_in_bytes, 5);
+
+    EXPECT_EQ(cache.lookup(0), first);
+    EXPECT_EQ(cache.get_misses(), 1);
+    EXPECT_EQ(cache.get_hits(), 1);
+}
+
+TEST_F(DecodeCacheTest, TextWriteInvalidatesCoveringInstruction) {
+    DecodeCache cache(mem);
+    ASSERT_NE(cache.lookup(0), nullptr);
+    ASSERT_NE(cache.lookup(5), nullptr);
+
+    // Patch the immediate of the mov; the cached decode must be refreshed.
+    mem.write_text(1, 7);
+
+    const CompactDecodedInstruction* mov = cache.lookup(0);
+    ASSERT_NE(mov, nullptr);
+    ASSERT_EQ(mov->operand_count, 2);
+    EXPECT_EQ(mov->operands[1].value, 7);
+
+    // The nop lies past the written byte and stays cached.
+    cache.lookup(5);
+    EXPECT_EQ(cache.get_misses(), 3);
+    EXPECT_EQ(cache.get_hits(), 1);
+}
+
+TEST_F(DecodeCacheTest, ResetDropsAllEntries) {
+    DecodeCache cache(mem);
+    ASSERT_NE(cache.lookup(5), nullptr);
+
+    mem.reset();
+    mem.write_text(5, 0x90);
+    cache.lookup(5);
+    EXPECT_EQ(cache.get_hits(), 0);
+    EXPECT_EQ(cache.get_misses(), 2);
+}
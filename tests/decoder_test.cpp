@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 #include "../decoder.h"
+#include "../instruction_formatter.h"
 #include "../memory.h"
+#include <thread>
 #include <vector>
 
 // Test fixture for Decoder tests
@@ -10,12 +12,7 @@ protected:
         // Set up any necessary objects or state
     }
 
-    void TearDown() override {
-        // Reset the singleton to ensure no state leaks between test suites.
-        decoder.resetInstance();
-    }
-
-    Decoder& decoder = Decoder::getInstance();
+    Decoder decoder;
 };
 
 
@@ -344,4 +341,117 @@ TEST_F(DecoderTest, DecodeJgeRel8Instruction) {
     ASSERT_EQ(decoded_instruction->operands.size(), 1);
     EXPECT_EQ(decoded_instruction->operands[0].type, OperandType::IMMEDIATE);
     EXPECT_EQ(decoded_instruction->operands[0].value, target_address);
-}
\ No newline at end of file
+}
+TEST_F(DecoderTest, DecodeTableDrivenForms) {
+    Memory memory(1024, 1024, 1024);
+    // mov edx, 7 / shl ebx, 3 / ja rel32 +0x10 / group F7 with no known /1 member
+    std::vector<uint8_t> instruction_bytes = {
+        0xBA, 0x07, 0x00, 0x00, 0x00,
+        0xC1, 0xE3, 0x03,
+        0x0F, 0x87, 0x10, 0x00, 0x00, 0x00,
+        0xF7, 0xC8,
+    };
+    for (size_t i = 0; i < instruction_bytes.size(); ++i) {
+        memory.write_text(i, instruction_bytes[i]);
+    }
+
+    auto mov = decoder.decodeInstruction(memory, 0);
+    ASSERT_NE(mov, nullptr);
+    EXPECT_EQ(mov->mnemonic, "mov");
+    ASSERT_EQ(mov->operands.size(), 2);
+    EXPECT_EQ(mov->operands[0].text, "edx");
+    EXPECT_EQ(mov->operands[1].value, 7u);
+
+    auto shl = decoder.decodeInstruction(memory, 5);
+    ASSERT_NE(shl, nullptr);
+    EXPECT_EQ(shl->mnemonic, "shl");
+    EXPECT_EQ(shl->length_in_bytes, 3);
+    EXPECT_EQ(shl->operands[0].text, "ebx");
+    EXPECT_EQ(shl->operands[1].text, "0x3");
+
+    auto ja = decoder.decodeInstruction(memory, 8);
+    ASSERT_NE(ja, nullptr);
+    EXPECT_EQ(ja->mnemonic, "ja");
+    EXPECT_EQ(ja->length_in_bytes, 6);
+    EXPECT_EQ(ja->operands[0].value, 8u + 6 + 0x10);
+
+    auto group = decoder.decodeInstruction(memory, 14);
+    ASSERT_NE(group, nullptr);
+    EXPECT_EQ(group->mnemonic, "group_f7");
+    EXPECT_EQ(decoder.getMnemonic(0xC1), "GROUP_C1");
+    EXPECT_EQ(std::string(mnemonic_name(Mnemonic::Vaddps)), "vaddps");
+}
+
+TEST_F(DecoderTest, DecodeFillsCompactFormAndFormatsOnDemand) {
+    Memory memory(1024, 1024, 1024);
+    // mov ecx, 0x1234 / lea eax, [ebx] / in al, 0x60
+    std::vector<uint8_t> instruction_bytes = {0xB9, 0x34, 0x12, 0x00, 0x00, 0x8D, 0x03, 0xE4, 0x60};
+    for (size_t i = 0; i < instruction_bytes.size(); ++i) {
+        memory.write_text(i, instruction_bytes[i]);
+    }
+
+    CompactDecodedInstruction mov;
+    ASSERT_TRUE(decoder.decode(memory, 0, mov));
+    EXPECT_EQ(mov.mnemonic, Mnemonic::Mov);
+    EXPECT_EQ(mov.length_in_bytes, 5);
+    ASSERT_EQ(mov.operand_count, 2);
+    EXPECT_EQ(mov.operands[0].type, OperandType::REGISTER);
+    EXPECT_EQ(mov.operands[0].reg, 1);
+    EXPECT_EQ(mov.operands[1].value, 0x1234u);
+
+    DecodedInstruction text = format_instruction(mov);
+    EXPECT_EQ(text.mnemonic, "mov");
+    ASSERT_EQ(text.operands.size(), 2u);
+    EXPECT_EQ(text.operands[0].text, "ecx");
+    EXPECT_EQ(text.operands[1].text, "0x1234");
+
+    CompactDecodedInstruction lea;
+    ASSERT_TRUE(decoder.decode(memory, 5, lea));
+    EXPECT_EQ(format_operand_text(lea.operands[1]), "[ebx]");
+
+    CompactDecodedInstruction in;
+    ASSERT_TRUE(decoder.decode(memory, 7, in));
+    EXPECT_EQ(format_instruction(in).operands[0].text, "al");
+
+    EXPECT_FALSE(decoder.decode(memory, memory.get_data_segment_start(), in));
+}
+
+TEST(DecoderConcurrencyTest, ThreadsDecodeSeparateImagesWithoutSharedState) {
+    // mov ecx, imm; add eax, ecx; nop; jne -11, each thread with its own image.
+    const std::vector<uint8_t> pattern = {0xb9, 0x00, 0x00, 0x00, 0x00, 0x01, 0xc8, 0x90, 0x75, 0xf5};
+    const size_t repeats = 2000;
+    std::vector<std::unique_ptr<Memory>> images;
+    for (uint8_t id = 0; id < 4; ++id) {
+        auto memory = std::make_unique<Memory>();
+        for (size_t i = 0; i < repeats * pattern.size(); ++i) {
+            memory->write_text(i, i % pattern.size() == 1 ? id : pattern[i % pattern.size()]);
+        }
+        memory->set_text_segment_size(repeats * pattern.size());
+        images.push_back(std::move(memory));
+    }
+
+    std::vector<size_t> mismatches(images.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t id = 0; id < images.size(); ++id) {
+        threads.emplace_back([&, id] {
+            CompactDecodedInstruction instr;
+            address_t address = 0;
+            while (address < images[id]->get_text_segment_size()) {
+                if (!Decoder::decode(*images[id], address, instr) || instr.length_in_bytes == 0) {
+                    ++mismatches[id];
+                    break;
+                }
+                if (instr.mnemonic == Mnemonic::Mov && instr.operands[1].value != id) {
+                    ++mismatches[id];
+                }
+                address += instr.length_in_bytes;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t id = 0; id < images.size(); ++id) {
+        EXPECT_EQ(mismatches[id], 0u) << id;
+    }
+}
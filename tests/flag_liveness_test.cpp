@@ -0,0 +1,54 @@
+#include "gtest/gtest.h"
+#include "../flag_liveness.h"
+#include "../x86_simulator.h"
+#include "mock_database_manager.h"
+
+namespace {
+
+IRRegister gpr32(uint32_t index) { return IRRegister{IRRegisterType::GPR, index, 32}; }
+
+} // namespace
+
+TEST(FlagLivenessTest, OverwrittenFlagWritesAreDead) {
+    std::vector<IRInstruction> block = {
+        IRInstruction(IROpcode::Add, {gpr32(0), gpr32(1)}),
+        IRInstruction(IROpcode::Move, {gpr32(2), uint64_t{4}}),
+        IRInstruction(IROpcode::Sub, {gpr32(0), uint64_t{1}}),
+        IRInstruction(IROpcode::Cmp, {gpr32(0), gpr32(2)}),
+        IRInstruction(IROpcode::Branch, {uint64_t{0x10}, IRConditionCode::NotEqual}),
+    };
+
+    EXPECT_EQ(analyze_flag_liveness(block), 2u);
+    EXPECT_FALSE(block[0].flags_live);
+    EXPECT_FALSE(block[2].flags_live);
+    EXPECT_TRUE(block[3].flags_live);
+}
+
+TEST(FlagLivenessTest, FlagsAreLiveAtBlockExitAndBeforeReaders) {
+    std::vector<IRInstruction> block = {
+        IRInstruction(IROpcode::Add, {gpr32(0), gpr32(1)}),
+        IRInstruction(IROpcode::Shl, {gpr32(0), uint64_t{1}}), // Not modelled, so treated as a reader
+        IRInstruction(IROpcode::Xor, {gpr32(1), gpr32(1)}),
+    };
+
+    EXPECT_EQ(analyze_flag_liveness(block), 0u);
+    EXPECT_TRUE(block[0].flags_live);
+    EXPECT_TRUE(block[2].flags_live);
+}
+
+TEST(FlagLivenessTest, DeadFlagWritesStillUpdateRegisters) {
+    MockDatabaseManager dbManager;
+    Memory memory;
+    X86Simulator simulator(dbManager, memory, 1, true);
+    auto& regs = simulator.getRegisterMapForTesting();
+    regs.set32("eax", 0);
+    regs.set32("ecx", 1);
+
+    simulator.set_ZF(true);
+    IRInstruction add(IROpcode::Add, {gpr32(0), gpr32(1)});
+    add.flags_live = false;
+    simulator.execute_ir_instruction(add);
+
+    EXPECT_EQ(regs.get32("eax"), 1u);
+    EXPECT_TRUE(simulator.get_ZF()); // Flags untouched
+}
@@ -10,7 +10,7 @@ protected:
     }
 
     RegisterMap regs;
-    Decoder& decoder = Decoder::getInstance();
+    Decoder decoder;
     Memory memory{1024, 1024, 1024};
 };
 
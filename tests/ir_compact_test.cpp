@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "../ir_compact.h"
+#include "../ir_dispatch.h"
+#include <cstring>
+
+namespace {
+
+IRRegister gpr32(uint32_t index, int32_t slot = -1) {
+    IRRegister reg{IRRegisterType::GPR, index, 32};
+    reg.slot = slot;
+    return reg;
+}
+
+} // namespace
+
+TEST(IRCompactTest, RoundTripsEveryOperandKind) {
+    IRLabelTable labels;
+    IRMemoryOperand mem;
+    mem.base_reg = IRRegister{IRRegisterType::GPR, 5, 64};
+    mem.index_reg = gpr32(1, 2);
+    mem.scale = 4;
+    mem.displacement = -16;
+    mem.size = 32;
+
+    IRInstruction original(IROpcode::CmpBranch,
+                           {uint64_t{0x1122334455667788ULL}, IRConditionCode::Less, gpr32(3, 1), mem});
+    original.original_address = 0x401000;
+    original.original_size = 9;
+    original.flags_live = false;
+    ASSERT_TRUE(bind_ir_handler(original));
+
+    CompactIRInstruction compact;
+    ASSERT_TRUE(encode_ir(original, compact, labels));
+    IRInstruction decoded = decode_ir(compact, labels);
+
+    EXPECT_EQ(decoded.opcode, IROpcode::CmpBranch);
+    EXPECT_EQ(decoded.original_address, 0x401000u);
+    EXPECT_EQ(decoded.original_size, 9u);
+    EXPECT_FALSE(decoded.flags_live);
+    EXPECT_EQ(decoded.handler, original.handler);
+    ASSERT_EQ(decoded.operands.size(), 4u);
+    EXPECT_EQ(std::get<uint64_t>(decoded.operands[0]), 0x1122334455667788ULL);
+    EXPECT_EQ(std::get<IRConditionCode>(decoded.operands[1]), IRConditionCode::Less);
+    EXPECT_EQ(std::get<IRRegister>(decoded.operands[2]), gpr32(3));
+    EXPECT_EQ(std::get<IRRegister>(decoded.operands[2]).slot, 1);
+
+    const auto& decoded_mem = std::get<IRMemoryOperand>(decoded.operands[3]);
+    EXPECT_EQ(*decoded_mem.base_reg, *mem.base_reg);
+    EXPECT_EQ(decoded_mem.index_reg->slot, 2);
+    EXPECT_EQ(decoded_mem.scale, 4u);
+    EXPECT_EQ(decoded_mem.displacement, -16);
+    EXPECT_EQ(decoded_mem.size, 32u);
+}
+
+TEST(IRCompactTest, InternsLabels) {
+    IRLabelTable labels;
+    CompactIRInstruction first, second;
+    ASSERT_TRUE(encode_ir(IRInstruction(IROpcode::Jump, {std::string("loop")}), first, labels));
+    ASSERT_TRUE(encode_ir(IRInstruction(IROpcode::Jump, {std::string("loop")}), second, labels));
+
+    EXPECT_EQ(labels.size(), 1u);
+    EXPECT_EQ(first.operands[0].label, second.operands[0].label);
+    EXPECT_EQ(std::get<std::string>(decode_ir(first, labels).operands[0]), "loop");
+}
+
+TEST(IRCompactTest, RejectsInstructionsWithoutCompactForm) {
+    IRLabelTable labels;
+    CompactIRInstruction compact;
+    IRMemoryOperand far;
+    far.displacement = int64_t{1} << 40;
+    EXPECT_FALSE(encode_ir(IRInstruction(IROpcode::Load, {gpr32(0), far}), compact, labels));
+    EXPECT_FALSE(encode_ir(IRInstruction(IROpcode::Nop, {uint64_t{1}, uint64_t{2}, uint64_t{3}, uint64_t{4}, uint64_t{5}}),
+                           compact, labels));
+}
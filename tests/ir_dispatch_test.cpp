@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "../ir_dispatch.h"
+#include "../ir_executor_helpers.h"
+#include "../ir_scalar_handlers.h"
+#include "../x86_simulator.h"
+#include "../x86_to_ir.h"
+#include "mock_database_manager.h"
+#include "test_programs.h"
+
+namespace {
+
+IRRegister gpr32(uint32_t index) { return IRRegister{IRRegisterType::GPR, index, 32}; }
+
+} // namespace
+
+TEST(IRDispatchTest, SelectsHandlerForWellFormedInstructions) {
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Add, {gpr32(0), gpr32(1)})),
+              (&handle_ir_scalar<IRAddOp, 32, IRRegisterAccess, IRRegisterAccess>));
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Add, {gpr32(0), uint64_t{1}})),
+              (&handle_ir_scalar<IRAddOp, 32, IRRegisterAccess, IRImmediateAccess>));
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Jump, {uint64_t{0x10}})), &handle_ir_jump);
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Ret)), &handle_ir_ret);
+}
+
+TEST(IRDispatchTest, RejectsMalformedInstructions) {
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Add, {gpr32(0)})), nullptr);
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Add, {uint64_t{1}, gpr32(0)})), nullptr);
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Jump, {gpr32(0)})), nullptr);
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Branch, {uint64_t{0x10}, uint64_t{0}})), nullptr);
+    EXPECT_EQ(select_ir_handler(IRInstruction(IROpcode::Nop)), nullptr);
+
+    IRInstruction instr(IROpcode::Sub, {gpr32(0), IRRegister{IRRegisterType::GPR, 1, 128}});
+    EXPECT_FALSE(bind_ir_handler(instr));
+    EXPECT_EQ(instr.handler, nullptr);
+}
+
+TEST(IRDispatchTest, TranslationBindsHandler) {
+    DecodedInstruction decoded;
+    decoded.mnemonic = "jmp";
+    decoded.address = 0x1000;
+    decoded.length_in_bytes = 2;
+    DecodedOperand target;
+    target.value = 0x1010;
+    decoded.operands.push_back(target);
+
+    auto ir_instr = translate_to_ir(decoded);
+    ASSERT_NE(ir_instr, nullptr);
+    EXPECT_EQ(ir_instr->handler, &handle_ir_jump);
+}
+
+TEST(IRDispatchTest, MalformedInstructionIsNotExecuted) {
+    MockDatabaseManager dbManager;
+    Memory memory;
+    X86Simulator simulator(dbManager, memory, 1, true);
+    auto& regs = simulator.getRegisterMapForTesting();
+    regs.set64("rip", 0x100);
+
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Jump, {gpr32(0)}));
+    EXPECT_EQ(regs.get64("rip"), 0x100u);
+}
+
+TEST(IRDispatchTest, OperandlessOrMemoryDestinationDecodesAreNotTranslated) {
+    CompactDecodedInstruction inc;
+    inc.mnemonic = Mnemonic::Inc; // 0x40 decodes with no operands
+    inc.length_in_bytes = 1;
+    EXPECT_EQ(translate_to_ir(inc), nullptr);
+
+    CompactDecodedInstruction add;
+    add.mnemonic = Mnemonic::Add;
+    CompactOperand memory_dest;
+    memory_dest.type = OperandType::MEMORY;
+    memory_dest.value = 0x200000;
+    add.add_operand(memory_dest);
+    CompactOperand source;
+    source.type = OperandType::IMMEDIATE;
+    source.value = 1;
+    add.add_operand(source);
+    EXPECT_EQ(translate_to_ir(add), nullptr);
+
+    CompactDecodedInstruction jmp;
+    jmp.mnemonic = Mnemonic::Jmp;
+    EXPECT_EQ(translate_to_ir(jmp), nullptr);
+}
+
+TEST(IRDispatchTest, OperandlessIncDoesNotAbortExecution) {
+    // mov ebx, 1; inc (0x40, decoded without operands)
+    const std::vector<uint8_t> program = {0xbb, 0x01, 0x00, 0x00, 0x00, 0x40};
+    for (ExecutionMode mode : {ExecutionMode::SingleStep, ExecutionMode::Block}) {
+        MockDatabaseManager dbManager;
+        Memory memory;
+        load_text_program(memory, program);
+        X86Simulator simulator(dbManager, memory, 1, true);
+        simulator.set_execution_mode(mode);
+        // The untranslatable inc is reported and left in place, not executed.
+        for (int step = 0; step < 3; ++step) {
+            if (mode == ExecutionMode::SingleStep) {
+                EXPECT_NO_THROW(simulator.runSingleInstruction());
+            } else {
+                EXPECT_NO_THROW(simulator.runBlock());
+            }
+        }
+        EXPECT_EQ(simulator.getRegisterMapForTesting().get32("ebx"), 1u);
+        EXPECT_EQ(simulator.getRegisterMapForTesting().get64("rip"), memory.get_text_segment_start() + 5);
+    }
+}
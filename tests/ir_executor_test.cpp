@@ -114,3 +114,92 @@ TEST_F(IRExecutorTest, HandleIrSar) {
     EXPECT_EQ(regs.get32("eax"), 0b11100000000000000000000000000010);
     EXPECT_TRUE(simulator.get_CF()); // Last bit shifted out was 1
 }
+
+TEST_F(IRExecutorTest, ArchitectureResolvesRegisterSlots) {
+    const auto& arch = simulator.get_architecture();
+
+    EXPECT_EQ(arch.get_register_slot({IRRegisterType::GPR, 0, 32}), RAX);
+    EXPECT_EQ(arch.get_register_slot({IRRegisterType::GPR, 1, 16}), RCX);
+    EXPECT_EQ(arch.get_register_slot({IRRegisterType::GPR, 3, 8}), RBX);
+    EXPECT_EQ(arch.get_register_slot({IRRegisterType::GPR, 4, 64}), RSP);
+    EXPECT_EQ(arch.get_register_slot({IRRegisterType::IP, 0, 64}), RIP);
+    EXPECT_EQ(arch.get_register_slot({IRRegisterType::VECTOR, 1, 256}), YMM1);
+    EXPECT_EQ(arch.get_register_slot({IRRegisterType::GPR, 9, 64}), -1);
+}
+
+TEST_F(IRExecutorTest, ResolvedSlotsMatchNamedAccess) {
+    auto& regs = simulator.getRegisterMapForTesting();
+    regs.set64("rax", 0xFFFFFFFFFFFFFFFF);
+    regs.set64("rbx", 0x1122334455667788);
+
+    IRRegister ax{IRRegisterType::GPR, 0, 16, RAX};
+    IRRegister ebx{IRRegisterType::GPR, 3, 32, RBX};
+
+    // 16-bit writes merge into the low bits.
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Move, {ax, (uint64_t)0x1234}));
+    EXPECT_EQ(regs.get64("rax"), 0xFFFFFFFFFFFF1234);
+
+    // 32-bit writes zero-extend.
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Add, {ebx, (uint64_t)1}));
+    EXPECT_EQ(regs.get64("rbx"), 0x55667789);
+}
+
+TEST_F(IRExecutorTest, BranchEvaluatesSignedConditions) {
+    auto& regs = simulator.getRegisterMapForTesting();
+    regs.set32("eax", 0xFFFFFFFF); // -1
+    regs.set32("ebx", 1);
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Cmp, {
+        IRRegister{IRRegisterType::GPR, 0, 32}, IRRegister{IRRegisterType::GPR, 3, 32}}));
+
+    regs.set64("rip", 0x100);
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Branch, {(uint64_t)0x200, IRConditionCode::Greater}));
+    EXPECT_EQ(regs.get64("rip"), 0x100u); // -1 > 1 is false
+
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Branch, {(uint64_t)0x200, IRConditionCode::Less}));
+    EXPECT_EQ(regs.get64("rip"), 0x200u);
+
+    regs.set64("rip", 0x100);
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Branch, {(uint64_t)0x300, IRConditionCode::AboveOrEqual}));
+    EXPECT_EQ(regs.get64("rip"), 0x300u); // 0xFFFFFFFF >= 1 unsigned
+}
+
+TEST_F(IRExecutorTest, ScalarOpsHonourOperandWidth) {
+    auto& regs = simulator.getRegisterMapForTesting();
+    regs.set64("rax", 0x11223344556677FFULL);
+
+    // 8-bit add wraps within AL and leaves the rest of RAX alone.
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Add, {
+        IRRegister{IRRegisterType::GPR, 0, 8}, uint64_t{1}}));
+    EXPECT_EQ(regs.get64("rax"), 0x1122334455667700ULL);
+    EXPECT_TRUE(simulator.get_CF());
+    EXPECT_TRUE(simulator.get_ZF());
+
+    // 16-bit sub merges into AX.
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Sub, {
+        IRRegister{IRRegisterType::GPR, 0, 16}, uint64_t{0x7701}}));
+    EXPECT_EQ(regs.get64("rax"), 0x112233445566FFFFULL);
+    EXPECT_TRUE(simulator.get_SF());
+
+    // 64-bit add carries out of bit 63.
+    regs.set64("rax", 0x8000000000000000ULL);
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Add, {
+        IRRegister{IRRegisterType::GPR, 0, 64}, uint64_t{0x8000000000000000ULL}}));
+    EXPECT_EQ(regs.get64("rax"), 0u);
+    EXPECT_TRUE(simulator.get_CF());
+    EXPECT_TRUE(simulator.get_OF());
+}
+
+TEST_F(IRExecutorTest, ShiftByZeroLeavesFlagsUnchanged) {
+    auto& regs = simulator.getRegisterMapForTesting();
+    regs.set32("eax", 0);
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Cmp, {
+        IRRegister{IRRegisterType::GPR, 0, 32}, uint64_t{0}}));
+    ASSERT_TRUE(simulator.get_ZF());
+
+    // The count is masked to five bits, so 32 shifts by zero.
+    regs.set32("eax", 5);
+    simulator.execute_ir_instruction(IRInstruction(IROpcode::Shl, {
+        IRRegister{IRRegisterType::GPR, 0, 32}, uint64_t{32}}));
+    EXPECT_EQ(regs.get32("eax"), 5u);
+    EXPECT_TRUE(simulator.get_ZF());
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "../ir_fusion.h"
+#include "../flag_liveness.h"
+#include "../x86_simulator.h"
+#include "mock_database_manager.h"
+
+namespace {
+
+IRRegister gpr32(uint32_t index) { return IRRegister{IRRegisterType::GPR, index, 32}; }
+
+IRInstruction at(IRInstruction instr, uint64_t address, uint32_t size) {
+    instr.original_address = address;
+    instr.original_size = size;
+    return instr;
+}
+
+} // namespace
+
+TEST(IRFusionTest, FusesCompareBranchAndZeroIdiom) {
+    std::vector<IRInstruction> block = {
+        at(IRInstruction(IROpcode::Xor, {gpr32(0), gpr32(0)}), 0x10, 2),
+        at(IRInstruction(IROpcode::Cmp, {gpr32(1), uint64_t{5}}), 0x12, 3),
+        at(IRInstruction(IROpcode::Branch, {uint64_t{0x40}, IRConditionCode::Less}), 0x15, 6),
+    };
+
+    EXPECT_EQ(fuse_superinstructions(block), 2u);
+    ASSERT_EQ(block.size(), 2u);
+    EXPECT_EQ(block[0].opcode, IROpcode::Zero);
+    EXPECT_EQ(block[1].opcode, IROpcode::CmpBranch);
+    EXPECT_EQ(block[1].original_address, 0x12u);
+    EXPECT_EQ(block[1].original_size, 9u);
+    EXPECT_NE(block[0].handler, nullptr);
+    EXPECT_NE(block[1].handler, nullptr);
+}
+
+TEST(IRFusionTest, FusesDecrementBranchOnZeroFlagOnly) {
+    std::vector<IRInstruction> jnz = {
+        IRInstruction(IROpcode::Dec, {gpr32(1)}),
+        IRInstruction(IROpcode::Branch, {uint64_t{0x40}, IRConditionCode::NotEqual}),
+    };
+    EXPECT_EQ(fuse_superinstructions(jnz), 1u);
+    EXPECT_EQ(jnz.back().opcode, IROpcode::DecBranch);
+
+    // Dec + JL depends on OF, which DecBranch does not evaluate.
+    std::vector<IRInstruction> jl = {
+        IRInstruction(IROpcode::Dec, {gpr32(1)}),
+        IRInstruction(IROpcode::Branch, {uint64_t{0x40}, IRConditionCode::Less}),
+    };
+    EXPECT_EQ(fuse_superinstructions(jl), 0u);
+    EXPECT_EQ(jl.size(), 2u);
+}
+
+TEST(IRFusionTest, IncrementBeforeFusedCompareHasDeadFlags) {
+    // inc ecx; cmp ecx, 10; jne
+    std::vector<IRInstruction> block = {
+        IRInstruction(IROpcode::Inc, {gpr32(1)}),
+        IRInstruction(IROpcode::Cmp, {gpr32(1), uint64_t{10}}),
+        IRInstruction(IROpcode::Branch, {uint64_t{0x40}, IRConditionCode::NotEqual}),
+    };
+    fuse_superinstructions(block);
+    analyze_flag_liveness(block);
+    ASSERT_EQ(block.size(), 2u);
+    EXPECT_FALSE(block[0].flags_live);
+    EXPECT_TRUE(block[1].flags_live);
+}
+
+TEST(IRFusionTest, FusedHandlersMatchUnfusedExecution) {
+    MockDatabaseManager dbManager;
+    Memory memory;
+    X86Simulator simulator(dbManager, memory, 1, true);
+    auto& regs = simulator.getRegisterMapForTesting();
+    const uint64_t fallthrough = 0x100;
+    const std::vector<std::pair<uint64_t, uint64_t>> inputs = {
+        {0, 0}, {1, 2}, {2, 1}, {0xFFFFFFFF, 1}, {0x80000000, 1}, {0x7FFFFFFF, 0xFFFFFFFF},
+    };
+    const IRConditionCode conditions[] = {
+        IRConditionCode::Equal, IRConditionCode::NotEqual, IRConditionCode::Below,
+        IRConditionCode::AboveOrEqual, IRConditionCode::Less, IRConditionCode::GreaterOrEqual,
+        IRConditionCode::LessOrEqual, IRConditionCode::Greater, IRConditionCode::Overflow,
+        IRConditionCode::NotOverflow, IRConditionCode::Sign, IRConditionCode::NotSign,
+    };
+
+    for (IRConditionCode condition : conditions) {
+        std::vector<IRInstruction> block = {
+            IRInstruction(IROpcode::Cmp, {gpr32(0), gpr32(3)}),
+            IRInstruction(IROpcode::Branch, {uint64_t{0x40}, condition}),
+        };
+        std::vector<IRInstruction> fused = block;
+        ASSERT_EQ(fuse_superinstructions(fused), 1u);
+
+        for (const auto& [a, b] : inputs) {
+            regs.set64("rax", a);
+            regs.set64("rbx", b);
+            regs.set64("rip", fallthrough);
+            for (const auto& instr : block) simulator.execute_ir_instruction(instr);
+            const uint64_t expected_rip = regs.get64("rip");
+            const uint64_t expected_flags = simulator.get_rflags() & RFLAGS_STATUS_MASK;
+
+            regs.set64("rip", fallthrough);
+            simulator.execute_ir_instruction(fused[0]);
+            EXPECT_EQ(regs.get64("rip"), expected_rip) << a << " " << b;
+            EXPECT_EQ(simulator.get_rflags() & RFLAGS_STATUS_MASK, expected_flags) << a << " " << b;
+        }
+    }
+}
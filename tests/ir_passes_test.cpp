@@ -0,0 +1,181 @@
+#include "gtest/gtest.h"
+#include "../ir_passes.h"
+#include "../ir_dispatch.h"
+#include "../architecture.h"
+#include "../x86_simulator.h"
+#include "mock_database_manager.h"
+
+namespace {
+
+IRRegister gpr(uint32_t index, uint32_t size) {
+    static const Architecture arch = create_x86_architecture();
+    IRRegister reg{IRRegisterType::GPR, index, size};
+    reg.slot = arch.get_register_slot(reg);
+    return reg;
+}
+
+IRRegister gpr32(uint32_t index) { return gpr(index, 32); }
+
+IRMemoryOperand absolute(uint64_t address, uint32_t size) {
+    IRMemoryOperand mem;
+    mem.displacement = static_cast<int64_t>(address);
+    mem.size = size;
+    return mem;
+}
+
+std::vector<IRInstruction> bound(std::vector<IRInstruction> block) {
+    for (auto& instr : block) {
+        EXPECT_TRUE(bind_ir_handler(instr));
+    }
+    return block;
+}
+
+IRPassManager only(IRPass pass) {
+    IRPassManager passes;
+    passes.set_all_enabled(false);
+    passes.set_enabled(pass, true);
+    return passes;
+}
+
+} // namespace
+
+TEST(IRPassesTest, ConstantFoldingFoldsDeadFlagArithmetic) {
+    // mov eax, 5; add eax, 3; cmp ecx, eax; jne
+    auto block = bound({
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{5}}),
+        IRInstruction(IROpcode::Add, {gpr32(0), uint64_t{3}}),
+        IRInstruction(IROpcode::Cmp, {gpr32(1), gpr32(0)}),
+        IRInstruction(IROpcode::Branch, {uint64_t{0x40}, IRConditionCode::NotEqual}),
+    });
+    IRPassManager passes = only(IRPass::ConstantFolding);
+    passes.run(block);
+
+    ASSERT_EQ(block.size(), 4u);
+    EXPECT_EQ(block[1].opcode, IROpcode::Move);
+    EXPECT_EQ(std::get<uint64_t>(block[1].operands[1]), 8u);
+    EXPECT_EQ(std::get<uint64_t>(block[2].operands[1]), 8u);
+    EXPECT_NE(block[1].handler, nullptr);
+    EXPECT_EQ(passes.get_stats(IRPass::ConstantFolding).rewritten, 2u);
+
+    // Flags of the last Add reach the block exit, so it must stay an Add.
+    auto live = bound({
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{5}}),
+        IRInstruction(IROpcode::Add, {gpr32(0), uint64_t{3}}),
+    });
+    passes.run(live);
+    EXPECT_EQ(live[1].opcode, IROpcode::Add);
+}
+
+TEST(IRPassesTest, CopyPropagationReadsTheOriginalRegister) {
+    // mov eax, ebx; add ecx, eax; mov ebx, 1; add edx, eax
+    auto block = bound({
+        IRInstruction(IROpcode::Move, {gpr32(0), gpr32(3)}),
+        IRInstruction(IROpcode::Add, {gpr32(1), gpr32(0)}),
+        IRInstruction(IROpcode::Move, {gpr32(3), uint64_t{1}}),
+        IRInstruction(IROpcode::Add, {gpr32(2), gpr32(0)}),
+    });
+    only(IRPass::CopyPropagation).run(block);
+
+    EXPECT_EQ(std::get<IRRegister>(block[1].operands[1]), gpr32(3));
+    // ebx changed, so the copy no longer holds.
+    EXPECT_EQ(std::get<IRRegister>(block[3].operands[1]), gpr32(0));
+}
+
+TEST(IRPassesTest, LoadStoreEliminationForwardsAndDropsStores) {
+    const uint64_t address = 0x1000;
+    auto block = bound({
+        IRInstruction(IROpcode::Store, {absolute(address, 32), gpr32(0)}),
+        IRInstruction(IROpcode::Load, {gpr32(1), absolute(address, 32)}),
+        IRInstruction(IROpcode::Store, {absolute(address + 8, 32), gpr32(2)}),
+        IRInstruction(IROpcode::Store, {absolute(address + 8, 32), gpr32(3)}),
+        IRInstruction(IROpcode::Store, {absolute(address, 32), gpr32(1)}),
+    });
+    IRPassManager passes = only(IRPass::LoadStoreElimination);
+    passes.run(block);
+
+    // The load reads eax, the first store to address + 8 is overwritten
+    // unread, and the last store writes back the ecx just loaded.
+    ASSERT_EQ(block.size(), 3u);
+    EXPECT_EQ(block[1].opcode, IROpcode::Move);
+    EXPECT_EQ(std::get<IRRegister>(block[1].operands[1]), gpr32(0));
+    EXPECT_EQ(std::get<IRRegister>(block[2].operands[1]), gpr32(3));
+    EXPECT_EQ(passes.get_stats(IRPass::LoadStoreElimination).removed, 2u);
+}
+
+TEST(IRPassesTest, DeadWriteEliminationKeepsLiveAndFaultingWrites) {
+    IRMemoryOperand computed;
+    computed.base_reg = gpr(6, 64);
+    computed.size = 32;
+    auto block = bound({
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{1}}), // Overwritten: dead.
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{2}}), // Visible if the load faults.
+        IRInstruction(IROpcode::Load, {gpr32(1), computed}),
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{3}}),
+    });
+    only(IRPass::DeadWriteElimination).run(block);
+
+    ASSERT_EQ(block.size(), 3u);
+    EXPECT_EQ(std::get<uint64_t>(block[0].operands[1]), 2u);
+}
+
+TEST(IRPassesTest, DisabledPassesLeaveTheBlockUnchanged) {
+    auto block = bound({
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{1}}),
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{2}}),
+    });
+    IRPassManager passes;
+    passes.set_all_enabled(false);
+    passes.run(block);
+    EXPECT_EQ(block.size(), 2u);
+    EXPECT_EQ(passes.get_stats(IRPass::DeadWriteElimination).blocks, 0u);
+    EXPECT_STREQ(IRPassManager::name(IRPass::DeadWriteElimination), "dead-write-elimination");
+}
+
+TEST(IRPassesTest, OptimizedBlockMatchesUnoptimizedExecution) {
+    MockDatabaseManager dbManager;
+    Memory memory;
+    X86Simulator simulator(dbManager, memory, 1, true);
+    auto& regs = simulator.getRegisterMapForTesting();
+    const uint64_t data = memory.get_data_segment_start();
+
+    // mov esi, data; mov eax, 7; xor edx, edx; mov [esi], eax; add edx, eax;
+    // mov ecx, [esi]; mov ebx, ecx; sub ebx, 2; and eax, ebx; mov [data+4], ebx;
+    // mov [data+4], edx; cmp edx, ecx; je
+    IRMemoryOperand via_rsi;
+    via_rsi.base_reg = gpr(6, 64);
+    via_rsi.size = 32;
+    const std::vector<IRInstruction> block = bound({
+        IRInstruction(IROpcode::Move, {gpr32(6), data}),
+        IRInstruction(IROpcode::Move, {gpr32(0), uint64_t{7}}),
+        IRInstruction(IROpcode::Xor, {gpr32(2), gpr32(2)}),
+        IRInstruction(IROpcode::Store, {via_rsi, gpr32(0)}),
+        IRInstruction(IROpcode::Add, {gpr32(2), gpr32(0)}),
+        IRInstruction(IROpcode::Load, {gpr32(1), via_rsi}),
+        IRInstruction(IROpcode::Move, {gpr32(3), gpr32(1)}),
+        IRInstruction(IROpcode::Sub, {gpr32(3), uint64_t{2}}),
+        IRInstruction(IROpcode::And, {gpr32(0), gpr32(3)}),
+        IRInstruction(IROpcode::Store, {absolute(data + 4, 32), gpr32(3)}),
+        IRInstruction(IROpcode::Store, {absolute(data + 4, 32), gpr32(2)}),
+        IRInstruction(IROpcode::Cmp, {gpr32(2), gpr32(1)}),
+        IRInstruction(IROpcode::Branch, {uint64_t{0x40}, IRConditionCode::Equal}),
+    });
+    std::vector<IRInstruction> optimized = block;
+    IRPassManager passes;
+    passes.run(optimized);
+    EXPECT_LT(optimized.size(), block.size());
+
+    auto run = [&](const std::vector<IRInstruction>& instructions) {
+        for (const char* name : {"rax", "rbx", "rcx", "rdx", "rsi"}) regs.set64(name, 0xDEAD);
+        regs.set64("rip", 0x100);
+        memory.write_dword(data, 0);
+        memory.write_dword(data + 4, 0);
+        for (const auto& instr : instructions) simulator.execute_ir_instruction(instr);
+        std::vector<uint64_t> state;
+        for (const char* name : {"rax", "rbx", "rcx", "rdx", "rsi", "rip"}) state.push_back(regs.get64(name));
+        state.push_back(memory.read_dword(data));
+        state.push_back(memory.read_dword(data + 4));
+        state.push_back(simulator.get_rflags() & RFLAGS_STATUS_MASK);
+        return state;
+    };
+    EXPECT_EQ(run(optimized), run(block));
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "../jit_compiler.h"
+#include "../x86_simulator.h"
+#include "../memory.h"
+#include "mock_database_manager.h"
+
+namespace {
+IRRegister gpr32(uint32_t index) { return IRRegister{IRRegisterType::GPR, index, 32}; }
+IRRegister gpr64(uint32_t index) { return IRRegister{IRRegisterType::GPR, index, 64}; }
+constexpr uint64_t kFlagBits = RFLAGS_STATUS_MASK;
+}
+
+class JitCompilerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!JitCompiler::is_supported()) {
+            GTEST_SKIP() << "JIT requires an x86-64 host";
+        }
+    }
+
+    MockDatabaseManager dbManager;
+    Memory memory;
+    JitCompiler jit;
+};
+
+TEST_F(JitCompilerTest, RunsLoopBodyUntilBranchFallsThrough) {
+    // add eax, ecx; mov ebx, 1; sub ecx, ebx; jne 10
+    std::vector<IRInstruction> block = {
+        IRInstruction(IROpcode::Add, {gpr32(0), gpr32(1)}),
+        IRInstruction(IROpcode::Move, {gpr32(3), uint64_t{1}}),
+        IRInstruction(IROpcode::Sub, {gpr32(1), gpr32(3)}),
+        IRInstruction(IROpcode::Branch, {uint64_t{10}, IRConditionCode::NotEqual}),
+    };
+    JitBlockFn fn = jit.compile(block, 21, memory.get_total_memory_size());
+    ASSERT_NE(fn, nullptr);
+
+    JitState state = {};
+    state.gpr[1] = 3;
+    state.memory_base = memory.host_base();
+    EXPECT_EQ(fn(&state), 10);
+    EXPECT_EQ(fn(&state), 10);
+    EXPECT_EQ(fn(&state), 21);
+    EXPECT_EQ(state.gpr[0], 6);
+    EXPECT_EQ(state.gpr[1], 0);
+    EXPECT_TRUE(state.rflags & (1ULL << RFLAGS_ZF_BIT));
+}
+
+TEST_F(JitCompilerTest, CompilesFusedDecrementBranch) {
+    // add eax, ecx; dec ecx; jnz 10 (fused)
+    std::vector<IRInstruction> block = {
+        IRInstruction(IROpcode::Add, {gpr32(0), gpr32(1)}),
+        IRInstruction(IROpcode::DecBranch, {uint64_t{10}, IRConditionCode::NotEqual, gpr32(1)}),
+    };
+    JitBlockFn fn = jit.compile(block, 21, memory.get_total_memory_size());
+    ASSERT_NE(fn, nullptr);
+
+    JitState state = {};
+    state.gpr[1] = 2;
+    state.rflags = 1ULL << RFLAGS_CF_BIT;
+    state.memory_base = memory.host_base();
+    EXPECT_EQ(fn(&state), 10);
+    EXPECT_EQ(fn(&state), 21);
+    EXPECT_EQ(state.gpr[0], 3);
+    EXPECT_EQ(state.gpr[1], 0);
+    EXPECT_TRUE(state.rflags & (1ULL << RFLAGS_ZF_BIT));
+    EXPECT_FALSE(state.rflags & (1ULL << RFLAGS_CF_BIT)); // Set by the add, kept by dec
+}
+
+TEST_F(JitCompilerTest, FlagsMatchInterpreter) {
+    X86Simulator simulator(dbManager, memory, 1, true);
+    auto& regs = simulator.getRegisterMapForTesting();
+    const std::vector<std::pair<uint64_t, uint64_t>> inputs = {
+        {0, 0}, {1, 2}, {0xFFFFFFFF, 1}, {0x80000000, 1}, {5, 5}, {0x7FFFFFFF, 0xFFFFFFFF},
+        {0xFFFFFFFFFFFFFFFFULL, 1}, {0x8000000000000000ULL, 0x8000000000000000ULL},
+    };
+    for (IROpcode opcode : {IROpcode::Add, IROpcode::Sub, IROpcode::Cmp, IROpcode::Xor}) {
+        for (bool wide : {false, true}) {
+            IRRegister dest = wide ? gpr64(0) : gpr32(0);
+            IRRegister src = wide ? gpr64(3) : gpr32(3);
+            std::vector<IRInstruction> block = {IRInstruction(opcode, {dest, src})};
+            JitBlockFn fn = jit.compile(block, 2, memory.get_total_memory_size());
+            ASSERT_NE(fn, nullptr);
+
+            for (const auto& [a, b] : inputs) {
+                regs.set64("rax", a);
+                regs.set64("rbx", b);
+                simulator.execute_ir_instruction(block[0]);
+                uint64_t expected_flags = 0;
+                expected_flags |= uint64_t{simulator.get_CF()} << RFLAGS_CF_BIT;
+                expected_flags |= uint64_t{simulator.get_ZF()} << RFLAGS_ZF_BIT;
+                expected_flags |= uint64_t{simulator.get_SF()} << RFLAGS_SF_BIT;
+                expected_flags |= uint64_t{simulator.get_OF()} << RFLAGS_OF_BIT;
+                expected_flags |= uint64_t{simulator.get_PF()} << RFLAGS_PF_BIT;
+                expected_flags |= uint64_t{simulator.get_AF()} << RFLAGS_AF_BIT;
+
+                JitState state = {};
+                state.gpr[0] = a;
+                state.gpr[3] = b;
+                state.rflags = ~expected_flags & kFlagBits; // every status flag must be written
+                state.memory_base = memory.host_base();
+                EXPECT_EQ(fn(&state), 2);
+                EXPECT_EQ(state.gpr[0], regs.get64("rax")) << static_cast<int>(opcode) << " " << a << " " << b;
+                EXPECT_EQ(state.rflags & kFlagBits, expected_flags) << static_cast<int>(opcode) << " " << a << " " << b;
+            }
+        }
+    }
+}
+
+TEST_F(JitCompilerTest, ReadsConstantAddressMemory) {
+    memory.write_dword(memory.get_data_segment_start(), 41);
+    IRMemoryOperand source;
+    source.displacement = memory.get_data_segment_start();
+    source.size = 32;
+    std::vector<IRInstruction> block = {
+        IRInstruction(IROpcode::Move, {gpr32(2), source}),
+        IRInstruction(IROpcode::Add, {gpr32(2), uint64_t{1}}),
+    };
+    JitBlockFn fn = jit.compile(block, 7, memory.get_total_memory_size());
+    ASSERT_NE(fn, nullptr);
+
+    JitState state = {};
+    state.memory_base = memory.host_base();
+    EXPECT_EQ(fn(&state), 7);
+    EXPECT_EQ(state.gpr[2], 42);
+}
+
+TEST_F(JitCompilerTest, RejectsUnsupportedBlocks) {
+    std::vector<IRInstruction> call_block = {IRInstruction(IROpcode::Call, {uint64_t{0}})};
+    EXPECT_EQ(jit.compile(call_block, 5, memory.get_total_memory_size()), nullptr);
+
+    std::vector<IRInstruction> greater_branch = {
+        IRInstruction(IROpcode::Branch, {uint64_t{0}, IRConditionCode::Greater}),
+    };
+    EXPECT_EQ(jit.compile(greater_branch, 2, memory.get_total_memory_size()), nullptr);
+    EXPECT_EQ(jit.get_compiled_blocks(), 0);
+}
+
+TEST_F(JitCompilerTest, SimulatorJitModeMatchesInterpreter) {
+    //  0: mov eax, 0 / 5: mov ecx, 100 / 10: add eax, ecx / 12: mov ebx, 1
+    // 17: sub ecx, ebx / 19: jne 10
+    const std::vector<uint8_t> program = {
+        0xb8, 0x00, 0x00, 0x00, 0x00,
+        0xb9, 0x64, 0x00, 0x00, 0x00,
+        0x01, 0xc8,
+        0xbb, 0x01, 0x00, 0x00, 0x00,
+        0x29, 0xd9,
+        0x75, 0xf5,
+    };
+    for (size_t i = 0; i < program.size(); ++i) {
+        memory.write_text(i, program[i]);
+    }
+    memory.set_text_segment_size(program.size());
+
+    X86Simulator simulator(dbManager, memory, 1, true);
+    simulator.set_execution_mode(ExecutionMode::Jit);
+    simulator.set_jit_threshold(2);
+    simulator.runProgram();
+
+    auto& regs = simulator.getRegisterMapForTesting();
+    EXPECT_EQ(regs.get32("eax"), 5050);
+    EXPECT_EQ(regs.get32("ecx"), 0);
+    EXPECT_EQ(regs.get32("ebx"), 1);
+    EXPECT_EQ(regs.get64("rip"), program.size());
+    EXPECT_TRUE(simulator.get_ZF());
+    EXPECT_GE(simulator.get_jit_compiler().get_compiled_blocks(), 1);
+}
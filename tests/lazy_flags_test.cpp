@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "../lazy_flags.h"
+#include "../x86_simulator.h"
+#include "mock_database_manager.h"
+
+TEST(LazyFlagsTest, AddOverflowAndCarry) {
+    LazyFlags flags;
+    flags.record(FlagOp::Add, 32, 0x7FFFFFFF, 1, 0x80000000);
+    EXPECT_FALSE(flags.cf());
+    EXPECT_TRUE(flags.of());
+    EXPECT_TRUE(flags.sf());
+    EXPECT_FALSE(flags.zf());
+    EXPECT_TRUE(flags.af());
+
+    flags.record(FlagOp::Add, 8, 0xFF, 0x01, 0x100);
+    EXPECT_TRUE(flags.cf());
+    EXPECT_TRUE(flags.zf());
+    EXPECT_FALSE(flags.of());
+    EXPECT_TRUE(flags.pf()); // Zero has even parity
+}
+
+TEST(LazyFlagsTest, SubBorrowAndSignedOverflow) {
+    LazyFlags flags;
+    flags.record(FlagOp::Sub, 16, 0x8000, 1, 0x7FFF);
+    EXPECT_FALSE(flags.cf());
+    EXPECT_TRUE(flags.of());
+    EXPECT_FALSE(flags.sf());
+
+    flags.record(FlagOp::Sub, 64, 1, 2, 0xFFFFFFFFFFFFFFFFULL);
+    EXPECT_TRUE(flags.cf());
+    EXPECT_FALSE(flags.of());
+    EXPECT_TRUE(flags.sf());
+}
+
+TEST(LazyFlagsTest, LogicClearsCarryOverflowAndAdjust) {
+    LazyFlags flags;
+    flags.record(FlagOp::Logic, 32, 0x0F, 0x1F, 0x10);
+    EXPECT_FALSE(flags.cf());
+    EXPECT_FALSE(flags.of());
+    EXPECT_FALSE(flags.af());
+    EXPECT_FALSE(flags.pf()); // 0x10 has one bit set
+}
+
+TEST(LazyFlagsTest, IncPreservesCarry) {
+    LazyFlags flags;
+    flags.record_preserving_carry(FlagOp::Inc, 32, 0xFFFFFFFF, 0, true);
+    EXPECT_TRUE(flags.cf());
+    EXPECT_TRUE(flags.zf());
+    flags.record_preserving_carry(FlagOp::Dec, 32, 0x80000000, 0x7FFFFFFF, false);
+    EXPECT_FALSE(flags.cf());
+    EXPECT_TRUE(flags.of());
+}
+
+TEST(LazyFlagsTest, MaterializeKeepsNonStatusBits) {
+    LazyFlags flags;
+    EXPECT_EQ(flags.materialize(0x402), 0x402u);
+    flags.record(FlagOp::Sub, 32, 5, 5, 0);
+    uint64_t rflags = flags.materialize((1ULL << RFLAGS_DF_BIT) | (1ULL << RFLAGS_CF_BIT) | 0x2);
+    EXPECT_EQ(rflags, (1ULL << RFLAGS_DF_BIT) | (1ULL << RFLAGS_ZF_BIT) | (1ULL << RFLAGS_PF_BIT) | 0x2);
+}
+
+TEST(LazyFlagsTest, SettingOneFlagKeepsPendingOthers) {
+    MockDatabaseManager dbManager;
+    Memory memory;
+    X86Simulator simulator(dbManager, memory, 1, true);
+
+    simulator.record_flags(FlagOp::Sub, 32, 3, 3, 0);
+    simulator.set_CF(true);
+    EXPECT_TRUE(simulator.get_ZF());
+    EXPECT_TRUE(simulator.get_CF());
+
+    simulator.update_rflags_in_register_map();
+    uint64_t rflags = simulator.getRegisterMapForTesting().get64("rflags");
+    EXPECT_TRUE((rflags >> RFLAGS_ZF_BIT) & 1);
+    EXPECT_TRUE((rflags >> RFLAGS_CF_BIT) & 1);
+}
@@ -63,3 +63,72 @@ TEST(MemoryTest, OutOfBoundsWrite) {
     address_t addr = mem.get_total_memory_size() + 1; // An address guaranteed to be out of bounds
     EXPECT_THROW(mem.write_text(addr, 0), std::out_of_range);
 }
+
+TEST(MemoryTest, TextWriteListenerSeesOnlyTextWrites) {
+    Memory mem;
+    std::vector<std::pair<address_t, size_t>> writes;
+    size_t id = mem.add_text_write_listener([&](address_t address, size_t size) {
+        writes.emplace_back(address, size);
+    });
+
+    mem.write_text(mem.get_text_segment_start() + 3, 0x90);
+    mem.write_dword(mem.get_text_segment_start() + 8, 0xdeadbeef);
+    mem.write_dword(mem.get_data_segment_start(), 0x12345678);
+
+    ASSERT_EQ(writes.size(), 2);
+    EXPECT_EQ(writes[0], std::make_pair(mem.get_text_segment_start() + 3, size_t{1}));
+    EXPECT_EQ(writes[1], std::make_pair(mem.get_text_segment_start() + 8, size_t{4}));
+
+    mem.remove_text_write_listener(id);
+    mem.write_text(mem.get_text_segment_start(), 0x90);
+    EXPECT_EQ(writes.size(), 2);
+}
+
+TEST(MemoryTest, PagesAreBackedOnlyOnceWritten) {
+    Memory mem;
+    const size_t page = 4096;
+    const size_t untouched = mem.get_resident_size();
+    EXPECT_LT(untouched, 16 * page);
+
+    // Reading anywhere sees zeros without committing the whole layout.
+    EXPECT_EQ(mem.read64(mem.get_heap_segment_start() + 0x10000), 0u);
+    mem.write_dword(mem.get_data_segment_start(), 0x12345678);
+    mem.write_stack(mem.get_stack_bottom() - 8, 0xfeedfacecafebeefULL);
+    EXPECT_LE(mem.get_resident_size(), untouched + 3 * page);
+    EXPECT_LT(mem.get_resident_size(), mem.get_total_memory_size() / 64);
+
+    uint8_t* base = mem.host_base();
+    mem.reset();
+    EXPECT_EQ(mem.host_base(), base);
+    EXPECT_EQ(mem.read_data_dword(mem.get_data_segment_start()), 0u);
+    EXPECT_EQ(mem.read_stack(mem.get_stack_bottom() - 8), 0u);
+    EXPECT_LT(mem.get_resident_size(), 16 * page);
+}
+
+TEST(MemoryTest, TlbServesRepeatedAccessesAndGuardsText) {
+    Memory mem;
+    address_t data = mem.get_data_segment_start();
+    mem.write_dword(data, 0x11223344);
+    uint64_t misses = mem.get_tlb_misses();
+    for (int i = 0; i < 100; ++i) {
+        mem.write_dword(data + 4 * i, i);
+        EXPECT_EQ(mem.read_dword(data + 4 * i), static_cast<uint32_t>(i));
+    }
+    EXPECT_EQ(mem.get_tlb_misses(), misses);
+
+    // Accesses straddling a page still work, through the slow path.
+    mem.write_qword(data + Memory::kPageSize - 4, 0x0102030405060708ULL);
+    EXPECT_EQ(mem.read_qword(data + Memory::kPageSize - 4), 0x0102030405060708ULL);
+    EXPECT_EQ(mem.read_dword(data + Memory::kPageSize), 0x01020304u);
+
+    // Text pages are cached read-only, so every store is seen by listeners.
+    size_t text_writes = 0;
+    mem.add_text_write_listener([&](address_t, size_t) { ++text_writes; });
+    mem.read_dword(mem.get_text_segment_start());
+    mem.write_dword(mem.get_text_segment_start(), 1);
+    mem.write_dword(mem.get_text_segment_start(), 2);
+    EXPECT_EQ(text_writes, 2u);
+
+    EXPECT_THROW(mem.read_dword(mem.get_total_memory_size() - 2), std::out_of_range);
+    EXPECT_THROW(mem.write_qword(~address_t{0} - 3, 0), std::out_of_range);
+}
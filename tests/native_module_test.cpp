@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "../native_module.h"
+#include "../x86_simulator.h"
+#include "mock_database_manager.h"
+#include "test_programs.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+static const char* kLibraryPath = "./native_module_test.so";
+
+class NativeModuleTest : public ::testing::Test {
+protected:
+    MockDatabaseManager dbManager;
+    Memory memory;
+
+    void SetUp() override {
+        load_text_program(memory, kSumLoop);
+    }
+
+    void TearDown() override {
+        std::remove(kLibraryPath);
+        std::remove((std::string(kLibraryPath) + ".cpp").c_str());
+    }
+
+    static bool compiler_available() {
+        const char* compiler = std::getenv("CXX");
+        std::string command = std::string(compiler && *compiler ? compiler : "c++") + " --version > /dev/null 2>&1";
+        return std::system(command.c_str()) == 0;
+    }
+};
+
+TEST_F(NativeModuleTest, EmitsEveryCoveredBlock) {
+    X86Simulator simulator(dbManager, memory, 1, true);
+    simulator.translateAheadOfTime();
+    ASSERT_EQ(simulator.get_block_cache().size(), 2u);
+
+    std::ostringstream source;
+    EXPECT_EQ(emit_native_module(simulator.get_block_cache(), memory, source), 2u);
+    EXPECT_NE(source.str().find("x86sim_block_functions"), std::string::npos);
+
+    // The fingerprint follows the IR, not just the address.
+    const BasicBlock* loop = simulator.get_block_cache().find(10);
+    ASSERT_NE(loop, nullptr);
+    BasicBlock changed = *loop;
+    changed.instructions.pop_back();
+    EXPECT_NE(fingerprint_block(changed), fingerprint_block(*loop));
+}
+
+TEST_F(NativeModuleTest, CompiledBlocksRunTheProgram) {
+    if (!compiler_available()) {
+        GTEST_SKIP() << "no C++ compiler";
+    }
+    {
+        X86Simulator simulator(dbManager, memory, 1, true);
+        simulator.set_execution_mode(ExecutionMode::Block);
+        ASSERT_TRUE(simulator.useNativeModule(kLibraryPath));
+        EXPECT_EQ(simulator.native_module_blocks(), 2u);
+        EXPECT_NE(simulator.get_block_cache().find(10)->native_code, nullptr);
+
+        simulator.runProgram();
+        EXPECT_EQ(simulator.getRegisterMapForTesting().get32("eax"), 6u);
+        EXPECT_EQ(simulator.getRegisterMapForTesting().get32("ecx"), 0u);
+    }
+
+    // A later session reuses the library without compiling.
+    std::remove((std::string(kLibraryPath) + ".cpp").c_str());
+    X86Simulator simulator(dbManager, memory, 1, true);
+    simulator.set_execution_mode(ExecutionMode::Block);
+    ASSERT_TRUE(simulator.loadNativeModule(kLibraryPath));
+    simulator.runProgram();
+    EXPECT_EQ(simulator.getRegisterMapForTesting().get32("eax"), 6u);
+}
+
+TEST_F(NativeModuleTest, StaleModuleIsNotAttached) {
+    if (!compiler_available()) {
+        GTEST_SKIP() << "no C++ compiler";
+    }
+    {
+        X86Simulator simulator(dbManager, memory, 1, true);
+        ASSERT_TRUE(simulator.buildNativeModule(kLibraryPath));
+    }
+
+    // Count down from 5 instead of 3: the loop body keeps its address but the
+    // first block changes.
+    std::vector<uint8_t> program = kSumLoop;
+    program[6] = 0x05;
+    load_text_program(memory, program);
+    X86Simulator simulator(dbManager, memory, 1, true);
+    simulator.set_execution_mode(ExecutionMode::Block);
+    EXPECT_FALSE(simulator.loadNativeModule(kLibraryPath));
+    EXPECT_EQ(simulator.native_module_blocks(), 1u);
+    EXPECT_EQ(simulator.get_block_cache().find(0)->native_code, nullptr);
+
+    simulator.runProgram();
+    EXPECT_EQ(simulator.getRegisterMapForTesting().get32("eax"), 15u);
+}
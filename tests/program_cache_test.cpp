@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "../program_cache.h"
+#include "../x86_simulator.h"
+#include "mock_database_manager.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+const char* kSourcePath = "program_cache_test.asm";
+
+const char* kProgram = R"(section .data
+value dd 5
+section .text
+global _start
+_start:
+    mov eax, 10
+    mov ebx, 20
+    add eax, ebx
+    mov ecx, 30
+    cmp eax, ecx
+    jne done
+    mov ecx, 7
+done:
+    mov ebx, 0
+)";
+
+void write_source(const std::string& text) {
+    std::ofstream file(kSourcePath, std::ios::trunc);
+    file << text;
+}
+
+} // namespace
+
+class ProgramCacheTest : public ::testing::Test {
+protected:
+    MockDatabaseManager dbManager;
+
+    void SetUp() override {
+        write_source(kProgram);
+        std::remove(program_cache_path(kSourcePath).c_str());
+    }
+
+    void TearDown() override {
+        std::remove(kSourcePath);
+        std::remove(program_cache_path(kSourcePath).c_str());
+    }
+
+    // Assembles (or restores) the program into a fresh simulator and runs it.
+    bool run(Memory& memory, uint32_t& eax, uint32_t& ecx, size_t& blocks, bool optimize = true) {
+        X86Simulator simulator(dbManager, memory, 1, true);
+        simulator.set_execution_mode(ExecutionMode::Block);
+        simulator.set_aot_translation(true, 1);
+        simulator.get_ir_passes().set_all_enabled(optimize);
+        simulator.set_program_cache(true);
+        EXPECT_TRUE(simulator.assembleProgram(kSourcePath));
+        blocks = simulator.get_block_cache().size();
+        simulator.runProgram();
+        eax = simulator.getRegisterMapForTesting().get32("eax");
+        ecx = simulator.getRegisterMapForTesting().get32("ecx");
+        return simulator.program_cache_hit();
+    }
+};
+
+TEST_F(ProgramCacheTest, SecondRunRestoresImageAndBlocks) {
+    Memory first_memory;
+    uint32_t eax = 0, ecx = 0;
+    size_t blocks = 0;
+    EXPECT_FALSE(run(first_memory, eax, ecx, blocks));
+    EXPECT_EQ(eax, 30u);
+    EXPECT_EQ(ecx, 7u);
+    EXPECT_GT(blocks, 0u);
+
+    Memory second_memory;
+    uint32_t cached_eax = 0, cached_ecx = 0;
+    size_t cached_blocks = 0;
+    EXPECT_TRUE(run(second_memory, cached_eax, cached_ecx, cached_blocks));
+    EXPECT_EQ(cached_eax, eax);
+    EXPECT_EQ(cached_ecx, ecx);
+    EXPECT_EQ(cached_blocks, blocks);
+    EXPECT_EQ(second_memory.get_text_segment_size(), first_memory.get_text_segment_size());
+    for (size_t i = 0; i < first_memory.get_text_segment_size(); ++i) {
+        ASSERT_EQ(second_memory.read_text(i), first_memory.read_text(i)) << i;
+    }
+    EXPECT_EQ(second_memory.read_data_dword(second_memory.get_data_segment_start()), 5u);
+}
+
+TEST_F(ProgramCacheTest, ChangedSourceOrDamagedFileIsRebuilt) {
+    Memory memory;
+    uint32_t eax = 0, ecx = 0;
+    size_t blocks = 0;
+    EXPECT_FALSE(run(memory, eax, ecx, blocks));
+
+    write_source(std::string(kProgram) + "    mov ecx, 9\n");
+    EXPECT_FALSE(run(memory, eax, ecx, blocks));
+    EXPECT_EQ(ecx, 9u);
+    EXPECT_TRUE(run(memory, eax, ecx, blocks));
+
+    // Truncate the cache file: it must be rejected and rewritten.
+    {
+        std::ofstream damaged(program_cache_path(kSourcePath), std::ios::binary | std::ios::trunc);
+        damaged << "X86CACHE";
+    }
+    EXPECT_FALSE(run(memory, eax, ecx, blocks));
+    EXPECT_EQ(ecx, 9u);
+    EXPECT_TRUE(run(memory, eax, ecx, blocks));
+}
+
+TEST_F(ProgramCacheTest, FileFromAnotherPassSetIsRebuilt) {
+    IRPassManager passes;
+    const uint64_t key = hash_program_source(kProgram, passes);
+    passes.set_enabled(IRPass::LoadStoreElimination, false);
+    EXPECT_NE(hash_program_source(kProgram, passes), key);
+
+    Memory memory;
+    uint32_t eax = 0, ecx = 0;
+    size_t blocks = 0;
+    EXPECT_FALSE(run(memory, eax, ecx, blocks));
+    EXPECT_TRUE(run(memory, eax, ecx, blocks));
+    // Blocks optimized under another configuration must not be reused.
+    EXPECT_FALSE(run(memory, eax, ecx, blocks, false));
+    EXPECT_EQ(eax, 30u);
+    EXPECT_TRUE(run(memory, eax, ecx, blocks, false));
+}
+
+TEST_F(ProgramCacheTest, CacheDoesNotTurnOnAheadOfTimeTranslation) {
+    Memory memory;
+    X86Simulator simulator(dbManager, memory, 1, true);
+    simulator.set_execution_mode(ExecutionMode::SingleStep);
+    simulator.set_aot_translation(true, 1);
+    simulator.set_program_cache(true);
+    ASSERT_TRUE(simulator.assembleProgram(kSourcePath));
+    EXPECT_FALSE(simulator.program_cache_hit());
+    EXPECT_EQ(simulator.get_block_cache().size(), 0u);
+
+    X86Simulator cached(dbManager, memory, 1, true);
+    cached.set_program_cache(true);
+    ASSERT_TRUE(cached.assembleProgram(kSourcePath));
+    EXPECT_TRUE(cached.program_cache_hit());
+    EXPECT_EQ(cached.get_block_cache().size(), 0u);
+    cached.runProgram();
+    EXPECT_EQ(cached.getRegisterMapForTesting().get32("eax"), 30u);
+}
@@ -32,16 +32,19 @@ TEST(ProgramDecoderTest, DecodeSimpleProgram) {
     const auto& decoded_program = decoder.getDecodedProgram();
     ASSERT_EQ(decoded_program.size(), 2);
 
-    EXPECT_EQ(decoded_program[0]->mnemonic, "mov");
-    EXPECT_EQ(decoded_program[0]->length_in_bytes, 5);
-
-    EXPECT_EQ(decoded_program[1]->mnemonic, "nop");
-    EXPECT_EQ(decoded_program[1]->length_in_bytes, 1);
-
-    const auto& address_map = decoder.getAddressToIndexMap();
-    ASSERT_EQ(address_map.size(), 2);
-    EXPECT_EQ(address_map.at(mem.get_text_segment_start() + 0), 0);
-    EXPECT_EQ(address_map.at(mem.get_text_segment_start() + 5), 1);
+    EXPECT_EQ(decoded_program[0].mnemonic, "mov");
+    EXPECT_EQ(decoded_program[0].length_in_bytes, 5);
+
+    EXPECT_EQ(decoded_program[1].mnemonic, "nop");
+    EXPECT_EQ(decoded_program[1].length_in_bytes, 1);
+
+    size_t index = 99;
+    ASSERT_TRUE(decoder.index_of(mem.get_text_segment_start() + 0, index));
+    EXPECT_EQ(index, 0);
+    ASSERT_TRUE(decoder.index_of(mem.get_text_segment_start() + 5, index));
+    EXPECT_EQ(index, 1);
+    EXPECT_FALSE(decoder.index_of(mem.get_text_segment_start() + 1, index));
+    EXPECT_FALSE(decoder.index_of(mem.get_text_segment_start() + 6, index));
 }
 
 TEST(ProgramDecoderTest, DecodePushPopProgram) {
@@ -71,29 +74,31 @@ TEST(ProgramDecoderTest, DecodePushPopProgram) {
     ASSERT_EQ(decoded_program.size(), 3);
 
     // Instruction 1: mov eax, 0x1234
-    EXPECT_EQ(decoded_program[0]->mnemonic, "mov");
-    EXPECT_EQ(decoded_program[0]->length_in_bytes, 5);
-    ASSERT_EQ(decoded_program[0]->operands.size(), 2);
-    EXPECT_EQ(decoded_program[0]->operands[0].text, "eax");
-    EXPECT_EQ(decoded_program[0]->operands[1].value, 0x1234);
+    EXPECT_EQ(decoded_program[0].mnemonic, "mov");
+    EXPECT_EQ(decoded_program[0].length_in_bytes, 5);
+    ASSERT_EQ(decoded_program[0].operands.size(), 2);
+    EXPECT_EQ(decoded_program[0].operands[0].text, "eax");
+    EXPECT_EQ(decoded_program[0].operands[1].value, 0x1234);
 
     // Instruction 2: push eax
-    EXPECT_EQ(decoded_program[1]->mnemonic, "push");
-    EXPECT_EQ(decoded_program[1]->length_in_bytes, 1);
-    ASSERT_EQ(decoded_program[1]->operands.size(), 1);
-    EXPECT_EQ(decoded_program[1]->operands[0].text, "eax");
+    EXPECT_EQ(decoded_program[1].mnemonic, "push");
+    EXPECT_EQ(decoded_program[1].length_in_bytes, 1);
+    ASSERT_EQ(decoded_program[1].operands.size(), 1);
+    EXPECT_EQ(decoded_program[1].operands[0].text, "eax");
 
     // Instruction 3: pop ebx
-    EXPECT_EQ(decoded_program[2]->mnemonic, "pop");
-    EXPECT_EQ(decoded_program[2]->length_in_bytes, 1);
-    ASSERT_EQ(decoded_program[2]->operands.size(), 1);
-    EXPECT_EQ(decoded_program[2]->operands[0].text, "ebx");
-
-    const auto& address_map = decoder.getAddressToIndexMap();
-    ASSERT_EQ(address_map.size(), 3);
-    EXPECT_EQ(address_map.at(start_addr + 0), 0); // mov
-    EXPECT_EQ(address_map.at(start_addr + 5), 1); // push
-    EXPECT_EQ(address_map.at(start_addr + 6), 2); // pop
+    EXPECT_EQ(decoded_program[2].mnemonic, "pop");
+    EXPECT_EQ(decoded_program[2].length_in_bytes, 1);
+    ASSERT_EQ(decoded_program[2].operands.size(), 1);
+    EXPECT_EQ(decoded_program[2].operands[0].text, "ebx");
+
+    size_t index = 99;
+    ASSERT_TRUE(decoder.index_of(start_addr + 0, index));
+    EXPECT_EQ(index, 0); // mov
+    ASSERT_TRUE(decoder.index_of(start_addr + 5, index));
+    EXPECT_EQ(index, 1); // push
+    ASSERT_TRUE(decoder.index_of(start_addr + 6, index));
+    EXPECT_EQ(index, 2); // pop
 }
 
 TEST(ProgramDecoderTest, DecodeVEXThreeOperandInstruction) {
@@ -120,12 +125,12 @@ TEST(ProgramDecoderTest, DecodeVEXThreeOperandInstruction) {
     ASSERT_EQ(decoded_program.size(), 1);
 
     const auto& instr = decoded_program[0];
-    EXPECT_EQ(instr->mnemonic, "vaddps");
-    EXPECT_EQ(instr->length_in_bytes, 4);
-    ASSERT_EQ(instr->operands.size(), 3);
-    EXPECT_EQ(instr->operands[0].text, "ymm0"); // dest
-    EXPECT_EQ(instr->operands[1].text, "ymm1"); // src1 (from vvvv)
-    EXPECT_EQ(instr->operands[2].text, "ymm2"); // src2 (from rm)
+    EXPECT_EQ(instr.mnemonic, "vaddps");
+    EXPECT_EQ(instr.length_in_bytes, 4);
+    ASSERT_EQ(instr.operands.size(), 3);
+    EXPECT_EQ(instr.operands[0].text, "ymm0"); // dest
+    EXPECT_EQ(instr.operands[1].text, "ymm1"); // src1 (from vvvv)
+    EXPECT_EQ(instr.operands[2].text, "ymm2"); // src2 (from rm)
 }
 
 TEST(ProgramDecoderTest, DecodeVEXTwoOperandInstruction) {
@@ -152,11 +157,11 @@ TEST(ProgramDecoderTest, DecodeVEXTwoOperandInstruction) {
     ASSERT_EQ(decoded_program.size(), 1);
 
     const auto& instr = decoded_program[0];
-    EXPECT_EQ(instr->mnemonic, "vrcpps");
-    EXPECT_EQ(instr->length_in_bytes, 4);
-    ASSERT_EQ(instr->operands.size(), 2);
-    EXPECT_EQ(instr->operands[0].text, "ymm0"); // dest
-    EXPECT_EQ(instr->operands[1].text, "ymm1"); // src
+    EXPECT_EQ(instr.mnemonic, "vrcpps");
+    EXPECT_EQ(instr.length_in_bytes, 4);
+    ASSERT_EQ(instr.operands.size(), 2);
+    EXPECT_EQ(instr.operands[0].text, "ymm0"); // dest
+    EXPECT_EQ(instr.operands[1].text, "ymm1"); // src
 }
 
 TEST(ProgramDecoderTest, DecodeVMOVUPSLoad) {
@@ -182,14 +187,14 @@ TEST(ProgramDecoderTest, DecodeVMOVUPSLoad) {
     ASSERT_EQ(decoded_program.size(), 1);
 
     const auto& instr = decoded_program[0];
-    EXPECT_EQ(instr->mnemonic, "vmovups");
-    EXPECT_EQ(instr->length_in_bytes, 2 + 1 + 1 + 4);
-    ASSERT_EQ(instr->operands.size(), 2);
-    EXPECT_EQ(instr->operands[0].text, "ymm0"); // dest
-    EXPECT_EQ(instr->operands[0].type, OperandType::YMM_REGISTER);
-    EXPECT_EQ(instr->operands[1].type, OperandType::MEMORY);
+    EXPECT_EQ(instr.mnemonic, "vmovups");
+    EXPECT_EQ(instr.length_in_bytes, 2 + 1 + 1 + 4);
+    ASSERT_EQ(instr.operands.size(), 2);
+    EXPECT_EQ(instr.operands[0].text, "ymm0"); // dest
+    EXPECT_EQ(instr.operands[0].type, OperandType::YMM_REGISTER);
+    EXPECT_EQ(instr.operands[1].type, OperandType::MEMORY);
     address_t expected_addr = start_addr + 8 + 0x100;
-    EXPECT_EQ(instr->operands[1].value, expected_addr);
+    EXPECT_EQ(instr.operands[1].value, expected_addr);
 }
 
 TEST(ProgramDecoderTest, AssembleAndDecodeJumps) {
@@ -243,32 +248,142 @@ TEST(ProgramDecoderTest, AssembleAndDecodeJumps) {
 
     // --- Verify Decoded Instructions ---
     // 1. mov ecx, 10 (address 0, size 5)
-    EXPECT_EQ(decoded_program[0]->mnemonic, "mov");
-    EXPECT_EQ(decoded_program[0]->address, 0);
+    EXPECT_EQ(decoded_program[0].mnemonic, "mov");
+    EXPECT_EQ(decoded_program[0].address, 0);
 
     // 2. cmp ecx, 0 (address 5, size 3)
-    EXPECT_EQ(decoded_program[1]->mnemonic, "cmp");
-    EXPECT_EQ(decoded_program[1]->address, 5);
+    EXPECT_EQ(decoded_program[1].mnemonic, "cmp");
+    EXPECT_EQ(decoded_program[1].address, 5);
 
     // 3. je end (address 8, size 6)
     const auto& je_instr = decoded_program[2];
-    EXPECT_EQ(je_instr->mnemonic, "je");
-    EXPECT_EQ(je_instr->address, 8);
-    ASSERT_EQ(je_instr->operands.size(), 1);
-    EXPECT_EQ(je_instr->operands[0].value, symbol_table["end"]);
+    EXPECT_EQ(je_instr.mnemonic, "je");
+    EXPECT_EQ(je_instr.address, 8);
+    ASSERT_EQ(je_instr.operands.size(), 1);
+    EXPECT_EQ(je_instr.operands[0].value, symbol_table["end"]);
 
     // 4. dec ecx (address 14, size 2)
-    EXPECT_EQ(decoded_program[3]->mnemonic, "dec");
-    EXPECT_EQ(decoded_program[3]->address, 14);
+    EXPECT_EQ(decoded_program[3].mnemonic, "dec");
+    EXPECT_EQ(decoded_program[3].address, 14);
 
     // 5. jmp loop (address 16, size 5)
     const auto& jmp_instr = decoded_program[4];
-    EXPECT_EQ(jmp_instr->mnemonic, "jmp");
-    EXPECT_EQ(jmp_instr->address, 16);
-    ASSERT_EQ(jmp_instr->operands.size(), 1);
-    EXPECT_EQ(jmp_instr->operands[0].value, symbol_table["loop"]);
+    EXPECT_EQ(jmp_instr.mnemonic, "jmp");
+    EXPECT_EQ(jmp_instr.address, 16);
+    ASSERT_EQ(jmp_instr.operands.size(), 1);
+    EXPECT_EQ(jmp_instr.operands[0].value, symbol_table["loop"]);
 
     // 6. nop (address 21)
-    EXPECT_EQ(decoded_program[5]->mnemonic, "nop");
-    EXPECT_EQ(decoded_program[5]->address, 21);
+    EXPECT_EQ(decoded_program[5].mnemonic, "nop");
+    EXPECT_EQ(decoded_program[5].address, 21);
+}
+
+// A few hundred KB of mixed-length instructions: mov ecx, imm (5), add eax,
+// ecx (2), nop (1), jne rel8 (2).
+static size_t write_large_program(Memory& mem) {
+    const std::vector<uint8_t> pattern = {0xb9, 0x01, 0x02, 0x03, 0x04, 0x01, 0xc8, 0x90, 0x75, 0xf5};
+    const size_t size = 40000 * pattern.size();
+    address_t start = mem.get_text_segment_start();
+    for (size_t i = 0; i < size; ++i) {
+        mem.write_text(start + i, pattern[i % pattern.size()]);
+    }
+    mem.set_text_segment_size(size);
+    return size;
+}
+
+TEST(ProgramDecoderTest, ParallelDecodeMatchesSequentialSweep) {
+    Memory mem;
+    size_t size = write_large_program(mem);
+    ASSERT_GT(size, 4 * ProgramDecoder::kMinChunkBytes);
+
+    ProgramDecoder sequential(mem);
+    sequential.set_threads(1);
+    sequential.decode();
+    const auto& expected = sequential.getDecodedProgram();
+    ASSERT_EQ(expected.size(), 4 * 40000u);
+
+    // Boundaries inside instructions (odd offsets) force the merge to resync.
+    std::vector<std::vector<address_t>> hints = {{}, {}};
+    for (address_t a = 0; a < size; a += 7919) {
+        hints[1].push_back(mem.get_text_segment_start() + a);
+    }
+    for (const auto& boundaries : hints) {
+        ProgramDecoder parallel(mem);
+        parallel.set_threads(4);
+        parallel.set_boundaries(boundaries);
+        parallel.decode();
+        const auto& actual = parallel.getDecodedProgram();
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(actual[i].address, expected[i].address) << i;
+            ASSERT_EQ(actual[i].mnemonic, expected[i].mnemonic) << i;
+        }
+        const DecodedInstruction* last = parallel.find(expected.back().address);
+        ASSERT_NE(last, nullptr);
+        EXPECT_EQ(last, &actual.back());
+    }
+}
+
+TEST(ProgramDecoderTest, DecodesOnlyThePopulatedRange) {
+    Memory mem;
+    address_t start = mem.get_text_segment_start();
+    // mov eax, 0; nop; then the rest of the text segment is zero.
+    const std::vector<uint8_t> program = {0xb8, 0x00, 0x00, 0x00, 0x00, 0x90};
+    for (size_t i = 0; i < program.size(); ++i) {
+        mem.write_text(start + i, program[i]);
+    }
+
+    ProgramDecoder decoder(mem);
+    decoder.decode();
+    ASSERT_EQ(decoder.getDecodedProgram().size(), 2u);
+    EXPECT_EQ(decoder.getDecodedProgram()[1].mnemonic, "nop");
+
+    ProgramDecoder ranged(mem);
+    ranged.set_range(start, start + 5);
+    ranged.decode();
+    ASSERT_EQ(ranged.getDecodedProgram().size(), 1u);
+    EXPECT_EQ(ranged.getDecodedProgram()[0].mnemonic, "mov");
+}
+
+TEST(ProgramDecoderTest, RedecodesOnlyTheWrittenInstructions) {
+    Memory mem;
+    address_t start = mem.get_text_segment_start();
+    // mov ecx, 1; nop; nop; nop; push eax
+    const std::vector<uint8_t> program = {0xb9, 0x01, 0x00, 0x00, 0x00, 0x90, 0x90, 0x90, 0x50};
+    for (size_t i = 0; i < program.size(); ++i) {
+        mem.write_text(start + i, program[i]);
+    }
+    mem.set_text_segment_size(program.size());
+
+    ProgramDecoder decoder(mem);
+    decoder.decode();
+    ASSERT_EQ(decoder.getDecodedProgram().size(), 5u);
+
+    // Turning the first nop into "add eax, ecx" swallows the second nop.
+    mem.write_text(start + 5, 0x01);
+    mem.write_text(start + 6, 0xc8);
+    decoder.refresh();
+    const auto& listing = decoder.getDecodedProgram();
+    ASSERT_EQ(listing.size(), 4u);
+    EXPECT_EQ(listing[1].mnemonic, "add");
+    EXPECT_EQ(listing[2].mnemonic, "nop");
+    EXPECT_EQ(listing[2].address, start + 7);
+    EXPECT_EQ(decoder.find(start + 6), nullptr);
+    size_t index = 0;
+    ASSERT_TRUE(decoder.index_of(start + 8, index));
+    EXPECT_EQ(index, 3u);
+
+    // Writing into the middle of the mov re-decodes it in place.
+    mem.write_text(start + 1, 0x07);
+    decoder.refresh();
+    ASSERT_EQ(decoder.getDecodedProgram().size(), 4u);
+    EXPECT_EQ(decoder.find(start)->operands[1].value, 7u);
+
+    ProgramDecoder fresh(mem);
+    fresh.decode();
+    ASSERT_EQ(fresh.getDecodedProgram().size(), listing.size());
+    for (size_t i = 0; i < listing.size(); ++i) {
+        EXPECT_EQ(fresh.getDecodedProgram()[i].address, listing[i].address);
+        EXPECT_EQ(fresh.getDecodedProgram()[i].mnemonic, listing[i].mnemonic);
+    }
 }
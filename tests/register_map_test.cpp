@@ -40,3 +40,35 @@ TEST_F(RegisterMapTest, InvalidRegister32) {
     EXPECT_THROW(regs.get32("invalid_reg"), std::out_of_range);
     EXPECT_THROW(regs.set32("invalid_reg", 0), std::out_of_range);
 }
+
+TEST_F(RegisterMapTest, TypedAccessMatchesNames) {
+    regs.set64(RCX, 0x1122334455667788);
+    EXPECT_EQ(regs.get64("rcx"), 0x1122334455667788);
+    EXPECT_EQ(regs.get32(ECX), 0x55667788u);
+
+    regs.set32("eflags", 0x246);
+    EXPECT_EQ(regs.get64(RFLAGS), 0x246u);
+    EXPECT_EQ(regs.get64(R8), 0u);
+}
+
+TEST_F(RegisterMapTest, PartialWritesMerge) {
+    regs.set64(RAX, 0xFFFFFFFFFFFFFFFF);
+    regs.set16(RAX, 0x1234);
+    EXPECT_EQ(regs.get64(RAX), 0xFFFFFFFFFFFF1234);
+    regs.set8(RAX, 0x56);
+    EXPECT_EQ(regs.get64(RAX), 0xFFFFFFFFFFFF1256);
+    regs.set8("ah", 0x78);
+    EXPECT_EQ(regs.get64(RAX), 0xFFFFFFFFFFFF7856);
+    EXPECT_EQ(regs.get8("ah"), 0x78);
+    EXPECT_EQ(regs.get8("al"), 0x56);
+}
+
+TEST_F(RegisterMapTest, NamesOfOtherWidthsAreRejected) {
+    EXPECT_THROW(regs.get64("eax"), std::out_of_range);
+    EXPECT_THROW(regs.get32("rax"), std::out_of_range);
+    EXPECT_THROW(regs.getYmm("xmm0"), std::out_of_range);
+}
+
+TEST_F(RegisterMapTest, RegisterFileIsCacheLineAligned) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&regs) % 64, 0u);
+}
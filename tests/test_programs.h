@@ -0,0 +1,32 @@
+#ifndef TEST_PROGRAMS_H
+#define TEST_PROGRAMS_H
+
+#include <cstdint>
+#include <vector>
+#include "../memory.h"
+
+// Sums 3 + 2 + 1 into eax:
+//   0: mov eax, 0
+//   5: mov ecx, 3
+//  10: add eax, ecx
+//  12: mov ebx, 1
+//  17: sub ecx, ebx
+//  19: jne 10
+inline const std::vector<uint8_t> kSumLoop = {
+    0xb8, 0x00, 0x00, 0x00, 0x00,
+    0xb9, 0x03, 0x00, 0x00, 0x00,
+    0x01, 0xc8,
+    0xbb, 0x01, 0x00, 0x00, 0x00,
+    0x29, 0xd9,
+    0x75, 0xf5,
+};
+
+// Copies `program` to the start of the text segment and sizes the segment to it.
+inline void load_text_program(Memory& memory, const std::vector<uint8_t>& program) {
+    for (size_t i = 0; i < program.size(); ++i) {
+        memory.write_text(memory.get_text_segment_start() + i, program[i]);
+    }
+    memory.set_text_segment_size(program.size());
+}
+
+#endif // TEST_PROGRAMS_H
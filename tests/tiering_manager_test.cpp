@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+#include "../tiering_manager.h"
+#include "../x86_simulator.h"
+#include "../memory.h"
+#include "mock_database_manager.h"
+#include "test_programs.h"
+
+TEST(TieringManagerTest, ColdEntryPromotesAtWarmThreshold) {
+    TieringPolicy policy;
+    policy.warm_threshold = 3;
+    TieringManager tiering(policy);
+
+    EXPECT_FALSE(tiering.record_cold_entry(0x10));
+    EXPECT_FALSE(tiering.record_cold_entry(0x10));
+    EXPECT_FALSE(tiering.record_cold_entry(0x20));
+    EXPECT_TRUE(tiering.record_cold_entry(0x10));
+
+    tiering.promoted_to_warm(0x10);
+    EXPECT_EQ(tiering.get_stats().promotions_to_warm, 1);
+    EXPECT_FALSE(tiering.record_cold_entry(0x10)); // Counter restarted
+}
+
+TEST(TieringManagerTest, BlockBecomesHotUnlessRejected) {
+    TieringPolicy policy;
+    policy.hot_threshold = 2;
+    TieringManager tiering(policy);
+
+    BasicBlock block;
+    EXPECT_FALSE(tiering.record_block_execution(block));
+    EXPECT_TRUE(tiering.record_block_execution(block));
+
+    BasicBlock rejected;
+    rejected.jit_rejected = true;
+    EXPECT_FALSE(tiering.record_block_execution(rejected));
+    EXPECT_FALSE(tiering.record_block_execution(rejected));
+
+    policy.jit_enabled = false;
+    tiering.set_policy(policy);
+    BasicBlock interpreted_only;
+    EXPECT_FALSE(tiering.record_block_execution(interpreted_only));
+    EXPECT_FALSE(tiering.record_block_execution(interpreted_only));
+}
+
+class TieredExecutionTest : public ::testing::Test {
+protected:
+    MockDatabaseManager dbManager;
+    Memory memory;
+};
+
+TEST_F(TieredExecutionTest, LoopIsPromotedThroughTiers) {
+    //  0: mov eax, 0 / 5: mov ecx, 100 / 10: add eax, ecx / 12: mov ebx, 1
+    // 17: sub ecx, ebx / 19: jne 10
+    load_text_program(memory, {
+        0xb8, 0x00, 0x00, 0x00, 0x00,
+        0xb9, 0x64, 0x00, 0x00, 0x00,
+        0x01, 0xc8,
+        0xbb, 0x01, 0x00, 0x00, 0x00,
+        0x29, 0xd9,
+        0x75, 0xf5,
+    });
+    X86Simulator simulator(dbManager, memory, 1, true);
+    TieringPolicy policy;
+    policy.warm_threshold = 2;
+    policy.hot_threshold = 3;
+    simulator.set_tiering_policy(policy);
+    simulator.set_execution_mode(ExecutionMode::Tiered);
+    simulator.runProgram();
+
+    EXPECT_EQ(simulator.getRegisterMapForTesting().get32("eax"), 5050);
+    EXPECT_TRUE(simulator.get_ZF());
+
+    TieringStats stats = simulator.get_tiering_stats();
+    EXPECT_EQ(stats.promotions_to_warm, 1); // Only the loop head; the entry runs once
+    if (JitCompiler::is_supported()) {
+        EXPECT_EQ(stats.promotions_to_hot, 1);
+    }
+
+    // Patching the loop demotes its block back to cold.
+    memory.write_text(13, 0x02);
+    EXPECT_EQ(simulator.get_tiering_stats().demotions_to_cold, 1);
+}
+
+TEST_F(TieredExecutionTest, StraightLineCodeStaysCold) {
+    // mov eax, 7 / mov ecx, 5 / add eax, ecx
+    load_text_program(memory, {
+        0xb8, 0x07, 0x00, 0x00, 0x00,
+        0xb9, 0x05, 0x00, 0x00, 0x00,
+        0x01, 0xc8,
+    });
+    X86Simulator simulator(dbManager, memory, 1, true);
+    simulator.set_execution_mode(ExecutionMode::Tiered);
+    simulator.runProgram();
+
+    EXPECT_EQ(simulator.getRegisterMapForTesting().get32("eax"), 12);
+    EXPECT_EQ(simulator.get_block_cache().size(), 0);
+    EXPECT_EQ(simulator.get_tiering_stats().promotions_to_warm, 0);
+}
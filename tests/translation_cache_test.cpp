@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+#include "../translation_cache.h"
+#include "../memory.h"
+
+class TranslationCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // mov eax, 5
+        mem.write_text(0, 0xb8);
+        mem.write_text_dword(1, 5);
+        // nop
+        mem.write_text(5, 0x90);
+        mem.set_text_segment_size(6);
+    }
+
+    std::unique_ptr<CompactDecodedInstruction> decode(address_t address) {
+        auto decoded_instr = std::make_unique<CompactDecodedInstruction>();
+        if (!Decoder::decode(mem, address, *decoded_instr)) {
+            return nullptr;
+        }
+        return decoded_instr;
+    }
+
+    Memory mem;
+};
+
+TEST_F(TranslationCacheTest, TranslatesOncePerAddress) {
+    TranslationCache cache(mem);
+    auto mov = decode(0);
+    ASSERT_NE(mov, nullptr);
+
+    const IRInstruction* first = cache.lookup(*mov);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->opcode, IROpcode::Move);
+    EXPECT_EQ(first->original_size, 5);
+
+    EXPECT_EQ(cache.lookup(*mov), first);
+    EXPECT_EQ(cache.get_misses(), 1);
+    EXPECT_EQ(cache.get_hits(), 1);
+}
+
+TEST_F(TranslationCacheTest, RemembersUnsupportedInstructions) {
+    TranslationCache cache(mem);
+    auto nop = decode(5);
+    ASSERT_NE(nop, nullptr);
+
+    EXPECT_EQ(cache.lookup(*nop), nullptr);
+    EXPECT_EQ(cache.lookup(*nop), nullptr);
+    EXPECT_EQ(cache.get_misses(), 1);
+    EXPECT_EQ(cache.get_hits(), 1);
+}
+
+TEST_F(TranslationCacheTest, TextWriteForcesRetranslation) {
+    TranslationCache cache(mem);
+    ASSERT_NE(cache.lookup(*decode(0)), nullptr);
+
+    mem.write_text_dword(1, 9);
+
+    const IRInstruction* mov = cache.lookup(*decode(0));
+    ASSERT_NE(mov, nullptr);
+    ASSERT_EQ(mov->operands.size(), 2);
+    EXPECT_EQ(std::get<uint64_t>(mov->operands[1]), 9);
+    EXPECT_EQ(cache.get_misses(), 2);
+}
@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of worker threads running queued tasks.
+ *
+ * Tasks run in submission order but complete in any order; wait() blocks
+ * until every task submitted so far has finished. Tasks must not throw.
+ */
+class ThreadPool {
+public:
+    // `threads` == 0 uses default_thread_count().
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    size_t size() const { return workers_.size(); }
+
+    // One thread per hardware thread, or one if that is unknown.
+    static size_t default_thread_count();
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    std::condition_variable idle_;
+    size_t active_ = 0;
+    bool stopping_ = false;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,17 @@
+#include "tiering_manager.h"
+
+bool TieringManager::record_cold_entry(address_t address) {
+    return ++cold_entry_counts_[address] >= policy_.warm_threshold;
+}
+
+void TieringManager::promoted_to_warm(address_t address) {
+    cold_entry_counts_.erase(address);
+    ++stats_.promotions_to_warm;
+}
+
+bool TieringManager::record_block_execution(BasicBlock& block) const {
+    if (!policy_.jit_enabled || block.jit_rejected || !block.valid) {
+        return false;
+    }
+    return ++block.execution_count >= policy_.hot_threshold;
+}
@@ -0,0 +1,70 @@
+#ifndef TIERING_MANAGER_H
+#define TIERING_MANAGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include "memory.h"
+#include "basic_block.h"
+
+// Block executions before JIT compilation, in both Jit and Tiered modes.
+constexpr uint64_t kDefaultHotThreshold = 50;
+
+/**
+ * @brief Execution-count thresholds for moving code between tiers.
+ *
+ * Cold code is single-stepped through the interpreter. A block entry reached
+ * warm_threshold times is promoted to a cached basic block, and a block run
+ * hot_threshold times in the block engine is compiled by the JIT.
+ */
+struct TieringPolicy {
+    uint64_t warm_threshold = 16;
+    uint64_t hot_threshold = kDefaultHotThreshold;
+    bool jit_enabled = true;
+};
+
+/**
+ * @brief Promotion and demotion event counts.
+ */
+struct TieringStats {
+    uint64_t promotions_to_warm = 0; // Cold entry became a cached block
+    uint64_t promotions_to_hot = 0;  // Block compiled to host code
+    uint64_t demotions_to_warm = 0;  // Host code dropped (code cache flush)
+    uint64_t demotions_to_cold = 0;  // Block invalidated by a text write
+};
+
+/**
+ * @brief Profiles block entries and decides when code changes tier.
+ *
+ * Cold code has no block yet, so its counters are kept per entry address,
+ * i.e. per target of a control transfer. Warm blocks carry their own
+ * execution_count.
+ */
+class TieringManager {
+public:
+    explicit TieringManager(TieringPolicy policy = {}) : policy_(policy) {}
+
+    void set_policy(const TieringPolicy& policy) { policy_ = policy; }
+    const TieringPolicy& get_policy() const { return policy_; }
+
+    // Counts one entry into cold code at `address`; true once it should be
+    // promoted to a block.
+    bool record_cold_entry(address_t address);
+    void promoted_to_warm(address_t address);
+
+    // Counts one interpreted run of `block`; true once it should be compiled.
+    bool record_block_execution(BasicBlock& block) const;
+    void promoted_to_hot() { ++stats_.promotions_to_hot; }
+
+    void demoted_to_warm(size_t blocks) { stats_.demotions_to_warm += blocks; }
+
+    // demotions_to_cold is tracked by the BlockCache, which sees invalidations.
+    const TieringStats& get_stats() const { return stats_; }
+
+private:
+    TieringPolicy policy_;
+    TieringStats stats_;
+    std::unordered_map<address_t, uint64_t> cold_entry_counts_;
+};
+
+#endif // TIERING_MANAGER_H
@@ -0,0 +1,73 @@
+#include "translation_cache.h"
+#include "decode_cache.h"
+#include "x86_to_ir.h"
+#include <algorithm>
+
+namespace {
+constexpr size_t kEntryChunk = 4096;
+}
+
+TranslationCache::TranslationCache(Memory& memory) : memory_(memory) {
+    listener_id_ = memory_.add_text_write_listener(
+        [this](address_t address, size_t size) { invalidate(address, size); });
+}
+
+TranslationCache::~TranslationCache() {
+    memory_.remove_text_write_listener(listener_id_);
+}
+
+const IRInstruction* TranslationCache::lookup(const CompactDecodedInstruction& decoded_instr) {
+    retired_.clear();
+
+    address_t address = decoded_instr.address;
+    address_t text_start = memory_.get_text_segment_start();
+    size_t text_size = memory_.get_text_segment_size();
+    if (address < text_start || address >= text_start + text_size) {
+        ++misses_;
+        uncached_ = translate_to_ir(decoded_instr);
+        return uncached_.get();
+    }
+
+    size_t index = address - text_start;
+    if (index < entries_.size() && entries_[index].translated) {
+        ++hits_;
+        return entries_[index].ir_instr.get();
+    }
+
+    ++misses_;
+    auto ir_instr = translate_to_ir(decoded_instr);
+    if (index >= entries_.size()) {
+        size_t new_size = std::min(text_size, (index / kEntryChunk + 1) * kEntryChunk);
+        entries_.resize(new_size);
+    }
+    entries_[index].ir_instr = std::move(ir_instr);
+    entries_[index].translated = true;
+    return entries_[index].ir_instr.get();
+}
+
+void TranslationCache::invalidate(address_t address, size_t size) {
+    address_t text_start = memory_.get_text_segment_start();
+    const size_t lookback = DecodeCache::kMaxInstructionLength - 1;
+    address_t first = address > text_start + lookback ? address - lookback : text_start;
+    if (address + size <= first) {
+        return;
+    }
+    size_t begin = first - text_start;
+    size_t end = std::min(entries_.size(), static_cast<size_t>(address + size - text_start));
+    for (size_t index = begin; index < end; ++index) {
+        Entry& entry = entries_[index];
+        if (entry.ir_instr) {
+            retired_.push_back(std::move(entry.ir_instr));
+        }
+        entry.translated = false;
+    }
+}
+
+void TranslationCache::clear() {
+    for (Entry& entry : entries_) {
+        if (entry.ir_instr) {
+            retired_.push_back(std::move(entry.ir_instr));
+        }
+    }
+    entries_.clear();
+}
@@ -0,0 +1,51 @@
+#ifndef TRANSLATION_CACHE_H
+#define TRANSLATION_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "memory.h"
+#include "decoder.h"
+#include "ir.h"
+
+// Keeps the IR translation of each text-segment address so translate_to_ir
+// runs once per instruction rather than once per execution. Instructions the
+// translator rejects are remembered too. Entries covering written text bytes
+// are dropped through the Memory text-write listener.
+class TranslationCache {
+public:
+    explicit TranslationCache(Memory& memory);
+    ~TranslationCache();
+
+    TranslationCache(const TranslationCache&) = delete;
+    TranslationCache& operator=(const TranslationCache&) = delete;
+
+    // Returns the IR for `decoded_instr`, translating it on a miss, or nullptr
+    // if the instruction is not supported. The pointer stays valid until the
+    // next lookup, even if the entry is invalidated while it executes.
+    const IRInstruction* lookup(const CompactDecodedInstruction& decoded_instr);
+
+    // Drops every translation whose bytes may overlap [address, address + size).
+    void invalidate(address_t address, size_t size);
+    void clear();
+
+    uint64_t get_hits() const { return hits_; }
+    uint64_t get_misses() const { return misses_; }
+
+private:
+    struct Entry {
+        std::unique_ptr<IRInstruction> ir_instr;
+        bool translated = false;
+    };
+
+    Memory& memory_;
+    size_t listener_id_;
+    std::vector<Entry> entries_;
+    std::vector<std::unique_ptr<IRInstruction>> retired_;
+    std::unique_ptr<IRInstruction> uncached_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+#endif // TRANSLATION_CACHE_H
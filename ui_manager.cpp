@@ -236,11 +236,8 @@ void UIManager::drawYmmRegisters(const RegisterMap& regs) {
 void UIManager::centerViewOnRip(address_t current_rip) {
     if (!program_decoder_) return;
 
-    const auto& address_to_index_map = program_decoder_->getAddressToIndexMap();
-    auto it = address_to_index_map.find(current_rip);
-
-    if (it != address_to_index_map.end()) {
-        size_t instruction_index = it->second;
+    size_t instruction_index;
+    if (program_decoder_->index_of(current_rip, instruction_index)) {
         int window_height = getmaxy(win_text_segment_);
         int center_line = (window_height > 3) ? (window_height - 3) / 2 : 0;
 
@@ -263,6 +260,9 @@ void UIManager::centerViewOnRip(address_t current_rip) {
 }
 
 void UIManager::drawTextWindow(address_t current_rip) {
+  if (program_decoder_) {
+    program_decoder_->refresh();
+  }
   centerViewOnRip(current_rip);
   drawTextSegment(win_text_segment_, "Program", current_rip);
 }
@@ -273,12 +273,10 @@ void UIManager::drawInstructionDescription(address_t current_rip, const Register
     mvwprintw(win_instruction_description_, 1, 2, "--- Instruction Details ---");
 
     if (!program_decoder_) return;
-    const auto& address_to_index_map = program_decoder_->getAddressToIndexMap();
-    const auto& decoded_program = program_decoder_->getDecodedProgram();
+    program_decoder_->refresh();
 
-    auto it = address_to_index_map.find(current_rip);
-    if (it != address_to_index_map.end()) {
-        const DecodedInstruction& instr = *decoded_program[it->second];
+    if (const DecodedInstruction* found = program_decoder_->find(current_rip)) {
+        const DecodedInstruction& instr = *found;
         std::string description = InstructionDescriber::describe(instr, regs, symbol_table_);
 
         // Truncate description to fit in the window to prevent overflow
@@ -310,7 +308,7 @@ void UIManager::drawTextSegment(WINDOW* win, const std::string& title, address_t
             break;
         }
 
-        const auto& decoded_instr = *decoded_program[i];
+        const auto& decoded_instr = decoded_program[i];
 
         // Check for and draw label before the instruction
         auto label_it = address_to_label_.find(decoded_instr.address);
@@ -32,6 +32,14 @@
 #include "decoder.h" // Include for DecodedInstruction and DecodedOperand
 #include "architecture.h"
 #include "ir.h"
+#include "decode_cache.h"
+#include "translation_cache.h"
+#include "basic_block.h"
+#include "jit_compiler.h"
+#include "tiering_manager.h"
+#include "lazy_flags.h"
+#include "aot_translator.h"
+#include "native_module.h"
 
 class UIManager;
 
@@ -54,12 +62,24 @@ const uint64_t RFLAGS_IF_BIT = 9;   // Interrupt Enable Flag
 const uint64_t RFLAGS_DF_BIT = 10;  // Direction Flag
 const uint64_t RFLAGS_OF_BIT = 11;  // Overflow Flag
 
+// The six status flags produced by arithmetic and logic instructions.
+const uint64_t RFLAGS_STATUS_MASK = (1ULL << RFLAGS_CF_BIT) | (1ULL << RFLAGS_PF_BIT) | (1ULL << RFLAGS_AF_BIT) |
+                                    (1ULL << RFLAGS_ZF_BIT) | (1ULL << RFLAGS_SF_BIT) | (1ULL << RFLAGS_OF_BIT);
+
 // Reserved bits (always set or unset)
 const uint64_t RFLAGS_ALWAYS_SET_BIT_1 = 1; // Reserved, always set to 1
 const uint64_t RFLAGS_ALWAYS_UNSET_BIT_3 = 3; // Reserved, always unset
 const uint64_t RFLAGS_ALWAYS_UNSET_BIT_5 = 5; // Reserved, always unset
 bool is_number(const std::string& s);
 
+// How runProgram advances the guest in headless mode. The UI always single-steps.
+enum class ExecutionMode {
+    SingleStep, // Fetch, decode and execute one instruction per dispatch
+    Block,      // Execute a cached basic block per dispatch
+    Jit,        // Block mode, compiling hot blocks to host code
+    Tiered,     // Cold code single-steps; warm code runs as blocks, hot code is compiled
+};
+
 class X86Simulator {
 #ifdef GOOGLE_TEST
 friend class SimulatorCoreTest;
@@ -73,10 +93,41 @@ public:
   void init(const std::string& program_name);
   bool executeInstruction(const DecodedInstruction& decoded_instr);
   void runSingleInstruction();
+  void runBlock();
+  void runTiered();
+  void set_execution_mode(ExecutionMode mode) { execution_mode_ = mode; }
+  ExecutionMode get_execution_mode() const { return execution_mode_; }
+  void set_jit_threshold(uint64_t executions);
+  void set_tiering_policy(const TieringPolicy& policy) { tiering_.set_policy(policy); }
+  const TieringPolicy& get_tiering_policy() const { return tiering_.get_policy(); }
+  TieringStats get_tiering_stats() const;
+  const JitCompiler& get_jit_compiler() const { return jit_; }
+  // With AOT translation on, secondPass() builds every block reachable from
+  // the entry point and text labels before the first instruction runs.
+  // `threads` == 0 uses one per hardware thread.
+  void set_aot_translation(bool enabled, size_t threads = 0) { aot_enabled_ = enabled; aot_threads_ = threads; }
+  AotStats translateAheadOfTime();
+  const AotStats& get_aot_stats() const { return aot_stats_; }
   bool isRunning();
   bool loadProgram(const std::string& filename);
   bool firstPass();
   bool secondPass();
+  // loadProgram, firstPass and secondPass in one step. With the program cache
+  // enabled, a valid `<filename>.x86cache` replaces all three along with block
+  // translation; otherwise the program is assembled (and translated ahead of
+  // time if AOT is enabled and the mode is not SingleStep) and the cache file
+  // is (re)written. Without AOT the file caches only the image.
+  bool assembleProgram(const std::string& filename);
+  void set_program_cache(bool enabled) { program_cache_enabled_ = enabled; }
+  bool program_cache_hit() const { return program_cache_hit_; }
+  // Native modules compile the cached blocks to a shared object (see
+  // native_module.h). build compiles and loads, load attaches an existing
+  // module, use loads and rebuilds if the module is missing or stale. Blocks
+  // are translated ahead of time first if the cache is empty.
+  bool buildNativeModule(const std::string& library_path);
+  bool loadNativeModule(const std::string& library_path);
+  bool useNativeModule(const std::string& library_path);
+  size_t native_module_blocks() const { return native_module_blocks_; }
   void runProgram();
   void dumpTextSegment(const std::string& filename);
   void dumpDataSegment(const std::string& filename);
@@ -95,6 +146,8 @@ public:
   int get_session_id() const { return session_id_; }
   IDatabaseManager& getDatabaseManager() { return db_manager_; }
   bool is_headless() const { return headless_; }
+  const BlockCache& get_block_cache() const { return block_cache_; }
+  IRPassManager& get_ir_passes() { return block_cache_.passes(); }
 
   bool get_CF() const;
   void set_CF(bool value);
@@ -111,6 +164,14 @@ public:
   bool get_PF() const;
     void set_PF(bool val);
 
+    // Defers status-flag computation until something reads a flag.
+    void record_flags(FlagOp op, uint32_t size, uint64_t dest, uint64_t src, uint64_t result) {
+        lazy_flags_.record(op, size, dest, src, result);
+    }
+    // Inc/Dec variant: CF keeps its current value.
+    void record_flags_preserving_carry(FlagOp op, uint32_t size, uint64_t dest, uint64_t result);
+    uint64_t get_rflags() const { return lazy_flags_.materialize(rflags_); }
+
     void execute_ir_instruction(const IRInstruction& ir_instr);
     void update_rflags_in_register_map();
 
@@ -126,19 +187,48 @@ public:
 private:
     // Private helper methods
     void dumpMemoryRange(const std::string& filename, address_t start_addr, size_t size);
+    bool executeTranslated(const IRInstruction* ir_instr, const char* mnemonic);
+    address_t executeBlock(const BasicBlock& block);
+    void compileBlock(BasicBlock& block);
+    void releaseNativeModule();
+    bool jit_active() const;
+    void loadJitState();
+    void storeJitState(address_t next_ip);
+    void materialize_flags();
+    void attachProgramDecoder();
+
+    // Upper bound on blocks run per runBlock() call, so the run loop regains
+    // control periodically even in an endless guest loop.
+    static constexpr size_t kMaxChainedBlocks = 1024;
 
     // --- Member Variables ---
     IDatabaseManager& db_manager_;
     Memory& memory_;
     RegisterMap register_map_;
     Architecture architecture_;
+    DecodeCache decode_cache_;
+    TranslationCache translation_cache_;
+    BlockCache block_cache_;
+    ExecutionMode execution_mode_ = ExecutionMode::SingleStep;
+    JitCompiler jit_;
+    JitState jit_state_ = {};
+    TieringManager tiering_;
+    bool aot_enabled_ = false;
+    size_t aot_threads_ = 0;
+    AotStats aot_stats_;
+    bool program_cache_enabled_ = false;
+    bool program_cache_hit_ = false;
+    std::unique_ptr<NativeModule> native_module_;
+    size_t native_module_blocks_ = 0;
 
     int session_id_;
     bool headless_;
     
     address_t instructionPointer_ = 0;
     address_t program_size_in_bytes_ = 0;
+    size_t data_size_in_bytes_ = 0;
     uint64_t rflags_;
+    LazyFlags lazy_flags_;
 
     std::unique_ptr<UIManager> ui_;
     std::map<std::string, address_t> symbolTable_;
@@ -10,6 +10,9 @@ X86Simulator::X86Simulator(IDatabaseManager& db_manager, Memory& memory, int ses
       memory_(memory),
       register_map_(),
       architecture_(create_x86_architecture()),
+      decode_cache_(memory),
+      translation_cache_(memory),
+      block_cache_(memory, decode_cache_, translation_cache_),
       session_id_(session_id),
       headless_(headless),
       instructionPointer_(0),
@@ -19,7 +22,7 @@ X86Simulator::X86Simulator(IDatabaseManager& db_manager, Memory& memory, int ses
     ui_ = std::make_unique<UIManager>(memory_);
     ui_->setRegisterMap(&register_map_);
   }
-  register_map_.set64("rsp", memory_.get_stack_bottom());
+  register_map_.set64(RSP, memory_.get_stack_bottom());
   rflags_ |= (1ULL << RFLAGS_ALWAYS_SET_BIT_1);
 }
 
@@ -7,6 +7,7 @@
 #include <algorithm> // For std::remove_if, std::isspace
 #include "CodeGenerator.h"
 #include "parser_utils.h"
+#include "program_cache.h"
 
 #include <stdexcept>
 #include <string>
@@ -226,6 +227,7 @@ bool X86Simulator::firstPass() {
     
     // Update the memory object with the final text segment size
     // memory_.set_text_segment_size(text_lc - memory_.get_text_segment_start()); // FIXME: Design changed, size is set at construction.
+    data_size_in_bytes_ = data_lc - memory_.get_data_segment_start();
 
     return true;
 }
@@ -245,21 +247,94 @@ bool X86Simulator::secondPass() {
     // Set the initial instruction pointer (RIP) to the address of the entry point label.
     auto it = symbolTable_.find(entryPointLabel_);
     if (it != symbolTable_.end()) {
-        register_map_.set64("rip", it->second);
+        register_map_.set64(RIP, it->second);
     } else {
         db_manager_.log(session_id_, "Entry point label '" + entryPointLabel_ + "' not found. Defaulting to start of text segment.", "ERROR", 0, __FILE__, __LINE__);
         // Fallback to the start of the text segment if the label is not found
-        register_map_.set64("rip", memory_.get_text_segment_start());
+        register_map_.set64(RIP, memory_.get_text_segment_start());
+    }
+    attachProgramDecoder();
+    // Single-stepping never looks at the block cache.
+    if (aot_enabled_ && execution_mode_ != ExecutionMode::SingleStep) {
+        translateAheadOfTime();
+    }
+    return true;
+}
+
+// The program listing exists only for the UI; headless runs never format
+// instruction text.
+void X86Simulator::attachProgramDecoder() {
+    if (!ui_) {
+        return;
     }
     auto program_decoder = std::make_unique<ProgramDecoder>(memory_);
+    address_t text_start = memory_.get_text_segment_start();
+    program_decoder->set_range(text_start, text_start + program_size_in_bytes_);
+    std::vector<address_t> labels;
+    for (const auto& symbol : symbolTable_) {
+        labels.push_back(symbol.second);
+    }
+    program_decoder->set_boundaries(std::move(labels));
     program_decoder->decode();
-    if (ui_) {
-        ui_->setProgramDecoder(std::move(program_decoder));
-        ui_->setSymbolTable(&symbolTable_);
+    ui_->setProgramDecoder(std::move(program_decoder));
+    ui_->setSymbolTable(&symbolTable_);
+}
+
+bool X86Simulator::assembleProgram(const std::string& filename) {
+    program_cache_hit_ = false;
+    if (!program_cache_enabled_) {
+        return loadProgram(filename) && firstPass() && secondPass();
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::stringstream source;
+    source << file.rdbuf();
+    const uint64_t source_hash = hash_program_source(source.str(), block_cache_.passes());
+    const std::string cache_path = program_cache_path(filename);
+
+    memory_.reset();
+    ProgramCacheContents contents;
+    if (load_program_cache(cache_path, source_hash, memory_, block_cache_, contents)) {
+        symbolTable_ = std::move(contents.symbols);
+        program_size_in_bytes_ = contents.text_size;
+        data_size_in_bytes_ = contents.data_size;
+        register_map_.set64(RIP, contents.entry_point);
+        attachProgramDecoder();
+        program_cache_hit_ = true;
+        return true;
+    }
+
+    // secondPass() translates ahead of time when AOT is enabled; otherwise
+    // only the image is cached.
+    if (!loadProgram(filename) || !firstPass() || !secondPass()) {
+        return false;
+    }
+    contents.entry_point = register_map_.get64(RIP);
+    contents.text_size = program_size_in_bytes_;
+    contents.data_size = data_size_in_bytes_;
+    contents.symbols = symbolTable_;
+    if (!write_program_cache(cache_path, source_hash, contents, memory_, block_cache_)) {
+        db_manager_.log(session_id_, "Could not write program cache " + cache_path, "ERROR", 0, __FILE__, __LINE__);
     }
     return true;
 }
 
+AotStats X86Simulator::translateAheadOfTime() {
+    std::vector<address_t> roots = {register_map_.get64(RIP)};
+    for (const auto& entry : symbolTable_) {
+        roots.push_back(entry.second); // Data labels fall outside the text segment and are skipped.
+    }
+    ThreadPool pool(aot_threads_);
+    aot_stats_ = translate_ahead_of_time(block_cache_, memory_, roots, pool);
+    db_manager_.log(session_id_, "AOT translated " + std::to_string(aot_stats_.blocks) + " blocks (" +
+                    std::to_string(aot_stats_.instructions) + " IR instructions) in " +
+                    std::to_string(aot_stats_.waves) + " waves.", "INFO", 0, __FILE__, __LINE__);
+    return aot_stats_;
+}
+
 // Helper to remove leading/trailing whitespace
 std::string X86Simulator::trim(const std::string& str) {
   size_t first = str.find_first_not_of(" \t\n\r");
@@ -3,124 +3,34 @@
 #include "ui_manager.h"
 #include "x86_to_ir.h"
 
-#include "ir_executor_helpers.h"
+#include "ir_dispatch.h"
 #include <string>
 #include <algorithm>
 #include <iomanip>
 #include <fstream>
 #include <sstream>
 
-// New IR-based dispatcher function
+// Runs the handler bound at translation time. Hand-built IR (tests, tools) is
+// bound here on first use; malformed instructions have no handler.
 void X86Simulator::execute_ir_instruction(const IRInstruction& ir_instr) {
-    switch (ir_instr.opcode) {
-        case IROpcode::Move:
-            handle_ir_move(ir_instr, *this);
-            break;
-        case IROpcode::Add:
-            handle_ir_add(ir_instr, *this);
-            break;
-        case IROpcode::Sub:
-            handle_ir_sub(ir_instr, *this);
-            break;
-        case IROpcode::Cmp:
-            handle_ir_cmp(ir_instr, *this);
-            break;
-        case IROpcode::Jump:
-            handle_ir_jump(ir_instr, *this);
-            break;
-        case IROpcode::Branch:
-            handle_ir_branch(ir_instr, *this);
-            break;
-        case IROpcode::Call:
-            handle_ir_call(ir_instr, *this);
-            break;
-        case IROpcode::Xor:
-            handle_ir_xor(ir_instr, *this);
-            break;
-        case IROpcode::Syscall:
-            handle_ir_syscall(ir_instr, *this);
-            break;
-        case IROpcode::And:
-            handle_ir_and(ir_instr, *this);
-            break;
-        case IROpcode::Or:
-            handle_ir_or(ir_instr, *this);
-            break;
-        case IROpcode::Not:
-            handle_ir_not(ir_instr, *this);
-            break;
-        case IROpcode::Shl:
-            handle_ir_shl(ir_instr, *this);
-            break;
-        case IROpcode::Shr:
-            handle_ir_shr(ir_instr, *this);
-            break;
-        case IROpcode::Sar:
-            handle_ir_sar(ir_instr, *this);
-            break;
-        case IROpcode::PackedAnd:
-            handle_ir_packed_and(ir_instr, *this);
-            break;
-        case IROpcode::PackedAndNot:
-            handle_ir_packed_and_not(ir_instr, *this);
-            break;
-        case IROpcode::PackedOr:
-            handle_ir_packed_or(ir_instr, *this);
-            break;
-        case IROpcode::PackedXor:
-            handle_ir_packed_xor(ir_instr, *this);
-            break;
-        case IROpcode::PackedAddPS:
-            handle_ir_packed_add_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedSubPS:
-            handle_ir_packed_sub_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedMulPS:
-            handle_ir_packed_mul_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedDivPS:
-            handle_ir_packed_div_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedMaxPS:
-            handle_ir_packed_max_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedMinPS:
-            handle_ir_packed_min_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedSqrtPS:
-            handle_ir_packed_sqrt_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedReciprocalPS:
-            handle_ir_packed_reciprocal_ps(ir_instr, *this);
-            break;
-        case IROpcode::PackedMulLowI16:
-            handle_ir_packed_mul_low_i16(ir_instr, *this);
-            break;
-        case IROpcode::VectorZero:
-            handle_ir_vector_zero(ir_instr, *this);
-            break;
-        case IROpcode::Ret:
-            handle_ir_ret(ir_instr, *this);
-            break;
-        case IROpcode::Div:
-            handle_ir_div(ir_instr, *this);
-            break;
-        // Other opcodes will be added here as their translations are implemented.
-        default:
-        {
-            std::string logmessage = "Unsupported IR Opcode: " + std::to_string(static_cast<int>(ir_instr.opcode));
-            db_manager_.log(session_id_, logmessage, "ERROR", instructionPointer_, __FILE__, __LINE__);
-            break;
-        }
+    IRHandler handler = ir_instr.handler ? ir_instr.handler : select_ir_handler(ir_instr);
+    if (!handler) {
+        std::string logmessage = "Unsupported or malformed IR instruction, opcode: " + std::to_string(static_cast<int>(ir_instr.opcode));
+        db_manager_.log(session_id_, logmessage, "ERROR", instructionPointer_, __FILE__, __LINE__);
+        return;
     }
+    handler(ir_instr, *this);
 }
 
 // Rewritten executeInstruction to use the new IR pipeline
 bool X86Simulator::executeInstruction(const DecodedInstruction& decoded_instr) {
     // 1. Translate the decoded x86 instruction to our abstract IR
     auto ir_instr = translate_to_ir(decoded_instr);
+    return executeTranslated(ir_instr.get(), decoded_instr.mnemonic.c_str());
+}
 
+// Executes an already translated instruction; nullptr means translation failed.
+bool X86Simulator::executeTranslated(const IRInstruction* ir_instr, const char* mnemonic) {
     // 2. Check if the translation was successful
     if (ir_instr) {
         // 3. Execute the IR instruction
@@ -128,8 +38,8 @@ bool X86Simulator::executeInstruction(const DecodedInstruction& decoded_instr) {
         return true;
     } else {
         // If translation is not supported yet, log an error.
-        std::string logmessage = "Unsupported instruction for IR translation: " + decoded_instr.mnemonic;
-        db_manager_.log(session_id_, logmessage, "ERROR", register_map_.get64("rip"), __FILE__, __LINE__);
+        std::string logmessage = "Unsupported instruction for IR translation: " + std::string(mnemonic);
+        db_manager_.log(session_id_, logmessage, "ERROR", register_map_.get64(RIP), __FILE__, __LINE__);
         return false;
     }
 }
@@ -137,49 +47,253 @@ bool X86Simulator::executeInstruction(const DecodedInstruction& decoded_instr) {
 // --- UNCHANGED FUNCTIONS ---
 
 void X86Simulator::runSingleInstruction() {
-    address_t instruction_pointer = register_map_.get64("rip");
+    address_t instruction_pointer = register_map_.get64(RIP);
 
-    // FETCH & DECODE
-    Decoder& decoder = Decoder::getInstance();
-    auto decoded_instr_opt = decoder.decodeInstruction(memory_, instruction_pointer);
+    // FETCH & DECODE (cached per address, invalidated on text writes)
+    const CompactDecodedInstruction* decoded_instr = decode_cache_.lookup(instruction_pointer);
 
-    if (!decoded_instr_opt) {
+    if (!decoded_instr) {
         db_manager_.log(session_id_, "Decoding failed at RIP: " + std::to_string(instruction_pointer), "ERROR", instruction_pointer, __FILE__, __LINE__);
         return;
     }
 
-    auto decoded_instr = std::move(decoded_instr_opt);
-
     if (decoded_instr->length_in_bytes == 0) {
         db_manager_.log(session_id_, "Decoder returned 0-length instruction at address " + std::to_string(instruction_pointer), "ERROR", instruction_pointer, __FILE__, __LINE__);
-        register_map_.set64("rip", instruction_pointer + 1); // Prevent infinite loop
+        register_map_.set64(RIP, instruction_pointer + 1); // Prevent infinite loop
         return;
     }
 
     // EXECUTE
     address_t next_ip = instruction_pointer + decoded_instr->length_in_bytes;
-    bool success = executeInstruction(*decoded_instr);
+    bool success = executeTranslated(translation_cache_.lookup(*decoded_instr), mnemonic_name(decoded_instr->mnemonic));
 
     if (success) {
-        if (register_map_.get64("rip") == instruction_pointer) {
-            register_map_.set64("rip", next_ip);
+        if (register_map_.get64(RIP) == instruction_pointer) {
+            register_map_.set64(RIP, next_ip);
 	    }
     } else {
-        db_manager_.log(session_id_, "Execution failed for: " + decoded_instr->mnemonic, "ERROR", instruction_pointer, __FILE__, __LINE__);
+        db_manager_.log(session_id_, "Execution failed for: " + std::string(mnemonic_name(decoded_instr->mnemonic)), "ERROR", instruction_pointer, __FILE__, __LINE__);
+    }
+
+    update_rflags_in_register_map();
+}
+
+// Executes one basic block and returns the RIP it exits with.
+address_t X86Simulator::executeBlock(const BasicBlock& block) {
+    const size_t body_size = block.instructions.size() - (block.ends_with_terminator ? 1 : 0);
+    for (size_t i = 0; i < body_size; ++i) {
+        execute_ir_instruction(block.instructions[i]);
+    }
+
+    // Fall through unless the terminator redirects control flow.
+    register_map_.set64(RIP, block.end_address);
+    if (block.ends_with_terminator) {
+        execute_ir_instruction(block.instructions.back());
+    }
+    return register_map_.get64(RIP);
+}
+
+// Executes a chain of basic blocks starting at RIP, following cached
+// successor links and the return-address stack between blocks. RFLAGS is only
+// written back to the register map when the chain exits; untranslatable code
+// falls back to a single step so errors are reported as in single-step mode.
+void X86Simulator::runBlock() {
+    block_cache_.release_retired();
+
+    address_t instruction_pointer = register_map_.get64(RIP);
+    BasicBlock* block = block_cache_.lookup(instruction_pointer);
+    if (!block) {
+        runSingleInstruction();
+        return;
+    }
+
+    const address_t text_start = memory_.get_text_segment_start();
+    const address_t text_end = text_start + memory_.get_text_segment_size();
+    // While compiled blocks run back to back, guest state lives in jit_state_
+    // and is only copied back when an interpreted block or the chain exit
+    // needs it.
+    bool jit_state_live = false;
+    address_t next_ip = instruction_pointer;
+    for (size_t chained = 0; block && chained < kMaxChainedBlocks; ++chained) {
+        if (block->native_code) {
+            if (!jit_state_live) {
+                loadJitState();
+                jit_state_live = true;
+            }
+            next_ip = block->native_code(&jit_state_);
+        } else {
+            if (jit_state_live) {
+                storeJitState(next_ip);
+                jit_state_live = false;
+            }
+            next_ip = executeBlock(*block);
+            if (jit_active() && tiering_.record_block_execution(*block)) {
+                compileBlock(*block);
+            }
+        }
+        if (!block->valid || next_ip < text_start || next_ip >= text_end) {
+            break;
+        }
+
+        IROpcode exit_opcode = block->ends_with_terminator ? block->instructions.back().opcode : IROpcode::Nop;
+        BasicBlock* next_block = nullptr;
+        if (exit_opcode == IROpcode::Ret) {
+            next_block = block_cache_.predict_return(next_ip);
+        } else if (exit_opcode == IROpcode::Call) {
+            block_cache_.push_return(*block);
+        }
+        block = next_block ? next_block : block_cache_.successor(*block, next_ip);
     }
 
+    if (jit_state_live) {
+        storeJitState(next_ip);
+    }
     update_rflags_in_register_map();
 }
 
+// Tiered dispatch: code without a block is single-stepped until control
+// leaves straight-line code, counting each entry address reached that way.
+// Entries reaching the warm threshold become blocks and run in the block
+// engine, which promotes them further to the JIT once they are hot.
+void X86Simulator::runTiered() {
+    address_t instruction_pointer = register_map_.get64(RIP);
+    BasicBlock* block = block_cache_.find(instruction_pointer);
+    if (!block && tiering_.record_cold_entry(instruction_pointer)) {
+        block = block_cache_.lookup(instruction_pointer);
+        if (block) {
+            tiering_.promoted_to_warm(instruction_pointer);
+        }
+    }
+    if (block) {
+        runBlock();
+        return;
+    }
+
+    const address_t text_end = memory_.get_text_segment_start() + memory_.get_text_segment_size();
+    for (size_t stepped = 0; stepped < BlockCache::kMaxBlockInstructions; ++stepped) {
+        const CompactDecodedInstruction* decoded_instr = decode_cache_.lookup(instruction_pointer);
+        address_t fall_through = decoded_instr ? instruction_pointer + decoded_instr->length_in_bytes : 0;
+        runSingleInstruction();
+        address_t next_ip = register_map_.get64(RIP);
+        if (next_ip != fall_through || next_ip >= text_end || block_cache_.find(next_ip)) {
+            break;
+        }
+        instruction_pointer = next_ip;
+    }
+}
+
+bool X86Simulator::jit_active() const {
+    return (execution_mode_ == ExecutionMode::Jit || execution_mode_ == ExecutionMode::Tiered) &&
+           JitCompiler::is_supported();
+}
+
+void X86Simulator::set_jit_threshold(uint64_t executions) {
+    TieringPolicy policy = tiering_.get_policy();
+    policy.hot_threshold = executions;
+    tiering_.set_policy(policy);
+}
+
+TieringStats X86Simulator::get_tiering_stats() const {
+    TieringStats stats = tiering_.get_stats();
+    stats.demotions_to_cold = block_cache_.get_invalidated_blocks();
+    return stats;
+}
+
+void X86Simulator::compileBlock(BasicBlock& block) {
+    JitBlockFn native_code = jit_.compile(block.instructions, block.end_address, memory_.get_total_memory_size());
+    if (native_code) {
+        block.native_code = native_code;
+        block.native_code_owner = NativeCodeOwner::Jit;
+        tiering_.promoted_to_hot();
+    } else if (jit_.is_full()) {
+        // Start over with an empty code cache; hot blocks will recompile.
+        // Blocks running native module code keep it.
+        jit_.flush();
+        tiering_.demoted_to_warm(block_cache_.drop_native_code(NativeCodeOwner::Jit));
+    } else {
+        block.jit_rejected = true;
+    }
+}
+
+void X86Simulator::releaseNativeModule() {
+    if (native_module_) {
+        // The module's functions go away with it.
+        block_cache_.drop_native_code(NativeCodeOwner::Module);
+        native_module_.reset();
+        native_module_blocks_ = 0;
+    }
+}
+
+bool X86Simulator::buildNativeModule(const std::string& library_path) {
+    if (block_cache_.size() == 0) {
+        translateAheadOfTime();
+    }
+    // dlopen hands back an already open library by name, so close the old one first.
+    releaseNativeModule();
+    std::string error;
+    if (!NativeModule::build(block_cache_, memory_, library_path, error)) {
+        db_manager_.log(session_id_, "Could not build native module: " + error, "ERROR", 0, __FILE__, __LINE__);
+        return false;
+    }
+    return loadNativeModule(library_path);
+}
+
+bool X86Simulator::loadNativeModule(const std::string& library_path) {
+    if (block_cache_.size() == 0) {
+        translateAheadOfTime();
+    }
+    releaseNativeModule();
+    std::string error;
+    std::unique_ptr<NativeModule> module = NativeModule::load(library_path, memory_, error);
+    if (!module) {
+        db_manager_.log(session_id_, "Could not load native module: " + error, "WARNING", 0, __FILE__, __LINE__);
+        return false;
+    }
+    native_module_blocks_ = module->attach(block_cache_);
+    native_module_ = std::move(module);
+    db_manager_.log(session_id_, "Attached " + std::to_string(native_module_blocks_) + " of " +
+                    std::to_string(native_module_->size()) + " native blocks from " + library_path + ".",
+                    "INFO", 0, __FILE__, __LINE__);
+    return native_module_blocks_ == native_module_->size();
+}
+
+bool X86Simulator::useNativeModule(const std::string& library_path) {
+    return loadNativeModule(library_path) || buildNativeModule(library_path);
+}
+
+void X86Simulator::loadJitState() {
+    for (uint32_t i = 0; i < 8; ++i) {
+        jit_state_.gpr[i] = register_map_.get64(static_cast<Reg64>(architecture_.get_register_slot({IRRegisterType::GPR, i, 64})));
+    }
+    materialize_flags();
+    jit_state_.rflags = rflags_;
+    jit_state_.memory_base = memory_.host_base();
+}
+
+void X86Simulator::storeJitState(address_t next_ip) {
+    for (uint32_t i = 0; i < 8; ++i) {
+        register_map_.set64(static_cast<Reg64>(architecture_.get_register_slot({IRRegisterType::GPR, i, 64})), jit_state_.gpr[i]);
+    }
+    rflags_ = jit_state_.rflags;
+    lazy_flags_.clear();
+    register_map_.set64(RIP, next_ip);
+}
+
 void X86Simulator::runProgram() {
     if (headless_) { // Handle headless mode separately
         while (true) {
-            address_t instruction_pointer = register_map_.get64("rip");
+            address_t instruction_pointer = register_map_.get64(RIP);
             if (instruction_pointer >= memory_.get_text_segment_start() + memory_.get_text_segment_size()) {
                 db_manager_.log(session_id_, "End of program", "INFO", instruction_pointer, __FILE__, __LINE__);
                 break; // Program finished
             }
-            runSingleInstruction();
+            if (execution_mode_ == ExecutionMode::Tiered) {
+                runTiered();
+            } else if (execution_mode_ != ExecutionMode::SingleStep) {
+                runBlock();
+            } else {
+                runSingleInstruction();
+            }
         }
         return;
     }
@@ -190,8 +304,8 @@ void X86Simulator::runProgram() {
     // Initial Draw
     ui_->drawMainRegisters(register_map_);
     ui_->drawYmmRegisters(register_map_);
-    ui_->drawTextWindow(register_map_.get64("rip"));
-    ui_->drawInstructionDescription(register_map_.get64("rip"), register_map_);
+    ui_->drawTextWindow(register_map_.get64(RIP));
+    ui_->drawInstructionDescription(register_map_.get64(RIP), register_map_);
     ui_->drawLegend();
 
     while (isRunning) {
@@ -206,7 +320,7 @@ void X86Simulator::runProgram() {
         runSingleInstruction();
 
         // Check for end of program
-        address_t instruction_pointer = register_map_.get64("rip");
+        address_t instruction_pointer = register_map_.get64(RIP);
         if (instruction_pointer >= memory_.get_text_segment_start() + memory_.get_text_segment_size()) {
             isRunning = false;
             db_manager_.log(session_id_, "End of program", "INFO", instruction_pointer, __FILE__, __LINE__);
@@ -215,8 +329,8 @@ void X86Simulator::runProgram() {
         // Update UI with new state
         ui_->drawMainRegisters(register_map_);
         ui_->drawYmmRegisters(register_map_);
-        ui_->drawTextWindow(register_map_.get64("rip"));
-        ui_->drawInstructionDescription(register_map_.get64("rip"), register_map_);
+        ui_->drawTextWindow(register_map_.get64(RIP));
+        ui_->drawInstructionDescription(register_map_.get64(RIP), register_map_);
     }
 }
 
@@ -227,11 +341,10 @@ void X86Simulator::dumpTextSegment(const std::string& filename) {
         return;
     }
 
-    Decoder& decoder = Decoder::getInstance();
     address_t current_address = memory_.get_text_segment_start();
 
     while (current_address < memory_.get_text_segment_start() + program_size_in_bytes_) {
-        auto decoded_instr_opt = decoder.decodeInstruction(memory_, current_address);
+        auto decoded_instr_opt = Decoder::decodeInstruction(memory_, current_address);
         if (!decoded_instr_opt) {
             outfile << "0x" << std::hex << std::setw(8) << std::setfill('0') << current_address << ": "
                     << std::setw(2) << (int)memory_.read_text(current_address) << "   (decode failed)" << std::endl;
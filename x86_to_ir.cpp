@@ -1,10 +1,10 @@
 #include "x86_to_ir.h"
 #include "architecture.h" // TODO: This is not ideal, see translate_operand
+#include "ir_dispatch.h"
+#include "instruction_formatter.h"
+#include <optional>
 #include <stdexcept>
 
-// Forward declaration for our new operand translation helper
-IROperand translate_operand(const DecodedOperand& decoded_op, const Architecture& arch, uint32_t size_hint = 32);
-
 // TODO: This is a temporary, inefficient way to do reverse lookups.
 // The Architecture class should be improved with a dedicated reverse map.
 IRRegister find_ir_register_by_name(const std::string& name, const Architecture& arch) {
@@ -16,13 +16,77 @@ IRRegister find_ir_register_by_name(const std::string& name, const Architecture&
     throw std::runtime_error("Unknown register name in translate_operand: " + name);
 }
 
+namespace {
+
+const Architecture& x86_architecture() {
+    static const Architecture arch = create_x86_architecture();
+    return arch;
+}
+
+// The IR register for a decoded register operand. Registers the architecture
+// does not model are rejected just like unknown names.
+IRRegister ir_register(const CompactOperand& operand, const Architecture& arch) {
+    IRRegisterType type = operand.type == OperandType::REGISTER ? IRRegisterType::GPR : IRRegisterType::VECTOR;
+    IRRegisterKey key{type, operand.reg, operand.size};
+    auto it = arch.register_map.find(key);
+    if (it == arch.register_map.end()) {
+        throw std::runtime_error("Unknown register in translate_operand: " + format_operand_text(operand));
+    }
+    return IRRegister{type, operand.reg, operand.size};
+}
+
+// True for a general-purpose register operand the architecture models.
+bool is_known_gpr(const CompactOperand& operand, const Architecture& arch) {
+    return operand.type == OperandType::REGISTER &&
+           arch.register_map.count(IRRegisterKey{IRRegisterType::GPR, operand.reg, operand.size}) != 0;
+}
+
+// True for a source operand translate_operand() accepts without throwing.
+bool is_translatable_source(const CompactOperand& operand, const Architecture& arch) {
+    return operand.type == OperandType::IMMEDIATE || operand.type == OperandType::MEMORY ||
+           is_known_gpr(operand, arch);
+}
+
+} // namespace
+
+// Stores the register-file slot of every register operand so the executor can
+// index the register file directly instead of looking names up.
+void resolve_register_slots(std::vector<IROperand>& ops, const Architecture& arch) {
+    for (auto& op : ops) {
+        if (IRRegister* reg = std::get_if<IRRegister>(&op)) {
+            reg->slot = arch.get_register_slot(*reg);
+        } else if (IRMemoryOperand* mem = std::get_if<IRMemoryOperand>(&op)) {
+            if (mem->base_reg) mem->base_reg->slot = arch.get_register_slot(*mem->base_reg);
+            if (mem->index_reg) mem->index_reg->slot = arch.get_register_slot(*mem->index_reg);
+        }
+    }
+}
 
-IROperand translate_operand(const DecodedOperand& decoded_op, const Architecture& arch, uint32_t size_hint) {
+// Conditional jumps the decoder emits that have an IR condition code.
+std::optional<IRConditionCode> branch_condition(Mnemonic mnemonic) {
+    switch (mnemonic) {
+        case Mnemonic::Je:  return IRConditionCode::Equal;
+        case Mnemonic::Jne: return IRConditionCode::NotEqual;
+        case Mnemonic::Jb:  return IRConditionCode::Below;
+        case Mnemonic::Jae: return IRConditionCode::AboveOrEqual;
+        case Mnemonic::Jl:  return IRConditionCode::Less;
+        case Mnemonic::Jge: return IRConditionCode::GreaterOrEqual;
+        case Mnemonic::Jle: return IRConditionCode::LessOrEqual;
+        case Mnemonic::Jg:  return IRConditionCode::Greater;
+        case Mnemonic::Jo:  return IRConditionCode::Overflow;
+        case Mnemonic::Jno: return IRConditionCode::NotOverflow;
+        case Mnemonic::Js:  return IRConditionCode::Sign;
+        case Mnemonic::Jns: return IRConditionCode::NotSign;
+        default:            return std::nullopt;
+    }
+}
+
+IROperand translate_operand(const CompactOperand& decoded_op, const Architecture& arch, uint32_t size_hint = 32) {
     switch (decoded_op.type) {
         case OperandType::REGISTER:
         case OperandType::YMM_REGISTER: // Treat YMM like any other register for now
         {
-            return find_ir_register_by_name(decoded_op.text, arch);
+            return ir_register(decoded_op, arch);
         }
         case OperandType::IMMEDIATE:
         {
@@ -30,8 +94,8 @@ IROperand translate_operand(const DecodedOperand& decoded_op, const Architecture
         }
         case OperandType::MEMORY:
         {
-            // This is a simplified translation. A full implementation would need to parse
-            // the complex memory addressing from decoded_op.text (e.g., "[eax + ecx*4]")
+            // This is a simplified translation: only absolute addresses are
+            // decoded so far.
             IRMemoryOperand mem_op;
             mem_op.displacement = decoded_op.value;
             mem_op.size = size_hint; // Use the hint for memory access size
@@ -42,84 +106,122 @@ IROperand translate_operand(const DecodedOperand& decoded_op, const Architecture
     }
 }
 
-std::unique_ptr<IRInstruction> translate_to_ir(const DecodedInstruction& decoded_instr) {
-    // For this to work, we need an Architecture object. For now, we create one on the fly.
-    // In a real scenario, this would be passed in or be globally available.
-    static Architecture x86_arch = create_x86_architecture();
+std::unique_ptr<IRInstruction> translate_to_ir(const CompactDecodedInstruction& decoded_instr) {
+    const Architecture& x86_arch = x86_architecture();
+    const CompactOperand* operands = decoded_instr.operands;
 
     std::vector<IROperand> ops;
     IROpcode opcode = IROpcode::Nop;
     bool supported = true;
 
-    if (decoded_instr.mnemonic == "mov") {
-        opcode = IROpcode::Move;
-        // Get the size from the destination operand
-        auto dest_reg = find_ir_register_by_name(decoded_instr.operands[0].text, x86_arch);
-        ops.push_back(dest_reg);
-        ops.push_back(translate_operand(decoded_instr.operands[1], x86_arch, dest_reg.size));
-
-    } else if (decoded_instr.mnemonic == "add") {
-        opcode = IROpcode::Add;
-        auto dest_reg = find_ir_register_by_name(decoded_instr.operands[0].text, x86_arch);
-        ops.push_back(dest_reg);
-        ops.push_back(translate_operand(decoded_instr.operands[1], x86_arch, dest_reg.size));
-
-    } else if (decoded_instr.mnemonic == "sub") {
-        opcode = IROpcode::Sub;
-        auto dest_reg = find_ir_register_by_name(decoded_instr.operands[0].text, x86_arch);
-        ops.push_back(dest_reg);
-        ops.push_back(translate_operand(decoded_instr.operands[1], x86_arch, dest_reg.size));
-
-    } else if (decoded_instr.mnemonic == "cmp") {
-        opcode = IROpcode::Cmp;
-        auto op1_reg = find_ir_register_by_name(decoded_instr.operands[0].text, x86_arch);
-        ops.push_back(op1_reg);
-        ops.push_back(translate_operand(decoded_instr.operands[1], x86_arch, op1_reg.size));
-
-    } else if (decoded_instr.mnemonic == "jmp") {
-        opcode = IROpcode::Jump;
-        ops.push_back(static_cast<uint64_t>(decoded_instr.operands[0].value)); // Jump target address
-
-    } else if (decoded_instr.mnemonic == "jne") {
-        opcode = IROpcode::Branch;
-        ops.push_back(static_cast<uint64_t>(decoded_instr.operands[0].value)); // Target address
-        ops.push_back(IRConditionCode::NotEqual); // The condition
-
-    } else if (decoded_instr.mnemonic == "jg") {
-        opcode = IROpcode::Branch;
-        ops.push_back(static_cast<uint64_t>(decoded_instr.operands[0].value)); // Target address
-        ops.push_back(IRConditionCode::Greater); // The condition
-
-    } else if (decoded_instr.mnemonic == "jge") {
-        opcode = IROpcode::Branch;
-        ops.push_back(static_cast<uint64_t>(decoded_instr.operands[0].value)); // Target address
-        ops.push_back(IRConditionCode::GreaterOrEqual); // The condition
-
-    } else if (decoded_instr.mnemonic == "call") {
-        opcode = IROpcode::Call;
-        ops.push_back(static_cast<uint64_t>(decoded_instr.operands[0].value)); // Target address
-
-    } else if (decoded_instr.mnemonic == "xor") {
-        opcode = IROpcode::Xor;
-        auto dest_reg = find_ir_register_by_name(decoded_instr.operands[0].text, x86_arch);
-        ops.push_back(dest_reg);
-        ops.push_back(translate_operand(decoded_instr.operands[1], x86_arch, dest_reg.size));
-
-    } else if (decoded_instr.mnemonic == "int") {
-        opcode = IROpcode::Syscall;
-        ops.push_back(static_cast<uint64_t>(decoded_instr.operands[0].value)); // Interrupt vector
-
-    } else {
-        supported = false;
+    // Decodes without the operands a form needs (e.g. 0x40, or a memory
+    // destination) are unsupported rather than thrown over.
+    switch (decoded_instr.mnemonic) {
+        case Mnemonic::Mov:
+        case Mnemonic::Add:
+        case Mnemonic::Sub:
+        case Mnemonic::Cmp:
+        case Mnemonic::Xor: {
+            if (decoded_instr.operand_count != 2 || !is_known_gpr(operands[0], x86_arch) ||
+                !is_translatable_source(operands[1], x86_arch)) {
+                supported = false;
+                break;
+            }
+            static constexpr std::pair<Mnemonic, IROpcode> kBinary[] = {
+                {Mnemonic::Mov, IROpcode::Move}, {Mnemonic::Add, IROpcode::Add}, {Mnemonic::Sub, IROpcode::Sub},
+                {Mnemonic::Cmp, IROpcode::Cmp},  {Mnemonic::Xor, IROpcode::Xor},
+            };
+            for (const auto& entry : kBinary) {
+                if (entry.first == decoded_instr.mnemonic) opcode = entry.second;
+            }
+            // The destination register sets the operand size.
+            IRRegister dest_reg = ir_register(operands[0], x86_arch);
+            ops.push_back(dest_reg);
+            ops.push_back(translate_operand(operands[1], x86_arch, dest_reg.size));
+            break;
+        }
+        case Mnemonic::Jmp:
+            if (decoded_instr.operand_count != 1) {
+                supported = false;
+                break;
+            }
+            opcode = IROpcode::Jump;
+            ops.push_back(static_cast<uint64_t>(operands[0].value)); // Jump target address
+            break;
+        case Mnemonic::Inc:
+        case Mnemonic::Dec:
+            if (decoded_instr.operand_count != 1 || !is_known_gpr(operands[0], x86_arch)) {
+                supported = false;
+                break;
+            }
+            opcode = decoded_instr.mnemonic == Mnemonic::Inc ? IROpcode::Inc : IROpcode::Dec;
+            ops.push_back(ir_register(operands[0], x86_arch));
+            break;
+        case Mnemonic::Call:
+            if (decoded_instr.operand_count != 1) {
+                supported = false;
+                break;
+            }
+            opcode = IROpcode::Call;
+            ops.push_back(static_cast<uint64_t>(operands[0].value)); // Target address
+            break;
+        case Mnemonic::Ret:
+            opcode = IROpcode::Ret;
+            break;
+        case Mnemonic::Int:
+            if (decoded_instr.operand_count != 1) {
+                supported = false;
+                break;
+            }
+            opcode = IROpcode::Syscall;
+            ops.push_back(static_cast<uint64_t>(operands[0].value)); // Interrupt vector
+            break;
+        default:
+            std::optional<IRConditionCode> condition = branch_condition(decoded_instr.mnemonic);
+            if (condition && decoded_instr.operand_count == 1) {
+                opcode = IROpcode::Branch;
+                ops.push_back(static_cast<uint64_t>(operands[0].value)); // Target address
+                ops.push_back(*condition); // The condition
+            } else {
+                supported = false;
+            }
+            break;
     }
 
     if (!supported) {
         return nullptr; // Instruction not supported for translation
     }
 
+    resolve_register_slots(ops, x86_arch);
     auto ir_instr = std::make_unique<IRInstruction>(opcode, std::move(ops));
     ir_instr->original_address = decoded_instr.address;
     ir_instr->original_size = decoded_instr.length_in_bytes;
 
+    // Malformed operands are rejected here, once, rather than on every execution.
+    if (!bind_ir_handler(*ir_instr)) {
+        return nullptr;
+    }
+
     return ir_instr;
 }
+
+std::unique_ptr<IRInstruction> translate_to_ir(const DecodedInstruction& decoded_instr) {
+    const Architecture& x86_arch = x86_architecture();
+    CompactDecodedInstruction compact;
+    compact.address = decoded_instr.address;
+    compact.mnemonic = mnemonic_from_name(decoded_instr.mnemonic);
+    compact.length_in_bytes = static_cast<uint8_t>(decoded_instr.length_in_bytes);
+    for (const DecodedOperand& operand : decoded_instr.operands) {
+        CompactOperand op;
+        op.type = operand.type;
+        op.value = operand.value;
+        if (operand.type == OperandType::REGISTER || operand.type == OperandType::YMM_REGISTER) {
+            IRRegister reg = find_ir_register_by_name(operand.text, x86_arch);
+            op.type = reg.type == IRRegisterType::GPR ? OperandType::REGISTER : OperandType::YMM_REGISTER;
+            op.reg = static_cast<uint8_t>(reg.index);
+            op.size = static_cast<uint16_t>(reg.size);
+        }
+        compact.add_operand(op);
+    }
+    return translate_to_ir(compact);
+}
@@ -12,6 +12,12 @@
  * @return A unique_ptr to the new IRInstruction. Returns nullptr if the instruction
  *         is not supported or cannot be translated.
  */
+std::unique_ptr<IRInstruction> translate_to_ir(const CompactDecodedInstruction& decoded_instr);
+
+/**
+ * @brief Translates an instruction in text form (hand-built or formatted) by
+ *        resolving its mnemonic and register names first.
+ */
 std::unique_ptr<IRInstruction> translate_to_ir(const DecodedInstruction& decoded_instr);
 
 #endif // X86_TO_IR_H